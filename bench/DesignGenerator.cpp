@@ -0,0 +1,191 @@
+#include "DesignGenerator.h"
+
+#include <fstream>
+#include <iterator>
+
+namespace slang_autos::bench {
+
+namespace {
+
+constexpr const char* kTopModule = "bench_top";
+
+/// splitmix64: tiny, portable and fully deterministic
+uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/// Ports come in groups of three: the last of each group is an output, the
+/// first consumes the previous module's output of the same group, and the
+/// middle one is a shared top-level input.
+bool isOutput(size_t p) {
+    return p >= 2 && p % 3 == 2;
+}
+
+/// Index of the output port whose width (and, for chained inputs, whose
+/// name) port `p` takes.
+size_t sourcePort(const DesignSpec& spec, size_t p) {
+    bool chained = p >= 3 && p % 3 == 0 && p + 2 < spec.ports;
+    return chained ? p + 2 : p;
+}
+
+std::string portName(const DesignSpec& spec, size_t m, size_t p) {
+    if (p == 0) return "clk";
+    if (p == 1) return "rst_n";
+    if (isOutput(p)) {
+        return "m" + std::to_string(m) + "_p" + std::to_string(p);
+    }
+    if (size_t src = sourcePort(spec, p); src != p) {
+        size_t prev = (m + spec.modules - 1) % spec.modules;
+        return "m" + std::to_string(prev) + "_p" + std::to_string(src);
+    }
+    return "in_p" + std::to_string(p);
+}
+
+/// Width of output port `index`; inputs take the width of their source.
+int outputWidth(const DesignSpec& spec, size_t index) {
+    if (index < 2) return 1;
+    static constexpr int widths[] = {1, 4, 8, 16, 32, 64};
+    return widths[mix(spec.seed * 1000003 + index) % std::size(widths)];
+}
+
+std::string rangeText(const DesignSpec& spec, size_t p) {
+    size_t src = sourcePort(spec, p);
+    int width = outputWidth(spec, src);
+    if (width == 1) return "";
+    if (spec.macro_widths) {
+        return "[`BW_" + std::to_string(src) + "-1:0] ";
+    }
+    return "[" + std::to_string(width - 1) + ":0] ";
+}
+
+std::string instanceName(const DesignSpec& spec, size_t i) {
+    // The row number comes first so that `@` in templates picks it up
+    return "u_" + std::to_string(i / spec.modules) + "_leaf" + std::to_string(i % spec.modules);
+}
+
+std::string templateFor(const DesignSpec& spec, size_t m) {
+    size_t prev = (m + spec.modules - 1) % spec.modules;
+    std::string text = "    /* leaf" + std::to_string(m) + " AUTO_TEMPLATE\n";
+    // Rule 0 routes inputs to the same row of the previous module; the
+    // others give a subset of outputs (by last digit) per-row names.
+    text += "       m" + std::to_string(prev) + "_p([0-9]+) => m" + std::to_string(prev) + "_p$1_@,\n";
+    for (size_t r = 1; r < spec.template_rules; ++r) {
+        std::string mod = "m" + std::to_string(m);
+        text += "       " + mod + "_p([0-9]*" + std::to_string((r - 1) % 10) + ") => " +
+                mod + "_p$1_@,\n";
+    }
+    text += "    */\n";
+    return text;
+}
+
+void writeText(const std::filesystem::path& path, const std::string& text) {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << text;
+}
+
+} // anonymous namespace
+
+std::vector<std::string> GeneratedDesign::args() const {
+    std::vector<std::string> result = {
+        top.string(),
+        "-y", lib_dir.string(),
+        "+libext+.sv",
+    };
+    if (!include_dir.empty()) {
+        result.push_back("+incdir+" + include_dir.string());
+    }
+    return result;
+}
+
+std::vector<GeneratedPort> leafPorts(const DesignSpec& spec, size_t m) {
+    std::vector<GeneratedPort> ports;
+    ports.reserve(spec.ports);
+    for (size_t p = 0; p < spec.ports; ++p) {
+        ports.push_back({portName(spec, m, p), isOutput(p), outputWidth(spec, sourcePort(spec, p))});
+    }
+    return ports;
+}
+
+std::string generateLeafModule(const DesignSpec& spec, size_t m) {
+    std::string text;
+    text.reserve(64 + spec.ports * 48);
+    if (spec.macro_widths) {
+        text += "`include \"widths.svh\"\n\n";
+    }
+    text += "module leaf" + std::to_string(m) + " (\n";
+    for (size_t p = 0; p < spec.ports; ++p) {
+        text += isOutput(p) ? "    output logic " : "    input  logic ";
+        text += rangeText(spec, p);
+        text += portName(spec, m, p);
+        text += p + 1 < spec.ports ? ",\n" : "\n";
+    }
+    text += ");\nendmodule\n";
+    return text;
+}
+
+std::string generateTopModule(const DesignSpec& spec) {
+    std::string text;
+    text.reserve(256 + spec.instances * (48 + spec.generate_depth * 32));
+    if (spec.macro_widths) {
+        text += "`include \"widths.svh\"\n\n";
+    }
+    text += "module ";
+    text += kTopModule;
+    text += " (\n    input logic clk,\n    input logic rst_n\n    /*AUTOPORTS*/\n);\n";
+    text += "    /*AUTOLOGIC*/\n\n";
+
+    for (size_t i = 0; i < spec.instances; ++i) {
+        size_t m = i % spec.modules;
+        if (spec.template_rules > 0 && i < spec.modules) {
+            text += templateFor(spec, m);
+        }
+
+        std::string indent = "    ";
+        for (size_t d = 0; d < spec.generate_depth; ++d) {
+            text += indent + "if (1) begin : g" + std::to_string(i) + "_" + std::to_string(d) + "\n";
+            indent += "    ";
+        }
+        text += indent + "leaf" + std::to_string(m) + " " + instanceName(spec, i) + " (/*AUTOINST*/);\n";
+        for (size_t d = spec.generate_depth; d > 0; --d) {
+            indent.resize(indent.size() - 4);
+            text += indent + "end\n";
+        }
+    }
+
+    text += "endmodule\n";
+    return text;
+}
+
+std::string generateWidthHeader(const DesignSpec& spec) {
+    std::string text = "`ifndef BENCH_WIDTHS_SVH\n`define BENCH_WIDTHS_SVH\n";
+    for (size_t p = 2; p < spec.ports; ++p) {
+        text += "`define BW_" + std::to_string(p) + " " + std::to_string(outputWidth(spec, p)) + "\n";
+    }
+    text += "`endif\n";
+    return text;
+}
+
+GeneratedDesign generateDesign(const DesignSpec& spec, const std::filesystem::path& dir) {
+    GeneratedDesign design;
+    design.top_module = kTopModule;
+    design.top = dir / (design.top_module + ".sv");
+    design.lib_dir = dir / "lib";
+
+    std::filesystem::create_directories(design.lib_dir);
+    if (spec.macro_widths) {
+        design.include_dir = dir / "include";
+        std::filesystem::create_directories(design.include_dir);
+        writeText(design.include_dir / "widths.svh", generateWidthHeader(spec));
+    }
+
+    for (size_t m = 0; m < spec.modules; ++m) {
+        writeText(design.lib_dir / ("leaf" + std::to_string(m) + ".sv"), generateLeafModule(spec, m));
+    }
+    writeText(design.top, generateTopModule(spec));
+    return design;
+}
+
+} // namespace slang_autos::bench
@@ -0,0 +1,63 @@
+// Deterministic synthetic SystemVerilog design generator for benchmarks.
+//
+// Produces a top module instantiating leaf modules with AUTOINST, AUTOLOGIC,
+// AUTOPORTS and AUTO_TEMPLATEs, shaped by DesignSpec. Output depends only on
+// the spec (no std:: distributions), so timings are comparable across
+// machines and runs.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace slang_autos::bench {
+
+/// Shape of a generated design.
+struct DesignSpec {
+    size_t modules = 8;         ///< Distinct leaf module types
+    size_t ports = 32;          ///< Ports per leaf module (first two are clk, rst_n)
+    size_t instances = 64;      ///< Leaf instances in the top module
+    size_t template_rules = 4;  ///< AUTO_TEMPLATE rules per leaf type (0 = no templates)
+    size_t generate_depth = 0;  ///< Nesting depth of generate blocks around instances
+    bool macro_widths = false;  ///< Declare port widths with `define macros
+    uint64_t seed = 1;          ///< Varies port widths
+};
+
+/// Files written by generateDesign().
+struct GeneratedDesign {
+    std::filesystem::path top;          ///< Top file (module name matches the stem)
+    std::filesystem::path lib_dir;      ///< Leaf modules, one per file
+    std::filesystem::path include_dir;  ///< Width macros (when macro_widths)
+    std::string top_module;
+
+    /// slang arguments to load the design (as for AutosTool::loadWithArgs)
+    [[nodiscard]] std::vector<std::string> args() const;
+};
+
+/// A port of a generated leaf module.
+struct GeneratedPort {
+    std::string name;
+    bool output = false;
+    int width = 1;
+};
+
+/// Ports of leaf module `m`, in declaration order.
+[[nodiscard]] std::vector<GeneratedPort> leafPorts(const DesignSpec& spec, size_t m);
+
+/// Source of leaf module `m`.
+[[nodiscard]] std::string generateLeafModule(const DesignSpec& spec, size_t m);
+
+/// Source of the top module.
+[[nodiscard]] std::string generateTopModule(const DesignSpec& spec);
+
+/// Source of the width macro header.
+[[nodiscard]] std::string generateWidthHeader(const DesignSpec& spec);
+
+/// Write a design under `dir` (created if needed, existing files overwritten).
+[[nodiscard]] GeneratedDesign generateDesign(const DesignSpec& spec,
+                                             const std::filesystem::path& dir);
+
+} // namespace slang_autos::bench
@@ -0,0 +1,115 @@
+// Micro benchmarks for the expansion building blocks on generated designs:
+// TemplateMatcher, SignalAggregator and SourceWriter.
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "DesignGenerator.h"
+#include "slang-autos/Parser.h"
+#include "slang-autos/SignalAggregator.h"
+#include "slang-autos/TemplateMatcher.h"
+#include "slang-autos/Writer.h"
+
+using namespace slang_autos;
+using namespace slang_autos::bench;
+
+// Ports of a generated leaf, as the port cache would return them.
+static std::vector<PortInfo> portInfos(const DesignSpec& spec, size_t m) {
+    std::vector<PortInfo> ports;
+    for (const auto& port : leafPorts(spec, m)) {
+        ports.emplace_back(port.name, port.output ? PortDirection::Output : PortDirection::Input,
+                           port.width);
+    }
+    return ports;
+}
+
+TEST_CASE("TemplateMatcher - ports x instances", "[bench][template]") {
+    for (size_t rules : {1, 4, 16}) {
+        DesignSpec spec;
+        spec.modules = 1;
+        spec.ports = 200;
+        spec.instances = 50;
+        spec.template_rules = rules;
+
+        AutoParser parser;
+        parser.parseText(generateTopModule(spec));
+        REQUIRE(parser.templates().size() == 1);
+        auto ports = portInfos(spec, 0);
+        REQUIRE(ports.size() == spec.ports);
+
+        BENCHMARK("200 ports x 50 instances, " + std::to_string(rules) + " rule(s)") {
+            TemplateMatcher matcher(&parser.templates().front());
+            size_t chars = 0;
+            for (size_t i = 0; i < spec.instances; ++i) {
+                matcher.setInstance("u_" + std::to_string(i) + "_leaf0");
+                for (const auto& port : ports) {
+                    chars += matcher.matchPort(port).signal_name.size();
+                }
+            }
+            return chars;
+        };
+    }
+}
+
+TEST_CASE("SignalAggregator - instances x ports", "[bench][aggregator]") {
+    DesignSpec spec;
+    spec.modules = 4;
+    spec.ports = 100;
+
+    std::vector<std::vector<PortInfo>> ports;
+    std::vector<std::vector<PortConnection>> connections;
+    for (size_t m = 0; m < spec.modules; ++m) {
+        ports.push_back(portInfos(spec, m));
+        auto& conns = connections.emplace_back();
+        for (const auto& port : ports.back()) {
+            PortConnection conn(port.name, port.name, port.direction);
+            conn.signal_identifiers = {port.name};
+            conns.push_back(std::move(conn));
+        }
+    }
+
+    for (size_t instances : {100, 1000}) {
+        BENCHMARK(std::to_string(instances) + " instances x 100 ports") {
+            SignalAggregator aggregator;
+            for (size_t i = 0; i < instances; ++i) {
+                size_t m = i % spec.modules;
+                aggregator.addFromInstance("u_" + std::to_string(i), connections[m], ports[m]);
+            }
+            return aggregator.getInternalNets().size();
+        };
+    }
+}
+
+TEST_CASE("SourceWriter - many replacements in a large file", "[bench][writer]") {
+    DesignSpec spec;
+    spec.modules = 8;
+    spec.instances = 20'000;
+    spec.template_rules = 0;
+    const std::string content = generateTopModule(spec);
+
+    // One replacement per AUTOINST marker, as the analyzer would produce
+    std::vector<Replacement> replacements;
+    const std::string marker = "/*AUTOINST*/";
+    for (size_t pos = content.find(marker); pos != std::string::npos;
+         pos = content.find(marker, pos + 1)) {
+        size_t end = pos + marker.size();
+        replacements.emplace_back(end, end, "\n        .clk (clk),\n        .rst_n (rst_n)\n    ");
+    }
+    REQUIRE(replacements.size() == spec.instances);
+
+    BENCHMARK("applyReplacements, 20k replacements") {
+        auto copy = replacements;
+        return SourceWriter().applyReplacements(content, copy).size();
+    };
+
+    auto path = std::filesystem::temp_directory_path() / "slang_autos_bench_writer.sv";
+    BENCHMARK("writeReplacements, 20k replacements") {
+        auto copy = replacements;
+        return SourceWriter().writeReplacements(path, content, copy);
+    };
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,86 @@
+// Macro benchmarks on generated designs: AutosAnalyzer (through
+// AutosTool::expandContent, with the compilation and port cache warm) and
+// the slang-autos CLI end to end.
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "DesignGenerator.h"
+#include "slang-autos/Tool.h"
+
+using namespace slang_autos;
+using namespace slang_autos::bench;
+
+namespace fs = std::filesystem;
+
+static std::string readFile(const fs::path& path) {
+    std::ifstream ifs(path);
+    std::stringstream buffer;
+    buffer << ifs.rdbuf();
+    return buffer.str();
+}
+
+struct NamedSpec {
+    const char* name;
+    DesignSpec spec;
+};
+
+static const NamedSpec kSpecs[] = {
+    {"small: 8 modules x 32 ports, 64 instances",
+     {.modules = 8, .ports = 32, .instances = 64, .template_rules = 4}},
+    {"wide: 4 modules x 500 ports, 200 instances",
+     {.modules = 4, .ports = 500, .instances = 200, .template_rules = 8}},
+    {"deep: 16 modules x 32 ports, 256 instances, generate depth 3",
+     {.modules = 16, .ports = 32, .instances = 256, .template_rules = 4, .generate_depth = 3}},
+    {"macros: 8 modules x 64 ports, 128 instances, macro widths",
+     {.modules = 8, .ports = 64, .instances = 128, .template_rules = 4, .macro_widths = true}},
+};
+
+TEST_CASE("AutosAnalyzer - generated designs", "[bench][analyzer]") {
+    for (const auto& [name, spec] : kSpecs) {
+        auto dir = fs::temp_directory_path() / "slang_autos_bench_analyzer";
+        fs::remove_all(dir);
+        auto design = generateDesign(spec, dir);
+        std::string content = readFile(design.top);
+
+        AutosTool tool;
+        REQUIRE(tool.loadWithArgs(design.args()));
+        auto warm = tool.expandContent(design.top, content);
+        REQUIRE(warm.success);
+        REQUIRE(warm.autoinst_count == static_cast<int>(spec.instances));
+
+        BENCHMARK(name) {
+            return tool.expandContent(design.top, content).replacements.size();
+        };
+
+        fs::remove_all(dir);
+    }
+}
+
+#ifdef SLANG_AUTOS_BENCH_CLI
+TEST_CASE("CLI - end to end", "[bench][cli]") {
+    for (const auto& [name, spec] : kSpecs) {
+        auto dir = fs::temp_directory_path() / "slang_autos_bench_cli";
+        fs::remove_all(dir);
+        auto design = generateDesign(spec, dir);
+
+        std::string command = std::string(SLANG_AUTOS_BENCH_CLI) + " --dry-run -q";
+        for (const auto& arg : design.args()) {
+            command += " \"" + arg + "\"";
+        }
+        REQUIRE(std::system(command.c_str()) == 0);
+
+        BENCHMARK(name) {
+            return std::system(command.c_str());
+        };
+
+        fs::remove_all(dir);
+    }
+}
+#endif
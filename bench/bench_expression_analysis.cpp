@@ -0,0 +1,72 @@
+// Benchmarks for expression analysis of AUTOINST connections.
+// Compares the lexical fast path in analyzeExpression() with running the
+// slang parser on every connection, over a 100k-connection corpus shaped like
+// template output (mostly plain names, some selects and concatenations).
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <vector>
+
+#include <slang/parsing/Parser.h>
+#include <slang/parsing/Preprocessor.h>
+#include <slang/syntax/AllSyntax.h>
+#include <slang/text/SourceManager.h>
+
+#include "slang-autos/SignalAggregator.h"
+
+using namespace slang_autos;
+
+static std::vector<std::string> makeCorpus(size_t count) {
+    std::vector<std::string> corpus;
+    corpus.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::string n = std::to_string(i);
+        switch (i % 10) {
+            case 0: corpus.push_back("data_" + n + "[" + std::to_string(i % 64) + "]"); break;
+            case 1: corpus.push_back("bus_" + n + "[31:0]"); break;
+            case 2: corpus.push_back("{hi_" + n + ", lo_" + n + "[7:0]}"); break;
+            case 3: corpus.push_back("{1'b0, sig_" + n + "}"); break;
+            default: corpus.push_back("sig_" + n); break;
+        }
+    }
+    return corpus;
+}
+
+// The pre-fast-path route: one slang parse per expression.
+static ExpressionInfo parseExpression(std::string_view expr) {
+    slang::BumpAllocator alloc;
+    slang::Diagnostics diagnostics;
+    slang::SourceManager sourceManager;
+
+    slang::parsing::Preprocessor preprocessor(sourceManager, alloc, diagnostics);
+    preprocessor.pushSource(expr);
+
+    slang::parsing::Parser parser(preprocessor);
+    return analyzeExpressionSyntax(parser.parseExpression());
+}
+
+TEST_CASE("Expression analysis - 100k connections", "[bench][expr]") {
+    const auto corpus = makeCorpus(100'000);
+
+    for (const auto& expr : corpus) {
+        auto fast = analyzeExpression(expr);
+        auto full = parseExpression(expr);
+        REQUIRE(fast.identifiers == full.identifiers);
+        REQUIRE(fast.max_bit_index == full.max_bit_index);
+        REQUIRE(fast.is_concatenation == full.is_concatenation);
+    }
+
+    BENCHMARK("slang parser") {
+        size_t ids = 0;
+        for (const auto& expr : corpus) ids += parseExpression(expr).identifiers.size();
+        return ids;
+    };
+
+    BENCHMARK("analyzeExpression (lexical fast path)") {
+        size_t ids = 0;
+        for (const auto& expr : corpus) ids += analyzeExpression(expr).identifiers.size();
+        return ids;
+    };
+}
@@ -0,0 +1,123 @@
+// Benchmarks for the LSP JSON-RPC transport with MB-sized payloads.
+// Compares the rfl::Generic route (RpcRequest + from_generic/to_generic) with
+// the typed route used for textDocument/didChange and workspace/executeCommand.
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+#include <string>
+
+#include "lsp/JsonRpc.h"
+#include "lsp/LspTypes.h"
+
+using namespace lsp;
+
+// Synthetic SystemVerilog of roughly `bytes` bytes. Includes quotes,
+// backslashes and tabs so JSON string escaping is exercised.
+static std::string makeSource(size_t bytes) {
+    static const std::string chunk =
+        "module m;\n"
+        "\tlogic [7:0] data; // \"quoted\" comment\n"
+        "\tinitial $display(\"value=%0d\\n\", data);\n"
+        "endmodule\n";
+    std::string text;
+    text.reserve(bytes + chunk.size());
+    while (text.size() < bytes) {
+        text += chunk;
+    }
+    return text;
+}
+
+static std::string frame(const std::string& body) {
+    return "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+}
+
+static std::string makeDidChange(const std::string& text) {
+    return rfl::json::write<rfl::UnderlyingEnums>(TypedRpcRequest<DidChangeTextDocumentParams>{
+        .jsonrpc = "2.0",
+        .method = "textDocument/didChange",
+        .params = DidChangeTextDocumentParams{
+            .textDocument = VersionedTextDocumentIdentifier{.version = 2, .uri = "file:///bench.sv"},
+            .contentChanges = {TextDocumentContentChangeWholeDocument{.text = text}},
+        },
+    });
+}
+
+static WorkspaceEdit makeWholeFileEdit(const std::string& text) {
+    WorkspaceEdit edit;
+    edit.changes = std::unordered_map<std::string, std::vector<TextEdit>>{};
+    edit.changes->emplace("file:///bench.sv",
+                          std::vector<TextEdit>{TextEdit{
+                              .range = Range{.start = Position{.line = 0, .character = 0},
+                                             .end = Position{.line = 100000, .character = 0}},
+                              .newText = text,
+                          }});
+    return edit;
+}
+
+TEST_CASE("LSP transport - framing", "[bench][lsp]") {
+    for (size_t mb : {1, 4, 16}) {
+        std::string body = makeDidChange(makeSource(mb << 20));
+        std::istringstream in(frame(body));
+        std::string header;
+        std::string content;
+
+        REQUIRE(readMessage(in, header, content));
+        REQUIRE(content == body);
+
+        BENCHMARK("readMessage " + std::to_string(mb) + "MB") {
+            in.clear();
+            in.seekg(0);
+            readMessage(in, header, content);
+            return content.size();
+        };
+    }
+}
+
+TEST_CASE("LSP transport - didChange deserialization", "[bench][lsp]") {
+    for (size_t mb : {1, 4, 16}) {
+        std::string text = makeSource(mb << 20);
+        std::string body = makeDidChange(text);
+
+        REQUIRE(peekMethod(body) == "textDocument/didChange");
+        auto typed = rfl::json::read<TypedRpcRequest<DidChangeTextDocumentParams>,
+                                     rfl::UnderlyingEnums>(body);
+        REQUIRE(typed);
+        REQUIRE(typed.value().params->contentChanges.size() == 1);
+
+        BENCHMARK("generic " + std::to_string(mb) + "MB") {
+            auto req = rfl::json::read<RpcRequest>(body).value();
+            auto params = rfl::from_generic<DidChangeTextDocumentParams, rfl::UnderlyingEnums>(
+                              req.params.value())
+                              .value();
+            return params.contentChanges.size();
+        };
+
+        BENCHMARK("typed " + std::to_string(mb) + "MB") {
+            auto req = rfl::json::read<TypedRpcRequest<DidChangeTextDocumentParams>,
+                                       rfl::UnderlyingEnums>(body)
+                           .value();
+            return req.params->contentChanges.size();
+        };
+    }
+}
+
+TEST_CASE("LSP transport - executeCommand response serialization", "[bench][lsp]") {
+    for (size_t mb : {1, 4, 16}) {
+        WorkspaceEdit edit = makeWholeFileEdit(makeSource(mb << 20));
+
+        BENCHMARK("generic " + std::to_string(mb) + "MB") {
+            return rfl::json::write(RpcResponse{
+                                        .jsonrpc = "2.0",
+                                        .id = 1,
+                                        .result = rfl::to_generic<rfl::UnderlyingEnums>(edit),
+                                    })
+                .size();
+        };
+
+        BENCHMARK("typed " + std::to_string(mb) + "MB") {
+            return rfl::json::write<rfl::UnderlyingEnums>(edit).size();
+        };
+    }
+}
@@ -8,20 +8,165 @@
 
 #include "AutosServer.h"
 #include "lsp/URI.h"
+#include "slang-autos/AutoStripper.h"
+#include "slang-autos/Config.h"
+#include "slang-autos/Parser.h"
 #include "slang-autos/Tool.h"
+#include "slang/syntax/SyntaxTree.h"
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <sstream>
+#include <utility>
 
 namespace autos {
 
+namespace {
+
+/// Maps byte offsets in a document to LSP positions.
+/// LSP characters are UTF-16 code units, so multi-byte UTF-8 is accounted for.
+class PositionMapper {
+public:
+    explicit PositionMapper(std::string_view text) : text_(text) {
+        lineStarts_.push_back(0);
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '\n') {
+                lineStarts_.push_back(i + 1);
+            }
+        }
+    }
+
+    lsp::Position at(size_t offset) const {
+        offset = std::min(offset, text_.size());
+        auto it = std::upper_bound(lineStarts_.begin(), lineStarts_.end(), offset);
+        size_t line = static_cast<size_t>(it - lineStarts_.begin()) - 1;
+
+        unsigned int character = 0;
+        for (size_t i = lineStarts_[line]; i < offset; ++i) {
+            auto c = static_cast<unsigned char>(text_[i]);
+            if ((c & 0xC0) == 0x80) {
+                continue;  // UTF-8 continuation byte
+            }
+            character += (c >= 0xF0) ? 2 : 1;  // 4-byte sequences are surrogate pairs
+        }
+        return lsp::Position{.line = static_cast<unsigned int>(line), .character = character};
+    }
+
+private:
+    std::string_view text_;
+    std::vector<size_t> lineStarts_;
+};
+
+/// Convert replacements (offsets into `content`) to LSP edits, dropping
+/// replacements that leave the text unchanged so untouched blocks keep
+/// their cursor and folding state.
+std::vector<lsp::TextEdit> toTextEdits(const std::string& content,
+                                       std::vector<slang_autos::Replacement> replacements) {
+    std::sort(replacements.begin(), replacements.end(),
+              [](const auto& a, const auto& b) { return a.start < b.start; });
+
+    PositionMapper positions(content);
+    std::vector<lsp::TextEdit> edits;
+    edits.reserve(replacements.size());
+    for (const auto& r : replacements) {
+        if (r.end <= content.size() &&
+            std::string_view(content).substr(r.start, r.end - r.start) == r.new_text) {
+            continue;
+        }
+        edits.push_back(lsp::TextEdit{
+            .range = lsp::Range{.start = positions.at(r.start), .end = positions.at(r.end)},
+            .newText = r.new_text,
+        });
+    }
+    return edits;
+}
+
+/// Format a tool diagnostic as "file:line: message"
+std::string formatDiagnostic(const slang_autos::Diagnostic& diag) {
+    if (diag.file_path.empty()) {
+        return diag.message;
+    }
+    std::string msg = diag.file_path;
+    if (diag.line_number > 0) {
+        msg += ":" + std::to_string(diag.line_number);
+    }
+    return msg + ": " + diag.message;
+}
+
+/// Diagnostic text for a stale block, from its replacement description
+/// (e.g. "AUTOINST: u_sub" -> "AUTOINST is out of date for u_sub")
+std::string staleMessage(const std::string& description) {
+    std::string msg = description.substr(0, description.find_first_of(": ")) + " is out of date";
+    if (auto colon = description.find(": "); colon != std::string::npos) {
+        msg += " for " + description.substr(colon + 2);
+    }
+    return msg;
+}
+
+/// Key for comparing file paths: canonical where the file exists
+std::string pathKey(const std::filesystem::path& path) {
+    std::error_code ec;
+    auto canonical = std::filesystem::weakly_canonical(path, ec);
+    return (ec ? path.lexically_normal() : canonical).string();
+}
+
+/// Every file a tool's compilation read, as pathKey()
+std::unordered_set<std::string> designFiles(const slang_autos::AutosTool& tool) {
+    std::unordered_set<std::string> files;
+    for (const auto& file : tool.sourceFiles()) {
+        files.insert(pathKey(file));
+    }
+    return files;
+}
+
+/// Recompile a tool after `changed` were saved. On failure the tool holds no
+/// usable compilation and must be discarded.
+bool reloadTool(slang_autos::AutosTool& tool, const std::vector<std::filesystem::path>& changed,
+                std::vector<std::string>& errors, slang_autos::ProgressCallback progress) {
+    tool.setProgressCallback(std::move(progress));
+    bool loaded = tool.reload(changed);
+    tool.setProgressCallback(nullptr);
+    if (!loaded) {
+        for (const auto& diag : tool.diagnostics().diagnostics()) {
+            errors.push_back(formatDiagnostic(diag));
+        }
+    }
+    tool.diagnostics().clear();
+    return loaded;
+}
+
+size_t hashCombine(size_t seed, std::string_view text) {
+    return seed ^ (std::hash<std::string_view>{}(text) + 0x9e3779b97f4a7c15ULL + (seed << 6) +
+                   (seed >> 2));
+}
+
+} // namespace
+
 AutosServer::AutosServer() {
     registerInitialize();
     registerInitialized();
     registerShutdown();
     registerExit();
+    registerWindowWorkDoneProgressCancel();
+    registerDocDidOpen();
+    registerDocDidChange();
+    registerDocDidSave();
+    registerDocDidClose();
+
+    m_backgroundThread = std::thread([this] { backgroundLoop(); });
+}
+
+AutosServer::~AutosServer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        m_stopping = true;
+    }
+    m_backgroundCv.notify_all();
+    m_backgroundThread.join();
 }
 
 lsp::InitializeResult AutosServer::getInitialize(const lsp::InitializeParams& params) {
@@ -46,17 +191,45 @@ lsp::InitializeResult AutosServer::getInitialize(const lsp::InitializeParams& pa
         };
     }
 
+    // Client settings
+    if (params.initializationOptions) {
+        auto options = rfl::from_generic<AutosInitOptions>(*params.initializationOptions);
+        if (options) {
+            m_expandOnSave = options.value().expandOnSave.value_or(false);
+            if (auto budget = options.value().expandOnSaveBudgetMs; budget && *budget > 0) {
+                m_saveBudget = std::chrono::milliseconds(*budget);
+            }
+            m_staleDiagnostics = options.value().staleDiagnostics.value_or(false);
+            if (auto delay = options.value().staleDiagnosticsDelayMs; delay && *delay >= 0) {
+                m_stalenessDelay = std::chrono::milliseconds(*delay);
+            }
+        }
+    }
+    if (m_expandOnSave) {
+        registerDocWillSaveWaitUntil();
+    }
+
     std::cerr << "slang-autos LSP initialized";
     if (m_workspaceFolder) {
         std::cerr << " at " << m_workspaceFolder->uri.getPath();
     }
+    if (m_expandOnSave) {
+        std::cerr << " (expand on save, " << m_saveBudget.count() << "ms budget)";
+    }
     std::cerr << "\n";
 
     // Return capabilities
     return lsp::InitializeResult{
         .capabilities = lsp::ServerCapabilities{
+            .textDocumentSync = lsp::TextDocumentSyncOptions{
+                .openClose = true,
+                .change = lsp::TextDocumentSyncKind::Full,
+                .willSaveWaitUntil = m_expandOnSave,
+                .save = true,
+            },
             .executeCommandProvider = lsp::ExecuteCommandOptions{
                 .commands = getCommandList(),
+                .workDoneProgress = true,
             },
         },
         .serverInfo = lsp::ServerInfo{
@@ -72,75 +245,674 @@ void AutosServer::onInitialized(const lsp::InitializedParams&) {
 
 std::monostate AutosServer::getShutdown(std::monostate) {
     std::cerr << "slang-autos LSP shutting down\n";
+    m_stopping = true;
+    m_backgroundCv.notify_all();
     return std::monostate{};
 }
 
-ExpandResult AutosServer::expandAutos(const std::string& fileUri) {
-    ExpandResult result;
+lsp::RawJson AutosServer::executeCommand(const lsp::ExecuteCommandParams& params) {
+    m_workDoneToken = params.workDoneToken;
+    {
+        // Tokens may be integers or strings; compare their JSON forms
+        std::lock_guard<std::mutex> lock(m_cancelMutex);
+        m_runningToken.reset();
+        if (m_workDoneToken) {
+            m_runningToken = rfl::json::write(*m_workDoneToken);
+        }
+        m_cancelRequested = false;
+    }
+    auto result = LspServer::executeCommand(params);
+    {
+        std::lock_guard<std::mutex> lock(m_cancelMutex);
+        m_runningToken.reset();
+    }
+    m_workDoneToken.reset();
+    return result;
+}
 
-    // Convert URI to file path
-    URI fileUriObj(fileUri);
-    std::filesystem::path filePath(fileUriObj.getPath());
+void AutosServer::onWindowWorkDoneProgressCancel(const lsp::WorkDoneProgressCancelParams& params) {
+    // A cancel for a command that already finished matches nothing and is dropped
+    std::lock_guard<std::mutex> lock(m_cancelMutex);
+    if (m_runningToken && rfl::json::write(params.token) == *m_runningToken) {
+        m_cancelRequested = true;
+    }
+}
 
-    std::cerr << "Expanding AUTOs in: " << filePath << "\n";
+// ════════════════════════════════════════════════════════════════════════════
+// Work-done progress
+// ════════════════════════════════════════════════════════════════════════════
+
+void AutosServer::sendProgress(lsp::LSPAny value) {
+    if (!m_workDoneToken) {
+        return;
+    }
+    lsp::sendNotification("$/progress", rfl::to_generic<rfl::UnderlyingEnums>(lsp::ProgressParams{
+                                            .token = *m_workDoneToken,
+                                            .value = std::move(value),
+                                        }));
+}
+
+void AutosServer::beginProgress(const std::string& title) {
+    sendProgress(rfl::to_generic<rfl::UnderlyingEnums>(lsp::WorkDoneProgressBegin{
+        .title = title,
+        .cancellable = true,
+        .percentage = 0,
+    }));
+}
+
+void AutosServer::reportProgress(const std::string& message, unsigned int percentage) {
+    sendProgress(rfl::to_generic<rfl::UnderlyingEnums>(lsp::WorkDoneProgressReport{
+        .message = message,
+        .percentage = percentage,
+    }));
+}
+
+void AutosServer::endProgress(const std::string& message) {
+    sendProgress(rfl::to_generic<rfl::UnderlyingEnums>(lsp::WorkDoneProgressEnd{
+        .message = message,
+    }));
+}
+
+bool AutosServer::onToolProgress(const slang_autos::ProgressEvent& event) {
+    // Percentage bands per phase; analysis dominates so it gets the widest band
+    unsigned int percentage = 0;
+    std::string message(slang_autos::phaseName(event.phase));
+    switch (event.phase) {
+        case slang_autos::ExpansionPhase::Parse:
+            percentage = 0;
+            break;
+        case slang_autos::ExpansionPhase::Elaborate:
+            percentage = 10;
+            break;
+        case slang_autos::ExpansionPhase::Analyze:
+            percentage = 30;
+            if (event.total > 0) {
+                percentage += static_cast<unsigned int>(60 * event.current / event.total);
+            }
+            message += " " + std::string(event.detail) + " (" +
+                       std::to_string(event.current + 1) + "/" +
+                       std::to_string(event.total) + ")";
+            break;
+        case slang_autos::ExpansionPhase::Generate:
+            percentage = 90;
+            break;
+    }
+    reportProgress(message, std::min(percentage, 100u));
+    return !m_cancelRequested;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// Documents and design models
+// ════════════════════════════════════════════════════════════════════════════
+
+void AutosServer::onDocDidOpen(const lsp::DidOpenTextDocumentParams& params) {
+    const auto& doc = params.textDocument;
+    m_documents[doc.uri.str()] = doc.text;
+
+    // Load the design up front so the first save does not pay for elaboration
+    if (m_expandOnSave) {
+        scheduleLoad(doc.uri.str());
+    }
+    scheduleStaleness(doc.uri.str());
+}
+
+void AutosServer::onDocDidChange(const lsp::DidChangeTextDocumentParams& params) {
+    auto it = m_documents.find(params.textDocument.uri.str());
+    if (it == m_documents.end()) {
+        return;
+    }
+    // Full sync: the last whole-document change is the current text
+    for (const auto& change : params.contentChanges) {
+        rfl::visit(
+            [&](const auto& c) {
+                using T = std::decay_t<decltype(c)>;
+                if constexpr (std::is_same_v<T, lsp::TextDocumentContentChangeWholeDocument>) {
+                    it->second = c.text;
+                }
+            },
+            change);
+    }
+    scheduleStaleness(it->first);
+}
+
+void AutosServer::onDocDidSave(const lsp::DidSaveTextDocumentParams& params) {
+    const auto& uri = params.textDocument.uri;
+    std::filesystem::path savedPath(uri.getPath());
+    std::string savedKey = pathKey(savedPath);
+    ++m_saveCount;
+
+    // Open documents whose design read the saved file (or has none yet) are
+    // rebuilt on the background thread, not here on the dispatcher
+    for (const auto& [openUri, text] : m_documents) {
+        auto it = m_models.find(std::filesystem::path(URI(openUri).getPath()).string());
+        if (it == m_models.end() || it->second->files.contains(savedKey)) {
+            if (m_expandOnSave) {
+                scheduleLoad(openUri);
+            }
+            scheduleStaleness(openUri);
+        }
+    }
+
+    // Only designs that read the saved file are rebuilt, and they keep the
+    // ports of modules declared elsewhere
+    for (auto& [path, model] : m_models) {
+        if (model->files.contains(savedKey)) {
+            model->changedFiles.push_back(savedPath);
+            ++model->generation;
+        }
+    }
+}
+
+void AutosServer::onDocDidClose(const lsp::DidCloseTextDocumentParams& params) {
+    const auto& uri = params.textDocument.uri;
+    m_documents.erase(uri.str());
+    m_models.erase(std::filesystem::path(uri.getPath()).string());
+
+    m_pendingLoads.erase(uri.str());
+    if (m_staleDiagnostics) {
+        m_pendingStaleness.erase(uri.str());
+        lsp::sendNotification("textDocument/publishDiagnostics",
+                              rfl::to_generic<rfl::UnderlyingEnums>(
+                                  lsp::PublishDiagnosticsParams{.uri = uri, .diagnostics = {}}));
+    }
+}
+
+bool AutosServer::readDocument(const std::string& uri, const std::filesystem::path& filePath,
+                               std::string& content) const {
+    if (auto it = m_documents.find(uri); it != m_documents.end()) {
+        content = it->second;
+        return true;
+    }
 
-    // Read original content to get line count for full-file replacement
     std::ifstream ifs(filePath);
     if (!ifs) {
-        std::string msg = "Failed to open file: " + filePath.string();
-        std::cerr << msg << "\n";
-        result.errors.push_back(msg);
-        return result;
+        return false;
     }
     std::stringstream buffer;
     buffer << ifs.rdbuf();
-    std::string originalContent = buffer.str();
-    ifs.close();
+    content = buffer.str();
+    return true;
+}
+
+std::shared_ptr<AutosServer::DesignModel> AutosServer::getModel(
+    const std::filesystem::path& filePath, const std::string& content,
+    std::vector<std::string>& errors, slang_autos::ProgressCallback progress) {
+    if (auto it = m_models.find(filePath.string()); it != m_models.end()) {
+        auto model = it->second;
+        if (model->changedFiles.empty()) {
+            return model;
+        }
+        // Waits for the background thread if it is analyzing with this tool
+        std::lock_guard<std::mutex> toolLock(model->toolMutex);
+        if (!reloadTool(*model->tool, model->changedFiles, errors, std::move(progress))) {
+            m_models.erase(it);
+            return nullptr;
+        }
+        model->staleness.clear();
+        model->files = designFiles(*model->tool);
+        model->changedFiles.clear();
+        return model;
+    }
+
+    auto tool = loadTool(filePath, content, errors, std::move(progress));
+    if (!tool) {
+        return nullptr;
+    }
+    auto model = std::make_shared<DesignModel>();
+    model->files = designFiles(*tool);
+    model->tool = std::move(tool);
+    m_models.emplace(filePath.string(), model);
+    return model;
+}
+
+std::shared_ptr<AutosServer::DesignModel> AutosServer::loadModel(
+    const std::string& uri, std::unique_lock<std::mutex>& lock) {
+    auto doc = m_documents.find(uri);
+    if (doc == m_documents.end()) {
+        return nullptr;
+    }
+    std::filesystem::path filePath(URI(uri).getPath());
+    std::vector<std::string> errors;
+
+    if (auto it = m_models.find(filePath.string()); it != m_models.end()) {
+        auto model = it->second;
+        if (model->changedFiles.empty()) {
+            return model;
+        }
+
+        // Take the tool before releasing the server mutex, so no request
+        // can use it before it is rebuilt
+        std::unique_lock<std::mutex> toolLock(model->toolMutex);
+        auto changed = std::exchange(model->changedFiles, {});
+        lock.unlock();
+        bool loaded = reloadTool(*model->tool, changed, errors, nullptr);
+        std::unordered_set<std::string> files;
+        if (loaded) {
+            model->staleness.clear();
+            files = designFiles(*model->tool);
+        }
+        toolLock.unlock();
+        lock.lock();
+
+        if (!loaded) {
+            if (auto current = m_models.find(filePath.string());
+                current != m_models.end() && current->second == model) {
+                m_models.erase(current);
+            }
+            return nullptr;
+        }
+        model->files = std::move(files);
+        // Saved again during the reload: the next run picks that up
+        return model->changedFiles.empty() ? model : nullptr;
+    }
+
+    // Elaboration can take seconds, so a missing model is built without the
+    // server mutex; requests and edits are handled in the meantime
+    std::string text = doc->second;
+    uint64_t saveCount = m_saveCount;
+    lock.unlock();
+    auto tool = loadTool(filePath, text, errors);
+    std::unordered_set<std::string> files;
+    if (tool) {
+        files = designFiles(*tool);
+    }
+    lock.lock();
+
+    if (!tool || m_stopping || !m_documents.contains(uri)) {
+        return nullptr;
+    }
+    if (saveCount != m_saveCount) {
+        // A save during the load may have changed a file it read; the save
+        // scheduled another run
+        return nullptr;
+    }
+    auto model = std::make_shared<DesignModel>();
+    model->tool = std::move(tool);
+    model->files = std::move(files);
+    return m_models.try_emplace(filePath.string(), std::move(model)).first->second;
+}
 
-    // Count lines in original content
-    size_t lineCount = 0;
-    for (char c : originalContent) {
-        if (c == '\n') lineCount++;
+std::unique_ptr<slang_autos::AutosTool> AutosServer::loadTool(
+    const std::filesystem::path& filePath, const std::string& content,
+    std::vector<std::string>& errors, slang_autos::ProgressCallback progress) {
+    namespace fs = std::filesystem;
+    using namespace slang_autos;
+
+    // Same configuration sources as the CLI: .slang-autos.toml (paths relative
+    // to the config file) and inline config (paths relative to the source file)
+    DiagnosticCollector configDiagnostics;
+    fs::path fileDir = fs::absolute(filePath).parent_path();
+    fs::path configDir = fileDir;
+    std::optional<FileConfig> fileConfig;
+    if (auto configPath = ConfigLoader::findConfigFile(fileDir)) {
+        fileConfig = ConfigLoader::loadFile(*configPath, &configDiagnostics);
+        configDir = fs::absolute(*configPath).parent_path();
     }
-    // Add 1 if file doesn't end with newline
-    if (!originalContent.empty() && originalContent.back() != '\n') {
-        lineCount++;
+    InlineConfig inlineConfig = parseInlineConfig(content, filePath.string(), &configDiagnostics);
+    for (const auto& diag : configDiagnostics.diagnostics()) {
+        std::cerr << "config: " << formatDiagnostic(diag) << "\n";
     }
 
-    // Create tool and expand
-    slang_autos::AutosTool tool;
+    MergedConfig merged = ConfigLoader::merge(fileConfig, InlineConfig{}, AutosTool::Options{});
 
-    // TODO: Need to get compile arguments from somewhere
-    // For now, just use the single file - this won't work for modules
-    // that need other files to be compiled
     std::vector<std::string> args = {filePath.string()};
+    auto addLibdirs = [&args](const std::vector<std::string>& dirs, const fs::path& base) {
+        for (const auto& dir : dirs) {
+            args.push_back("-y");
+            args.push_back((base / dir).lexically_normal().string());
+        }
+    };
+    auto addIncdirs = [&args](const std::vector<std::string>& dirs, const fs::path& base) {
+        for (const auto& dir : dirs) {
+            args.push_back("+incdir+" + (base / dir).lexically_normal().string());
+        }
+    };
+    addLibdirs(merged.libdirs, configDir);
+    addLibdirs(inlineConfig.libdirs, fileDir);
+    addIncdirs(merged.incdirs, configDir);
+    addIncdirs(inlineConfig.incdirs, fileDir);
+    for (const auto& ext : merged.libext) {
+        args.push_back("+libext+" + ext);
+    }
+    for (const auto& ext : inlineConfig.libext) {
+        args.push_back("+libext+" + ext);
+    }
+    if (merged.single_unit) {
+        args.push_back("--single-unit");
+    }
 
-    if (!tool.loadWithArgs(args)) {
-        std::string msg = "Failed to load file for compilation. Check that all referenced modules are available.";
+    auto tool = std::make_unique<AutosTool>(merged.toToolOptions());
+    tool->setInlineConfig(filePath, inlineConfig);
+    tool->setProgressCallback(std::move(progress));
+    bool loaded = tool->loadWithArgs(args);
+    tool->setProgressCallback(nullptr);
+
+    if (!loaded) {
+        for (const auto& diag : tool->diagnostics().diagnostics()) {
+            errors.push_back(formatDiagnostic(diag));
+        }
+        return nullptr;
+    }
+
+    tool->diagnostics().clear();
+    return tool;
+}
+
+std::optional<std::vector<lsp::TextEdit>> AutosServer::getDocWillSaveWaitUntil(
+    const lsp::WillSaveTextDocumentParams& params) {
+    using clock = std::chrono::steady_clock;
+
+    // Every early return lets the save go through unexpanded
+    if (!m_expandOnSave) {
+        return std::nullopt;
+    }
+    const auto& uri = params.textDocument.uri;
+    std::filesystem::path filePath(uri.getPath());
+    auto doc = m_documents.find(uri.str());
+    if (doc == m_documents.end()) {
+        return std::nullopt;
+    }
+
+    // A save that ran over budget skips the next ones, but the estimate is
+    // halved on each skip so the file is retried rather than locked out
+    if (auto cached = m_models.find(filePath.string());
+        cached != m_models.end() && cached->second->lastExpandTime > m_saveBudget) {
+        cached->second->lastExpandTime /= 2;
+        return std::nullopt;
+    }
+
+    // The model is loaded on open and rebuilt after each save on the
+    // background thread. Elaboration alone can exceed the budget, so a save
+    // that finds no warm model only queues the load.
+    auto cached = m_models.find(filePath.string());
+    if (cached == m_models.end() || !cached->second->changedFiles.empty()) {
+        scheduleLoad(uri.str());
+        std::cerr << "Expand on save skipped for " << filePath.string()
+                  << " (design not loaded yet)\n";
+        return std::nullopt;
+    }
+    auto model = cached->second;
+    std::unique_lock<std::mutex> toolLock(model->toolMutex, std::try_to_lock);
+    if (!toolLock) {
+        std::cerr << "Expand on save skipped for " << filePath.string()
+                  << " (design busy)\n";
+        return std::nullopt;
+    }
+
+    auto start = clock::now();
+    auto deadline = start + m_saveBudget;
+    auto withinBudget = [deadline](const slang_autos::ProgressEvent&) {
+        return clock::now() < deadline;
+    };
+
+    auto& tool = *model->tool;
+    tool.diagnostics().clear();
+    tool.setProgressCallback(withinBudget);
+    auto expansion = tool.expandContent(filePath, doc->second);
+    tool.setProgressCallback(nullptr);
+    model->lastExpandTime =
+        std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start);
+
+    if (expansion.cancelled || !expansion.success) {
+        std::cerr << "Expand on save skipped for " << filePath.string() << " ("
+                  << model->lastExpandTime.count() << "ms)\n";
+        return std::nullopt;
+    }
+    return toTextEdits(doc->second, std::move(expansion.replacements));
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// Background thread
+// ════════════════════════════════════════════════════════════════════════════
+
+void AutosServer::scheduleLoad(const std::string& uri) {
+    m_pendingLoads.insert(uri);
+    m_backgroundCv.notify_one();
+}
+
+void AutosServer::scheduleStaleness(const std::string& uri) {
+    if (!m_staleDiagnostics) {
+        return;
+    }
+    // Each edit pushes the deadline back, so a burst of typing costs one check
+    m_pendingStaleness[uri] = std::chrono::steady_clock::now() + m_stalenessDelay;
+    m_backgroundCv.notify_one();
+}
+
+void AutosServer::backgroundLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!m_stopping) {
+        // Loads first: a save may be waiting on them
+        if (!m_pendingLoads.empty()) {
+            std::string uri = *m_pendingLoads.begin();
+            m_pendingLoads.erase(m_pendingLoads.begin());
+            loadModel(uri, lock);
+            continue;
+        }
+
+        if (m_pendingStaleness.empty()) {
+            m_backgroundCv.wait(lock);
+            continue;
+        }
+
+        auto next = std::min_element(
+            m_pendingStaleness.begin(), m_pendingStaleness.end(),
+            [](const auto& a, const auto& b) { return a.second < b.second; });
+        if (std::chrono::steady_clock::now() < next->second) {
+            m_backgroundCv.wait_until(lock, next->second);
+            continue;
+        }
+
+        std::string uri = next->first;
+        m_pendingStaleness.erase(next);
+        publishStaleness(uri, lock);
+    }
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// Staleness diagnostics
+// ════════════════════════════════════════════════════════════════════════════
+
+void AutosServer::publishStaleness(const std::string& uri, std::unique_lock<std::mutex>& lock) {
+    auto model = loadModel(uri, lock);
+    auto doc = m_documents.find(uri);
+    if (!model || m_stopping || doc == m_documents.end()) {
+        // Without a design there is nothing to compare against
+        return;
+    }
+    std::filesystem::path filePath(URI(uri).getPath());
+
+    // Analyze a copy of the text without the server mutex. Only this thread
+    // holds toolMutex without the server mutex, so it is free here.
+    const std::string text = doc->second;
+    const uint64_t generation = model->generation;
+    std::unique_lock<std::mutex> toolLock(model->toolMutex);
+    lock.unlock();
+    auto diagnostics = analyzeStaleness(*model, filePath, text);
+    toolLock.unlock();
+    lock.lock();
+
+    // An edit or a save during the analysis has queued another run
+    doc = m_documents.find(uri);
+    auto current = m_models.find(filePath.string());
+    if (!diagnostics || m_stopping || doc == m_documents.end() || doc->second != text ||
+        current == m_models.end() || current->second != model ||
+        model->generation != generation) {
+        return;
+    }
+
+    lsp::sendNotification("textDocument/publishDiagnostics",
+                          rfl::to_generic<rfl::UnderlyingEnums>(lsp::PublishDiagnosticsParams{
+                              .uri = URI(uri),
+                              .diagnostics = std::move(*diagnostics),
+                          }));
+}
+
+std::optional<std::vector<lsp::Diagnostic>> AutosServer::analyzeStaleness(
+    DesignModel& model, const std::filesystem::path& filePath, const std::string& text) {
+    std::string_view content = text;
+
+    struct Span {
+        std::string name;
+        size_t start;
+        size_t end;
+    };
+    std::vector<Span> spans;
+    std::unordered_map<std::string, ModuleStaleness> modules;
+
+    auto run = [&](bool reuseCache) {
+        spans.clear();
+        modules.clear();
+        auto filter = [&](const slang_autos::ModuleSpan& span) {
+            std::string name(span.name);
+            size_t hash = hashCombine(0, content.substr(span.start, span.end - span.start));
+            spans.push_back({name, span.start, span.end});
+
+            auto cached = model.staleness.find(name);
+            if (reuseCache && cached != model.staleness.end() && cached->second.hash == hash) {
+                modules[name] = cached->second;
+                return false;
+            }
+            modules[name] = ModuleStaleness{hash, {}};
+            return true;
+        };
+
+        auto& tool = *model.tool;
+        tool.diagnostics().clear();
+        auto expansion = tool.expandContent(filePath, text, filter);
+        if (!expansion.success) {
+            return false;
+        }
+
+        // Assign each out-of-date replacement to its module
+        for (const auto& r : expansion.replacements) {
+            auto span = std::find_if(spans.begin(), spans.end(), [&](const Span& s) {
+                return r.start >= s.start && r.start <= s.end;
+            });
+            if (span == spans.end() ||
+                !slang_autos::differsIgnoringWhitespace(
+                    content.substr(r.start, r.end - r.start), r.new_text)) {
+                continue;
+            }
+            modules[span->name].blocks.push_back(
+                {r.start - span->start, r.end - span->start, r.description});
+        }
+        return true;
+    };
+
+    if (!run(/*reuseCache=*/true)) {
+        return std::nullopt;
+    }
+
+    // Templates and inline config outside modules affect every module
+    size_t outsideHash = 0;
+    size_t pos = 0;
+    for (const auto& span : spans) {
+        outsideHash = hashCombine(outsideHash, content.substr(pos, span.start - pos));
+        pos = span.end;
+    }
+    outsideHash = hashCombine(outsideHash, content.substr(pos));
+    if (outsideHash != model.outsideHash && !model.staleness.empty()) {
+        if (!run(/*reuseCache=*/false)) {
+            return std::nullopt;
+        }
+    }
+    model.outsideHash = outsideHash;
+    model.staleness = modules;
+
+    PositionMapper positions(content);
+    std::vector<lsp::Diagnostic> diagnostics;
+    for (const auto& span : spans) {
+        for (const auto& block : modules[span.name].blocks) {
+            diagnostics.push_back(lsp::Diagnostic{
+                .range = lsp::Range{
+                    .start = positions.at(span.start + block.start),
+                    .end = positions.at(span.start + block.end),
+                },
+                .severity = lsp::DiagnosticSeverity::Warning,
+                .source = "slang-autos",
+                .message = staleMessage(block.description),
+            });
+        }
+    }
+    return diagnostics;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// Commands
+// ════════════════════════════════════════════════════════════════════════════
+
+ExpandResult AutosServer::expandAutos(const std::string& fileUri) {
+    ExpandResult result;
+
+    // Convert URI to file path
+    URI fileUriObj(fileUri);
+    std::filesystem::path filePath(fileUriObj.getPath());
+
+    std::cerr << "Expanding AUTOs in: " << filePath << "\n";
+
+    // Expand the editor buffer when open, so unsaved edits are included
+    std::string content;
+    if (!readDocument(fileUri, filePath, content)) {
+        std::string msg = "Failed to open file: " + filePath.string();
         std::cerr << msg << "\n";
         result.errors.push_back(msg);
         return result;
     }
 
-    // Expand with dry_run=true so we don't write to disk
-    auto expansionResult = tool.expandFile(filePath, true);
+    beginProgress("Expanding AUTOs");
 
-    // Collect diagnostics from the tool
-    const auto& diagnostics = tool.diagnostics();
-    for (const auto& diag : diagnostics.diagnostics()) {
-        std::string msg = diag.message;
-        if (!diag.file_path.empty()) {
-            msg = diag.file_path;
-            if (diag.line_number > 0) {
-                msg += ":" + std::to_string(diag.line_number);
-            }
-            msg += ": " + diag.message;
+    auto progress = [this](const slang_autos::ProgressEvent& event) {
+        return onToolProgress(event);
+    };
+    auto model = getModel(filePath, content, result.errors, progress);
+    if (!model) {
+        std::string msg = "Failed to load file for compilation. Check that all referenced modules are available.";
+        std::cerr << msg << "\n";
+        result.errors.push_back(m_cancelRequested ? "Expansion cancelled." : msg);
+        endProgress("Failed");
+        return result;
+    }
+
+    std::lock_guard<std::mutex> toolLock(model->toolMutex);
+    auto& tool = *model->tool;
+    tool.diagnostics().clear();
+    tool.setProgressCallback(progress);
+    auto expansionResult = tool.expandContent(filePath, content);
+    tool.setProgressCallback(nullptr);
+    if (expansionResult.cancelled) {
+        // Modules analyzed before the cancel are complete; hand them back
+        auto edits = toTextEdits(content, std::move(expansionResult.replacements));
+        std::string msg = "Expansion cancelled";
+        if (!edits.empty()) {
+            result.autoinst_count = expansionResult.autoinst_count;
+            result.autologic_count = expansionResult.autologic_count;
+            std::string applied;
+            auto addCount = [&applied](int count, const char* macro) {
+                if (count > 0) {
+                    applied += (applied.empty() ? "" : ", ") + std::to_string(count) + " " + macro;
+                }
+            };
+            addCount(expansionResult.autoinst_count, "AUTOINST");
+            addCount(expansionResult.autologic_count, "AUTOLOGIC");
+            addCount(expansionResult.autoports_count, "AUTOPORTS");
+            msg += "; applied " + (applied.empty() ? "the edits" : applied) +
+                   " from modules finished before the cancel";
+            result.edit.changes = std::unordered_map<std::string, std::vector<lsp::TextEdit>>{};
+            result.edit.changes->emplace(fileUri, std::move(edits));
         }
+        std::cerr << msg << "\n";
+        result.messages.push_back(msg + ".");
+        endProgress("Cancelled");
+        return result;
+    }
 
+    // Collect diagnostics from the tool
+    for (const auto& diag : tool.diagnostics().diagnostics()) {
         if (diag.level == slang_autos::DiagnosticLevel::Error) {
-            result.errors.push_back(msg);
+            result.errors.push_back(formatDiagnostic(diag));
         } else {
-            result.warnings.push_back(msg);
+            result.warnings.push_back(formatDiagnostic(diag));
         }
     }
 
@@ -148,29 +920,20 @@ ExpandResult AutosServer::expandAutos(const std::string& fileUri) {
     result.autoinst_count = expansionResult.autoinst_count;
     result.autologic_count = expansionResult.autologic_count;
 
-    if (!expansionResult.hasChanges()) {
+    auto edits = toTextEdits(content, std::move(expansionResult.replacements));
+    if (edits.empty()) {
+        endProgress("No changes needed");
         std::cerr << "No changes needed\n";
-        if (result.errors.empty() && result.warnings.empty()) {
+        if (result.errors.empty() && result.warnings.empty() &&
+            expansionResult.autoinst_count == 0 && expansionResult.autologic_count == 0) {
             result.messages.push_back("No AUTO macros found in file.");
         }
         return result;
     }
 
-    // Create a TextEdit that replaces the entire file content
-    lsp::TextEdit textEdit{
-        .range = lsp::Range{
-            .start = lsp::Position{.line = 0, .character = 0},
-            .end = lsp::Position{
-                .line = static_cast<unsigned int>(lineCount),
-                .character = 0
-            },
-        },
-        .newText = expansionResult.modified_content,
-    };
-
-    // Add to workspace edit
+    // One edit per changed block, as for deleteAutos
     result.edit.changes = std::unordered_map<std::string, std::vector<lsp::TextEdit>>{};
-    result.edit.changes->emplace(fileUri, std::vector<lsp::TextEdit>{textEdit});
+    result.edit.changes->emplace(fileUri, std::move(edits));
 
     // Add success message
     std::stringstream ss;
@@ -179,6 +942,7 @@ ExpandResult AutosServer::expandAutos(const std::string& fileUri) {
         ss << ", " << expansionResult.autologic_count << " AUTOLOGIC";
     }
     result.messages.push_back(ss.str());
+    endProgress(ss.str());
 
     std::cerr << ss.str() << "\n";
 
@@ -188,10 +952,43 @@ ExpandResult AutosServer::expandAutos(const std::string& fileUri) {
 ExpandResult AutosServer::deleteAutos(const std::string& fileUri) {
     ExpandResult result;
 
-    // TODO: Implement delete - strip AUTO-generated content
-    // For now, just return empty result with message
-    std::cerr << "deleteAutos not yet implemented for: " << fileUri << "\n";
-    result.messages.push_back("Delete AUTOs is not yet implemented.");
+    URI fileUriObj(fileUri);
+    std::filesystem::path filePath(fileUriObj.getPath());
+
+    std::cerr << "Deleting AUTOs in: " << filePath << "\n";
+
+    std::string content;
+    if (!readDocument(fileUri, filePath, content)) {
+        std::string msg = "Failed to open file: " + filePath.string();
+        std::cerr << msg << "\n";
+        result.errors.push_back(msg);
+        return result;
+    }
+
+    // Stripping only needs the syntax tree - no compilation or other files
+    auto tree = slang::syntax::SyntaxTree::fromText(content);
+    slang_autos::AutoStripper stripper;
+    stripper.analyze(tree, content);
+
+    for (const auto& diag : stripper.diagnostics().diagnostics()) {
+        result.warnings.push_back(diag.message);
+    }
+
+    const auto& replacements = stripper.getReplacements();
+    if (replacements.empty()) {
+        std::cerr << "No changes needed\n";
+        result.messages.push_back("No AUTO expansions found in file.");
+        return result;
+    }
+
+    // One edit per stripped expansion so the editor keeps cursor/folding state
+    result.edit.changes = std::unordered_map<std::string, std::vector<lsp::TextEdit>>{};
+    result.edit.changes->emplace(fileUri, toTextEdits(content, replacements));
+
+    std::string msg = "Deleted " + std::to_string(replacements.size()) + " AUTO expansion" +
+                      (replacements.size() == 1 ? "" : "s");
+    result.messages.push_back(msg);
+    std::cerr << msg << "\n";
 
     return result;
 }
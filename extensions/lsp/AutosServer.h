@@ -9,8 +9,20 @@
 #pragma once
 
 #include "lsp/LspServer.h"
+#include "slang-autos/Progress.h"
+#include "slang-autos/Tool.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace autos {
@@ -25,11 +37,24 @@ struct ExpandResult {
     int autologic_count = 0;
 };
 
+/// Client options passed in InitializeParams.initializationOptions
+struct AutosInitOptions {
+    /// Expand AUTOs in textDocument/willSaveWaitUntil
+    std::optional<bool> expandOnSave;
+    /// Latency budget for expand-on-save; saves go through unexpanded if exceeded
+    std::optional<int> expandOnSaveBudgetMs;
+    /// Publish diagnostics for out-of-date AUTO blocks
+    std::optional<bool> staleDiagnostics;
+    /// Delay after the last edit before staleness is recomputed
+    std::optional<int> staleDiagnosticsDelayMs;
+};
+
 /// LSP server that provides AUTO expansion via workspace/executeCommand.
 /// Designed to be triggered from editor keybindings, similar to verilog-mode.
 class AutosServer : public lsp::LspServer<AutosServer> {
 public:
     AutosServer();
+    ~AutosServer();
 
     /// LSP initialize handler - registers commands and returns capabilities
     lsp::InitializeResult getInitialize(const lsp::InitializeParams& params);
@@ -40,6 +65,27 @@ public:
     /// LSP shutdown handler
     std::monostate getShutdown(std::monostate);
 
+    /// workspace/executeCommand handler. Shadows the base implementation to
+    /// capture the client's workDoneToken before dispatching the command.
+    lsp::RawJson executeCommand(const lsp::ExecuteCommandParams& params);
+
+    /// window/workDoneProgress/cancel handler - cancels the running expansion.
+    /// Runs on the reader thread, while the command runs on the dispatcher.
+    void onWindowWorkDoneProgressCancel(const lsp::WorkDoneProgressCancelParams& params) override;
+
+    /// Document sync - open buffers are kept in memory (full sync)
+    void onDocDidOpen(const lsp::DidOpenTextDocumentParams& params) override;
+    void onDocDidChange(const lsp::DidChangeTextDocumentParams& params) override;
+    void onDocDidSave(const lsp::DidSaveTextDocumentParams& params) override;
+    void onDocDidClose(const lsp::DidCloseTextDocumentParams& params) override;
+
+    /// Expand-on-save: returns minimal edits if expansion fits in the budget,
+    /// nothing otherwise. Never loads a design itself; one that is not loaded
+    /// yet is queued for the background thread and the save goes through.
+    /// Only registered when enabled by the client.
+    std::optional<std::vector<lsp::TextEdit>> getDocWillSaveWaitUntil(
+        const lsp::WillSaveTextDocumentParams& params) override;
+
     /// Command: Expand all AUTOs in the given file
     /// @param fileUri URI of the file to process (e.g., "file:///path/to/file.sv")
     /// @return ExpandResult with edit, diagnostics, and statistics
@@ -51,7 +97,147 @@ public:
     ExpandResult deleteAutos(const std::string& fileUri);
 
 private:
+    /// Send a $/progress begin/report/end notification for the current command.
+    /// No-ops when the client did not supply a workDoneToken.
+    void beginProgress(const std::string& title);
+    void reportProgress(const std::string& message, unsigned int percentage);
+    void endProgress(const std::string& message);
+    void sendProgress(lsp::LSPAny value);
+
+    /// Map a tool progress event to a $/progress report.
+    /// Returns false if the client has cancelled the request.
+    bool onToolProgress(const slang_autos::ProgressEvent& event);
+
+    /// An AUTO block whose expansion differs from the source in more than
+    /// whitespace. Offsets are relative to the start of its module.
+    struct StaleBlock {
+        size_t start = 0;
+        size_t end = 0;
+        std::string description;
+    };
+
+    /// Staleness of one module, valid while its text hash is unchanged
+    struct ModuleStaleness {
+        size_t hash = 0;
+        std::vector<StaleBlock> blocks;
+    };
+
+    /// Elaborated design for one file, reused across expansions.
+    /// Submodule ports only change when a file is saved, so the compilation
+    /// and its port cache stay valid while the buffer is edited, and a save
+    /// only invalidates the designs that read the saved file.
+    ///
+    /// `toolMutex` guards the tool and the staleness cache. It may be taken
+    /// while holding the server mutex, never the other way round, so the
+    /// background thread can load and analyze without blocking the dispatcher.
+    struct DesignModel {
+        std::mutex toolMutex;
+        std::unique_ptr<slang_autos::AutosTool> tool;
+
+        /// Per-module staleness (module name -> result). Cleared when the
+        /// tool is rebuilt, so results never outlive the port cache they
+        /// were built on.
+        std::unordered_map<std::string, ModuleStaleness> staleness;
+        size_t outsideHash = 0;  ///< Hash of text outside modules (templates, config)
+
+        // The remaining fields are guarded by the server mutex
+
+        /// Duration of the last expand-on-save; halved on each save skipped for it
+        std::chrono::milliseconds lastExpandTime{0};
+        /// Every file the compilation read (sources, libraries, includes), as pathKey()
+        std::unordered_set<std::string> files;
+        /// Saved files the compilation has not been rebuilt for yet
+        std::vector<std::filesystem::path> changedFiles;
+        /// Bumped when a file of the design is saved, so results computed
+        /// from the previous compilation are not published
+        uint64_t generation = 0;
+    };
+
+    /// Get the design model for a file, loading or rebuilding it as needed.
+    /// Runs under the server mutex; the caller locks `toolMutex` to use it.
+    /// `progress` is installed on the tool for the duration of the load.
+    /// Returns nullptr (and fills `errors`) if loading fails.
+    std::shared_ptr<DesignModel> getModel(const std::filesystem::path& filePath,
+                                          const std::string& content,
+                                          std::vector<std::string>& errors,
+                                          slang_autos::ProgressCallback progress = nullptr);
+
+    /// As getModel() for an open document, but elaborates without the server
+    /// mutex so requests and edits are handled in the meantime. `lock` holds
+    /// the server mutex on entry and on return.
+    std::shared_ptr<DesignModel> loadModel(const std::string& uri,
+                                           std::unique_lock<std::mutex>& lock);
+
+    /// Configure and elaborate a tool for a file. Touches no server state,
+    /// so it may run without the server mutex.
+    std::unique_ptr<slang_autos::AutosTool> loadTool(
+        const std::filesystem::path& filePath, const std::string& content,
+        std::vector<std::string>& errors, slang_autos::ProgressCallback progress = nullptr);
+
+    /// Queue a staleness check for a document after the debounce delay
+    void scheduleStaleness(const std::string& uri);
+
+    /// Recompute and publish staleness diagnostics for an open document.
+    /// Only modules whose text changed since the last run are re-analyzed.
+    /// `lock` holds the server mutex; it is released while the model loads
+    /// and while the document is analyzed, and the result is dropped if the
+    /// text or the design changed in the meantime.
+    void publishStaleness(const std::string& uri, std::unique_lock<std::mutex>& lock);
+
+    /// Staleness diagnostics for `text`, reusing the model's per-module
+    /// cache. Caller holds the model's toolMutex, not the server mutex.
+    /// Returns nullopt if the expansion failed.
+    static std::optional<std::vector<lsp::Diagnostic>> analyzeStaleness(
+        DesignModel& model, const std::filesystem::path& filePath, const std::string& text);
+
+    /// Queue a model load or rebuild for an open document on the background
+    /// thread, so expand-on-save finds it warm
+    void scheduleLoad(const std::string& uri);
+
+    /// Worker thread: runs queued model loads, then due staleness checks
+    void backgroundLoop();
+
+    /// Current text of a document: the open buffer if any, else the file on disk
+    bool readDocument(const std::string& uri, const std::filesystem::path& filePath,
+                      std::string& content) const;
+
     std::optional<lsp::WorkspaceFolder> m_workspaceFolder;
+
+    /// Open documents: URI -> current text
+    std::unordered_map<std::string, std::string> m_documents;
+
+    /// Design models: file path -> model. Shared so that a model can be
+    /// analyzed without the server mutex while the document is closed.
+    std::unordered_map<std::string, std::shared_ptr<DesignModel>> m_models;
+
+    /// Bumped on every save, so a model loaded without the server mutex can
+    /// tell whether a file it read may have changed during the load
+    uint64_t m_saveCount = 0;
+
+    /// Expand-on-save settings (from initializationOptions)
+    bool m_expandOnSave = false;
+    std::chrono::milliseconds m_saveBudget{500};
+
+    /// Staleness diagnostics settings, and the background thread's queues.
+    /// Guarded by the server mutex, like all handler state.
+    bool m_staleDiagnostics = false;
+    std::chrono::milliseconds m_stalenessDelay{300};
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> m_pendingStaleness;
+    std::unordered_set<std::string> m_pendingLoads;
+    std::condition_variable m_backgroundCv;
+    bool m_stopping = false;
+    std::thread m_backgroundThread;
+
+    /// Token for the executeCommand currently being processed (if any)
+    std::optional<lsp::ProgressToken> m_workDoneToken;
+
+    /// JSON form of m_workDoneToken, for matching cancellations. Guarded by
+    /// m_cancelMutex, since the cancel handler runs on the reader thread.
+    std::optional<std::string> m_runningToken;
+    std::mutex m_cancelMutex;
+
+    /// Set by window/workDoneProgress/cancel for the running command only
+    std::atomic<bool> m_cancelRequested{false};
 };
 
 } // namespace autos
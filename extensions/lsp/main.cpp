@@ -29,6 +29,11 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    // The transport only uses iostreams; unsynced streams read large
+    // messages in bulk instead of a character at a time through stdio.
+    std::ios_base::sync_with_stdio(false);
+    std::cin.tie(nullptr);
+
     autos::AutosServer server;
     server.run();
 
@@ -257,6 +257,7 @@ async function startLanguageClient(context: vscode.ExtensionContext) {
             debug: { command: serverPath },
         };
 
+        const settings = vscode.workspace.getConfiguration('slang-autos');
         const clientOptions: LanguageClientOptions = {
             documentSelector: [
                 { scheme: 'file', language: 'verilog' },
@@ -264,6 +265,12 @@ async function startLanguageClient(context: vscode.ExtensionContext) {
             ],
             outputChannel: outputChannel,
             traceOutputChannel: outputChannel,
+            initializationOptions: {
+                expandOnSave: settings.get<boolean>('expandOnSave', false),
+                expandOnSaveBudgetMs: settings.get<number>('expandOnSaveBudgetMs', 500),
+                staleDiagnostics: settings.get<boolean>('staleDiagnostics', true),
+                staleDiagnosticsDelayMs: settings.get<number>('staleDiagnosticsDelayMs', 300),
+            },
         };
 
         client = new LanguageClient(
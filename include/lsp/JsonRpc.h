@@ -9,10 +9,13 @@
 #pragma once
 
 #include "rfl/Generic.hpp"
+#include <charconv>
 #include <iostream>
+#include <mutex>
 #include <optional>
 #include <rfl/json.hpp> // IWYU pragma: keep
 #include <string>
+#include <string_view>
 
 namespace lsp {
 
@@ -51,11 +54,58 @@ struct RpcErrorResponse {
     RpcError error;
 };
 
+/// Request/notification with statically typed params. Deserializing into this
+/// directly avoids the rfl::Generic tree that RpcRequest builds for params.
+template<typename P>
+struct TypedRpcRequest {
+    std::string jsonrpc;
+    ID_t id;
+    std::string method;
+    std::optional<P> params;
+};
+
+/// Just the id of a message, for replying to requests whose params do not parse
+struct RpcEnvelope {
+    ID_t id;
+};
+
+/// A result that has already been serialized to JSON. Typed handlers returning
+/// this have the text spliced into the response as-is.
+struct RawJson {
+    std::string json = "null";
+};
+
+/// Serializes writes to stdout. Messages are sent from the dispatcher, the
+/// reader thread and server worker threads, and frames must not interleave.
+inline std::mutex& outputMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+inline void writeFrame(std::string_view body) {
+    std::lock_guard<std::mutex> lock(outputMutex());
+    std::cout << "Content-Length: " << body.length() << "\r\n\r\n";
+    std::cout.write(body.data(), static_cast<std::streamsize>(body.length()));
+    std::cout.flush();
+}
+
 template<typename T>
 void sendMessage(const T& message) {
-    auto message_str = rfl::json::write<rfl::UnderlyingEnums>(message);
-    std::cout << "Content-Length: " << message_str.length() << "\r\n\r\n";
-    std::cout << message_str;
+    writeFrame(rfl::json::write<rfl::UnderlyingEnums>(message));
+}
+
+/// Send a response whose result is already serialized, without copying it
+/// into an enclosing message string.
+inline void sendRawResult(const ID_t& id, std::string_view resultJson) {
+    std::string prefix = R"({"jsonrpc":"2.0","id":)";
+    prefix += rfl::json::write(id);
+    prefix += R"(,"result":)";
+
+    std::lock_guard<std::mutex> lock(outputMutex());
+    std::cout << "Content-Length: " << prefix.length() + resultJson.length() + 1 << "\r\n\r\n";
+    std::cout.write(prefix.data(), static_cast<std::streamsize>(prefix.length()));
+    std::cout.write(resultJson.data(), static_cast<std::streamsize>(resultJson.length()));
+    std::cout.put('}');
     std::cout.flush();
 }
 
@@ -82,50 +132,168 @@ inline void sendRequest(const std::string& method, const rfl::Generic& params) {
     std::cerr << std::endl;
 }
 
-template<typename T>
-T readJson(std::string& line, std::string& content) {
-    while (std::getline(std::cin, line)) {
-        if (line.find("Content-Length: ") != 0) {
-            std::cerr << "<-/- " << "Invalid Line: " << line << std::endl;
+/// Read one Content-Length framed message from `in` into `content`.
+/// `header` and `content` are caller-owned so their capacity is reused across
+/// messages; a large didChange does not cause a fresh allocation every time.
+/// Returns false when the stream is closed.
+inline bool readMessage(std::istream& in, std::string& header, std::string& content) {
+    constexpr std::string_view lengthKey = "Content-Length:";
+    std::optional<size_t> contentLength;
+
+    while (std::getline(in, header)) {
+        if (!header.empty() && header.back() == '\r') {
+            header.pop_back();
+        }
+        if (header.empty()) {
+            // Blank line terminates the header block
+            if (contentLength) {
+                break;
+            }
             continue;
         }
+        if (header.compare(0, lengthKey.size(), lengthKey) == 0) {
+            auto first = header.data() + lengthKey.size();
+            auto last = header.data() + header.size();
+            while (first != last && *first == ' ') {
+                ++first;
+            }
+            size_t length = 0;
+            if (std::from_chars(first, last, length).ec == std::errc{}) {
+                contentLength = length;
+                continue;
+            }
+        }
+        else if (header.starts_with("Content-Type:")) {
+            continue;
+        }
+        std::cerr << "<-/- " << "Invalid Line: " << header << std::endl;
+    }
 
-        int contentLength = std::stoi(line.substr(16));
-        content.resize(contentLength);
+    if (!in || !contentLength) {
+        return false;
+    }
 
-        do {
-            // Read maybe charset and empty line. Neovim and Vscode both don't
-            // have this header row.
-            std::getline(std::cin, line);
-        } while (line.size() > 1);
+    content.resize(*contentLength);
+    in.read(content.data(), static_cast<std::streamsize>(*contentLength));
+    return static_cast<size_t>(in.gcount()) == *contentLength;
+}
 
-        std::cin.read(&content[0], contentLength);
-        std::cerr << "RAW JSON received (" << contentLength << " bytes): " << content << "\n";
+/// Find the top-level "method" member of a JSON-RPC message without parsing
+/// the rest of it, so the message can be routed to a typed handler.
+/// Returns an empty view if there is no method or it contains escapes.
+inline std::string_view peekMethod(std::string_view json) {
+    size_t i = 0;
+    int depth = 0;
+    bool expectKey = false;
 
-        rfl::Result<T> request = rfl::json::read<T>(content);
-        if (!request) {
-            auto response = rfl::json::read<RpcResponse>(content);
-            if (response) {
-                continue;
+    auto readString = [&](std::string_view& out) {
+        // json[i] is the opening quote
+        size_t start = ++i;
+        bool escaped = false;
+        while (i < json.size() && json[i] != '"') {
+            if (json[i] == '\\') {
+                escaped = true;
+                ++i;
+            }
+            ++i;
+        }
+        if (i >= json.size()) {
+            return false;
+        }
+        out = json.substr(start, i - start);
+        ++i;
+        return !escaped;
+    };
+    auto skipSpace = [&]() {
+        while (i < json.size() && (json[i] == ' ' || json[i] == '\t' || json[i] == '\n' ||
+                                   json[i] == '\r')) {
+            ++i;
+        }
+    };
+
+    while (i < json.size()) {
+        char c = json[i];
+        if (c == '"') {
+            std::string_view str;
+            bool plain = readString(str);
+            if (depth == 1 && expectKey) {
+                expectKey = false;
+                if (plain && str == "method") {
+                    skipSpace();
+                    if (i >= json.size() || json[i] != ':') {
+                        return {};
+                    }
+                    ++i;
+                    skipSpace();
+                    if (i >= json.size() || json[i] != '"') {
+                        return {};
+                    }
+                    std::string_view method;
+                    return readString(method) ? method : std::string_view{};
+                }
             }
-            std::cerr << "Error parsing JSON: " << content << std::endl;
-            std::cerr << "Rfl Error: " << request.error()->what() << std::endl;
-            sendMessage(
-                RpcErrorResponse{.jsonrpc = "2.0",
-                                 .id = 0,
-                                 .error = RpcError{
-                                     .code = 1,
-                                     .message = "Error parsing JSON: " + request.error()->what() +
-                                                " for content: " + content,
-                                 }});
             continue;
         }
+        switch (c) {
+            case '{':
+            case '[':
+                ++depth;
+                expectKey = (c == '{' && depth == 1);
+                break;
+            case '}':
+            case ']':
+                --depth;
+                break;
+            case ',':
+                expectKey = (depth == 1);
+                break;
+            default:
+                break;
+        }
+        ++i;
+    }
+    return {};
+}
 
-        return std::move(request.value());
+/// Parse a framed message body. Responses from the client are dropped; other
+/// parse failures are reported back to the client. Returns nullopt in both cases.
+template<typename T>
+std::optional<T> parseJson(const std::string& content) {
+    rfl::Result<T> request = rfl::json::read<T>(content);
+    if (!request) {
+        auto response = rfl::json::read<RpcResponse>(content);
+        if (response) {
+            return std::nullopt;
+        }
+        std::cerr << "Error parsing JSON (" << content.size() << " bytes)" << std::endl;
+        std::cerr << "Rfl Error: " << request.error()->what() << std::endl;
+        sendMessage(RpcErrorResponse{.jsonrpc = "2.0",
+                                     .id = 0,
+                                     .error = RpcError{
+                                         .code = 1,
+                                         .message = "Error parsing JSON: " +
+                                                    request.error()->what(),
+                                     }});
+        return std::nullopt;
     }
-    // stdin closed - exit gracefully
+    return std::move(request.value());
+}
+
+[[noreturn]] inline void exitOnClosedInput() {
     std::cerr << "stdin closed, exiting\n";
     std::exit(0);
 }
 
+/// Block until the next message is received and parsed.
+/// Exits the process when stdin is closed.
+template<typename T>
+T readJson(std::string& line, std::string& content) {
+    while (readMessage(std::cin, line, content)) {
+        if (auto request = parseJson<T>(content)) {
+            return std::move(*request);
+        }
+    }
+    exitOnClosedInput();
+}
+
 } // namespace lsp
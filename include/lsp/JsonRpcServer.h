@@ -12,6 +12,8 @@
 #include "lsp/LspTypes.h"
 #include "rfl/Generic.hpp"
 #include <concepts>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <iostream>
 #include <mutex>
@@ -19,6 +21,7 @@
 #include <rfl/json/write.hpp>
 #include <rfl/visit.hpp>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <variant>
 
@@ -33,6 +36,94 @@ protected:
     /// method name -> notification handler
     std::unordered_map<std::string, std::function<void(rfl::Generic)>> notifications;
 
+    /// method name -> handler that deserializes the raw message body itself.
+    /// Used for hot methods with large payloads to skip the rfl::Generic tree.
+    std::unordered_map<std::string, std::function<void(const std::string&)>> typedHandlers;
+
+    /// method name -> notification handler run on the reader thread as soon as
+    /// the message arrives, without taking the server mutex. For notifications
+    /// that must reach a request still running, such as cancellation.
+    std::unordered_map<std::string, std::function<void(const std::string&)>> immediateHandlers;
+
+    /// Register an rpc method that is parsed straight from the message body into
+    /// P and whose result R is written straight into the response. If R is
+    /// RawJson the pre-serialized text is spliced in without re-encoding.
+    template<typename P, typename R, auto Method>
+    void registerTypedMethod(const std::string& name) {
+        typedHandlers[name] = [this, name](const std::string& content) {
+            auto request = rfl::json::read<TypedRpcRequest<P>, rfl::UnderlyingEnums>(content);
+            if (!request || !request.value().params) {
+                // Answer with the request's own id when the body is valid JSON
+                // and only the params are wrong; null id if it is not JSON at all
+                auto envelope = rfl::json::read<RpcEnvelope>(content);
+                std::string message = request ? "Missing params" : request.error()->what();
+                std::cerr << "-/-> " << name << " Error: " << message << '\n';
+                sendMessage(RpcErrorResponse{
+                    .jsonrpc = "2.0",
+                    .id = envelope ? envelope.value().id : ID_t{},
+                    .error = RpcError{
+                        .code = static_cast<int>(envelope ? ErrorCodes::InvalidParams
+                                                          : ErrorCodes::ParseError),
+                        .message = message,
+                    }});
+                return;
+            }
+            auto& req = request.value();
+            std::cerr << "<--- " << name << '\n';
+            try {
+                R result = (static_cast<Impl*>(this)->*Method)(*req.params);
+                if constexpr (std::is_same_v<R, RawJson>) {
+                    sendRawResult(req.id, result.json);
+                }
+                else {
+                    sendRawResult(req.id, rfl::json::write<rfl::UnderlyingEnums>(result));
+                }
+                std::cerr << "---> " << name << '\n';
+            }
+            catch (const std::exception& e) {
+                std::cerr << "-/-> " << name << " Error: " << e.what() << "\n\n";
+                sendMessage(RpcErrorResponse{.jsonrpc = "2.0",
+                                             .id = req.id,
+                                             .error = RpcError{.code = 1, .message = e.what()}});
+            }
+        };
+        std::cerr << "Registered typed method: " << name << "\n";
+    }
+
+    /// Register an rpc notification that is parsed straight from the message body into P
+    template<typename P, auto Method>
+    void registerTypedNotification(const std::string& name) {
+        typedHandlers[name] = typedNotificationHandler<P, Method>(name);
+        std::cerr << "Registered typed notification: " << name << "\n";
+    }
+
+    /// Register a notification handled on the reader thread (see immediateHandlers).
+    /// Method runs concurrently with other handlers and must synchronize itself.
+    template<typename P, auto Method>
+    void registerImmediateNotification(const std::string& name) {
+        immediateHandlers[name] = typedNotificationHandler<P, Method>(name);
+        std::cerr << "Registered immediate notification: " << name << "\n";
+    }
+
+    template<typename P, auto Method>
+    std::function<void(const std::string&)> typedNotificationHandler(const std::string& name) {
+        return [this, name](const std::string& content) {
+            auto notification = rfl::json::read<TypedRpcRequest<P>, rfl::UnderlyingEnums>(
+                content);
+            if (!notification || !notification.value().params) {
+                std::cerr << "-/-> " << name << " Error: invalid params\n";
+                return;
+            }
+            std::cerr << "<--- " << name << std::endl;
+            try {
+                (static_cast<Impl*>(this)->*Method)(*notification.value().params);
+            }
+            catch (const std::exception& e) {
+                std::cerr << "-/-> " << name << " Error: " << e.what() << '\n';
+            }
+        };
+    }
+
     /// Register an rpc method with the given Params, Return, and Method (name)
     template<typename P, typename R, auto Method>
     void registerMethod(const std::string& name) {
@@ -190,6 +281,52 @@ protected:
     std::string content;
     std::mutex mutex;
 
+    /// Messages read by the reader thread, in arrival order; nullopt marks closed input
+    std::deque<std::optional<std::string>> inbox;
+    std::mutex inboxMutex;
+    std::condition_variable inboxCv;
+
+    /// Read stdin on a separate thread so that immediate notifications are
+    /// handled while the dispatcher is busy with a long request. Everything
+    /// else is queued for nextMessage().
+    void startReader() {
+        std::thread([this] {
+            std::string header;
+            std::string body;
+            while (readMessage(std::cin, header, body)) {
+                if (auto it = immediateHandlers.find(std::string(peekMethod(body)));
+                    it != immediateHandlers.end()) {
+                    it->second(body);
+                    continue;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(inboxMutex);
+                    inbox.push_back(std::move(body));
+                }
+                inboxCv.notify_one();
+                body = std::string();
+            }
+            {
+                std::lock_guard<std::mutex> lock(inboxMutex);
+                inbox.push_back(std::nullopt);
+            }
+            inboxCv.notify_one();
+        }).detach();
+    }
+
+    /// Block until the reader thread delivers the next message.
+    /// Exits the process when stdin is closed.
+    std::string nextMessage() {
+        std::unique_lock<std::mutex> lock(inboxMutex);
+        inboxCv.wait(lock, [this] { return !inbox.empty(); });
+        auto message = std::move(inbox.front());
+        inbox.pop_front();
+        if (!message) {
+            exitOnClosedInput();
+        }
+        return std::move(*message);
+    }
+
 public:
     void run() {
         // Handle initialize first
@@ -209,14 +346,33 @@ public:
             break;
         }
 
-        // Run until shutdown
+        // Run until shutdown. Messages with a typed handler are routed on the
+        // method name alone and never materialize an RpcRequest.
+        startReader();
+        std::string method;
         do {
-            req = readJson<RpcRequest>(line, content);
+            content = nextMessage();
+            method = peekMethod(content);
+            if (auto it = typedHandlers.find(method); it != typedHandlers.end()) {
+                std::lock_guard<std::mutex> lock(mutex);
+                it->second(content);
+                continue;
+            }
+            auto parsed = parseJson<RpcRequest>(content);
+            if (!parsed) {
+                continue;
+            }
+            req = std::move(*parsed);
             handleMessage(req);
         } while (req.method.compare("shutdown") != 0);
 
         while (true) {
-            req = readJson<RpcRequest>(line, content);
+            content = nextMessage();
+            auto parsed = parseJson<RpcRequest>(content);
+            if (!parsed) {
+                continue;
+            }
+            req = std::move(*parsed);
             if (req.method.compare("exit") == 0) {
                 break;
             }
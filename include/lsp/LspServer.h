@@ -23,7 +23,8 @@ namespace lsp {
 template<typename Impl>
 class LspServer : public JsonRpcServer<Impl> {
 protected:
-    std::unordered_map<std::string, std::function<rfl::Generic(rfl::Generic)>> m_commands;
+    /// command name -> handler returning the JSON-serialized result
+    std::unordered_map<std::string, std::function<std::string(rfl::Generic)>> m_commands;
 
     // LspClient& m_lspClient;
 
@@ -32,7 +33,7 @@ protected:
     /// Register an rpc method with the given Params, Return, and Method (name)
     template<typename P, typename R, auto Method>
     void registerCommand(const std::string& name) {
-        m_commands[name] = [this](std::optional<rfl::Generic> paramsJson) -> rfl::Generic {
+        m_commands[name] = [this](std::optional<rfl::Generic> paramsJson) -> std::string {
             // Deserialize params
             R result;
             if constexpr (!std::is_same_v<P, std::nullopt_t>) {
@@ -48,38 +49,32 @@ protected:
             }
 
             if constexpr (std::is_same_v<R, std::monostate>) {
-                return std::nullopt;
+                return "null";
             }
             else {
-                return rfl::to_generic(result);
+                // Serialize directly; results such as whole-file edits can be
+                // megabytes and are not worth routing through rfl::Generic
+                return rfl::json::write<rfl::UnderlyingEnums>(result);
             }
         };
         std::cerr << "Registered command: " << name << "\n";
     }
 
-    /// A request send from the client to the server to execute a command. The request might return
-    /// a workspace edit which the client will apply to the workspace.
-    std::optional<lsp::LSPAny> getWorkspaceExecuteCommand(const lsp::ExecuteCommandParams& params) {
+    /// Execute a registered command and return its JSON-serialized result.
+    /// This is the handler behind workspace/executeCommand.
+    RawJson executeCommand(const lsp::ExecuteCommandParams& params) {
         std::cerr << " <---" << params.command << "\n";
-        std::cerr << "   arguments present: " << params.arguments.has_value() << "\n";
-        if (params.arguments.has_value()) {
-            std::cerr << "   arguments size: " << params.arguments->size() << "\n";
-            for (size_t i = 0; i < params.arguments->size(); ++i) {
-                std::cerr << "   arg[" << i << "]: " << rfl::json::write(params.arguments->at(i)) << "\n";
-            }
-        }
-        std::cerr << "   full params json: " << rfl::json::write(params) << "\n";
         auto command = m_commands.find(params.command);
         if (command == m_commands.end()) {
             std::cerr << "Unknown command: " << params.command << "\n";
             std::cerr << " -/-> \n";
-            return std::nullopt;
+            return RawJson{};
         }
         // returns are rearely used
         // convert args to correct typer
         rfl::Generic args = std::nullopt;
         if (params.arguments) {
-            auto argList = params.arguments.value();
+            const auto& argList = params.arguments.value();
             if (argList.size() == 1) {
                 args = argList[0];
             }
@@ -90,12 +85,21 @@ protected:
                 throw std::runtime_error("Expected 0 or 1 argument for command");
             }
         }
-        auto x = command->second(args);
+        RawJson result{command->second(args)};
 
-        std::cerr << " ---> " << params.command << "\n";
+        std::cerr << " ---> " << params.command << " (" << result.json.size() << " bytes)\n";
+        return result;
+    }
 
-        // INFO("Command {} returned: {}", params.command, rfl::json::write(x));
-        return x;
+    /// A request send from the client to the server to execute a command. The request might return
+    /// a workspace edit which the client will apply to the workspace.
+    std::optional<lsp::LSPAny> getWorkspaceExecuteCommand(const lsp::ExecuteCommandParams& params) {
+        auto json = static_cast<Impl*>(this)->executeCommand(params).json;
+        auto result = rfl::json::read<rfl::Generic>(json);
+        if (!result) {
+            return std::nullopt;
+        }
+        return result.value();
     }
 
     std::vector<std::string> getCommandList() const {
@@ -200,8 +204,7 @@ protected:
     };
 
     void registerWorkspaceExecuteCommand() {
-        this->template registerMethod<ExecuteCommandParams, std::optional<LSPAny>,
-                                      &Impl::getWorkspaceExecuteCommand>(
+        this->template registerTypedMethod<ExecuteCommandParams, RawJson, &Impl::executeCommand>(
             "workspace/executeCommand");
     };
     /// The did rename files notification is sent from the client to the server when
@@ -278,8 +281,9 @@ protected:
     virtual void onWindowWorkDoneProgressCancel(const WorkDoneProgressCancelParams&) {}
 
     void registerWindowWorkDoneProgressCancel() {
-        this->template registerNotification<WorkDoneProgressCancelParams,
-                                            &Impl::onWindowWorkDoneProgressCancel>(
+        // Handled on the reader thread so it can interrupt a running command
+        this->template registerImmediateNotification<WorkDoneProgressCancelParams,
+                                                     &Impl::onWindowWorkDoneProgressCancel>(
             "window/workDoneProgress/cancel");
     };
     /// A request to resolve the supertypes for a given `TypeHierarchyItem`.
@@ -709,8 +713,8 @@ protected:
     virtual void onDocDidChange(const DidChangeTextDocumentParams&) {}
 
     void registerDocDidChange() {
-        this->template registerNotification<DidChangeTextDocumentParams, &Impl::onDocDidChange>(
-            "textDocument/didChange");
+        this->template registerTypedNotification<DidChangeTextDocumentParams,
+                                                 &Impl::onDocDidChange>("textDocument/didChange");
     };
     /// The document diagnostic request definition.
     ///
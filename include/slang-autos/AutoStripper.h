@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Diagnostics.h"
+#include "Writer.h"
+
+// Forward declarations for slang types
+namespace slang::syntax {
+class SyntaxTree;
+}
+
+namespace slang_autos {
+
+/// Removes AUTO-generated text from a source file, leaving the markers in place.
+///
+/// - AUTOINST / AUTOPORTS: everything between the marker and the closing `)`
+///   of the enclosing port list.
+/// - AUTOLOGIC: the "// Beginning of automatic logic" ... "// End of automatics"
+///   block. When the block directly follows the AUTOLOGIC marker, the whitespace
+///   in between is removed as well so that stripping an expansion restores the
+///   original text.
+///
+/// Positions come from a single linear walk over the syntax tree's tokens and
+/// their trivia; no compilation is needed. Tokens from macro expansions and
+/// included files are ignored.
+class AutoStripper {
+public:
+    /// Walk a syntax tree and collect replacements that strip all expansions.
+    void analyze(const std::shared_ptr<slang::syntax::SyntaxTree>& tree,
+                 std::string_view source_content);
+
+    /// Get collected replacements (mutable for SourceWriter::applyReplacements).
+    /// Replacements are in source order and never overlap.
+    [[nodiscard]] std::vector<Replacement>& getReplacements() { return replacements_; }
+
+    /// Number of expansions stripped
+    [[nodiscard]] int strippedCount() const { return static_cast<int>(replacements_.size()); }
+
+    /// Get diagnostics
+    [[nodiscard]] DiagnosticCollector& diagnostics() { return diagnostics_; }
+
+private:
+    std::vector<Replacement> replacements_;
+    DiagnosticCollector diagnostics_;
+};
+
+/// Parse `source` and return it with all AUTO expansions stripped.
+[[nodiscard]] std::string stripAutos(const std::string& source);
+
+} // namespace slang_autos
@@ -1,7 +1,10 @@
 #pragma once
 
-#include <set>
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
 
@@ -9,9 +12,12 @@
 #include <slang/syntax/AllSyntax.h>
 #include <slang/parsing/Token.h>
 
+#include "CompilationUtils.h"
 #include "Diagnostics.h"
 #include "SignalAggregator.h"
 #include "Parser.h"
+#include "Progress.h"
+#include "Stats.h"
 #include "TemplateMatcher.h"
 #include "Writer.h"
 
@@ -33,6 +39,11 @@ struct AutosAnalyzerOptions {
     std::optional<DirectionComments> direction_comments; ///< Per-port direction arrows (nullopt = disabled)
     NetType net_type = NetType::Logic; ///< Net type for generated declarations
     DiagnosticCollector* diagnostics = nullptr;
+    ProgressCallback progress; ///< Called before each module is analyzed (optional)
+    ModuleFilter module_filter; ///< Skip modules for which this returns false (optional)
+    PortCache* port_cache = nullptr; ///< Shared submodule port cache (optional, must match compilation)
+    unsigned jobs = 1; ///< Modules analyzed concurrently (0 = one per hardware thread)
+    bool stop_at_first_change = false; ///< Stop once a module's output differs beyond whitespace (--check)
 };
 
 /// Analyzes SystemVerilog modules and generates text replacements for AUTO macros.
@@ -52,6 +63,16 @@ struct AutosAnalyzerOptions {
 /// auto& replacements = analyzer.getReplacements();
 /// std::string output = writer.applyReplacements(original_source, replacements);
 /// ```
+///
+/// With `jobs` > 1, modules in the tree are analyzed on worker threads. Each
+/// worker owns its own aggregator and arena; port lookups (which touch the
+/// shared Compilation) are serialized. Replacements and diagnostics are merged
+/// in module order, so the result is identical to a sequential run.
+///
+/// Per-module collection state (name sets, extracted identifiers) lives in a
+/// monotonic arena that is reset between modules. Names are string_views into
+/// the syntax tree where possible, so collecting a module costs a handful of
+/// bump allocations rather than one heap node per name.
 class AutosAnalyzer {
 public:
     AutosAnalyzer(slang::ast::Compilation& compilation,
@@ -74,18 +95,97 @@ public:
     [[nodiscard]] int autologicCount() const { return autologic_count_; }
     [[nodiscard]] int autoportsCount() const { return autoports_count_; }
 
+    /// True if the progress callback requested cancellation during analyze().
+    /// Replacements collected before the cancellation point are kept.
+    [[nodiscard]] bool cancelled() const { return cancelled_; }
+
+    /// True if `stop_at_first_change` ended analyze() before the last module.
+    /// Replacements and counts then cover only the modules analyzed.
+    [[nodiscard]] bool stoppedEarly() const { return stopped_early_; }
+
+    /// Allocation counters for the per-module arena, accumulated over analyze().
+    [[nodiscard]] ArenaStats arenaStats() const;
+
+    /// Template matching counters, accumulated over analyze().
+    [[nodiscard]] const MatcherStats& matcherStats() const { return matcher_stats_; }
+
+    /// Module types instantiated (by AUTOINST or manually) in modules that
+    /// have AUTOs, sorted and unique. A port change in any of them can change
+    /// this file's expansion; --watch uses this as its reverse dependency map.
+    [[nodiscard]] std::vector<std::string> submoduleTypes() const;
+
 private:
+    // ════════════════════════════════════════════════════════════════════════
+    // Arena support
+    // ════════════════════════════════════════════════════════════════════════
+
+    /// memory_resource adapter that counts the allocations passing through it
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        explicit CountingResource(std::pmr::memory_resource* upstream)
+            : upstream_(upstream) {}
+
+        size_t allocations = 0;
+        size_t bytes = 0;
+
+    private:
+        void* do_allocate(size_t size, size_t alignment) override;
+        void do_deallocate(void* p, size_t size, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+        std::pmr::memory_resource* upstream_;
+    };
+
+    /// Flat set of names allocated from the module arena.
+    /// Names are appended during collection and sorted/deduplicated by seal();
+    /// iteration after seal() is in sorted order.
+    class NameSet {
+    public:
+        explicit NameSet(std::pmr::memory_resource* mr) : names_(mr) {}
+
+        void insert(std::string_view name) {
+            names_.push_back(name);
+            sealed_ = false;
+        }
+        void seal();
+
+        [[nodiscard]] bool contains(std::string_view name) const;
+        [[nodiscard]] bool empty() const { return names_.empty(); }
+        [[nodiscard]] auto begin() const { return names_.begin(); }
+        [[nodiscard]] auto end() const { return names_.end(); }
+
+    private:
+        std::pmr::vector<std::string_view> names_;
+        bool sealed_ = true;
+    };
+
     // ════════════════════════════════════════════════════════════════════════
     // Collection structures - positions from AST
     // ════════════════════════════════════════════════════════════════════════
 
+    /// State shared by every instance of one HierarchyInstantiationSyntax
+    /// (`sub u_a (...), u_b (...);`). The submodule's ports are looked up and
+    /// the template matcher built once; only per-instance captures differ.
+    struct InstGroup {
+        InstGroup(std::string type, const AutoTemplate* t)
+            : module_type(std::move(type)), templ(t), matcher(t, nullptr) {}
+
+        std::string module_type;
+        const AutoTemplate* templ = nullptr;
+        const ModulePorts* submodule = nullptr;  ///< Set by resolvePortsAndSignals
+        TemplateMatcher matcher;
+    };
+
     /// Information about an AUTOINST marker and its source location
     struct AutoInstInfo {
+        explicit AutoInstInfo(std::pmr::memory_resource* mr) : manual_ports(mr) {}
+
         const slang::syntax::MemberSyntax* node = nullptr;
-        std::string module_type;
+        size_t group = 0;  ///< Index into CollectedInfo::inst_groups
         std::string instance_name;
-        std::set<std::string> manual_ports;
-        const AutoTemplate* templ = nullptr;
+        NameSet manual_ports;
 
         // Positions from AST - replace from marker_end to close_paren_pos
         size_t marker_end = 0;
@@ -102,59 +202,78 @@ private:
 
     /// Information about AUTOPORTS marker and port list bounds
     struct AutoPortsInfo {
+        explicit AutoPortsInfo(std::pmr::memory_resource* mr) : existing_ports(mr) {}
+
         size_t marker_end = 0;
         size_t close_paren_pos = 0;
-        std::set<std::string> existing_ports;
+        NameSet existing_ports;
     };
 
     /// Port connection info collected during AST traversal
     struct CollectedPortConnection {
         std::string port_name;
         std::string signal_expr;  ///< For output generation
-        std::vector<std::string> signal_identifiers;  ///< Pre-extracted from AST
+        ExpressionInfo expr;      ///< Pre-analyzed from AST
     };
 
     /// Information about a manual (non-AUTOINST) instance for signal tracking
     struct ManualInstInfo {
         const slang::syntax::HierarchyInstantiationSyntax* node = nullptr;
-        std::string module_type;
+        size_t group = 0;  ///< Index into CollectedInfo::inst_groups
         std::string instance_name;
         std::vector<CollectedPortConnection> port_connections;
     };
 
     /// All information collected from a single module
     struct CollectedInfo {
+        explicit CollectedInfo(std::pmr::memory_resource* mr)
+            : autoports(mr), existing_decls(mr), assign_driven(mr), assign_consumed(mr) {}
+
+        std::vector<InstGroup> inst_groups;  ///< One per instantiation statement
         std::vector<AutoInstInfo> autoinsts;
         std::vector<ManualInstInfo> manual_insts;  ///< Non-AUTOINST instances for signal tracking
         AutoLogicInfo autologic;
         AutoPortsInfo autoports;
         bool has_autologic = false;
         bool has_autoports = false;
-        std::set<std::string> existing_decls;
-        std::set<std::string> assign_driven;    ///< Signals on LHS of assign statements (driven internally)
-        std::set<std::string> assign_consumed;  ///< Signals on RHS of assign statements (consumed internally)
+        NameSet existing_decls;
+        NameSet assign_driven;    ///< Signals on LHS of assign statements (driven internally)
+        NameSet assign_consumed;  ///< Signals on RHS of assign statements (consumed internally)
     };
 
     // ════════════════════════════════════════════════════════════════════════
     // Analysis phases
     // ════════════════════════════════════════════════════════════════════════
 
+    using ModuleList = std::vector<const slang::syntax::ModuleDeclarationSyntax*>;
+
+    /// Report progress for module `index` and apply the module filter.
+    /// Returns false (and sets cancelled_) if the progress callback cancelled;
+    /// `skip` is set when the filter rejects the module.
+    bool admitModule(const ModuleList& modules, size_t index, bool& skip);
+    void analyzeParallel(const ModuleList& modules, unsigned jobs);
+
+    /// Whether replacements from index `first` on change more than whitespace
+    /// in the source (the --check verdict for the modules that produced them)
+    [[nodiscard]] bool changesSource(size_t first) const;
+
     void processModule(const slang::syntax::ModuleDeclarationSyntax& module);
     CollectedInfo collectModuleInfo(const slang::syntax::ModuleDeclarationSyntax& module);
     void processMemberRecursive(const slang::syntax::MemberSyntax* member,
                                 CollectedInfo& info,
                                 bool& in_autologic_block);
+    void collectInstantiation(const slang::syntax::HierarchyInstantiationSyntax& hier,
+                              CollectedInfo& info);
     void resolvePortsAndSignals(const slang::syntax::ModuleDeclarationSyntax& module,
                                 CollectedInfo& info);
     void generateReplacements(const slang::syntax::ModuleDeclarationSyntax& module,
-                              const CollectedInfo& info);
+                              CollectedInfo& info);
 
     // ════════════════════════════════════════════════════════════════════════
     // Replacement generators
     // ════════════════════════════════════════════════════════════════════════
 
-    void generateAutoInstReplacement(const AutoInstInfo& inst,
-                                     const std::vector<PortInfo>& ports);
+    void generateAutoInstReplacement(const AutoInstInfo& inst, InstGroup& group);
     void generateAutologicReplacement(const CollectedInfo& info);
     void generateAutoportsReplacement(const slang::syntax::ModuleDeclarationSyntax& module,
                                       const CollectedInfo& info);
@@ -170,9 +289,6 @@ private:
     std::optional<std::pair<size_t, size_t>>
     findMarkerInTrivia(slang::parsing::Token tok, std::string_view marker) const;
 
-    /// Check all tokens in a node for a marker
-    bool hasMarker(const slang::syntax::SyntaxNode& node, std::string_view marker) const;
-
     /// Find marker anywhere in node's tokens/trivia, return {start, end} offsets
     std::optional<std::pair<size_t, size_t>>
     findMarkerInNode(const slang::syntax::SyntaxNode& node, std::string_view marker) const;
@@ -181,21 +297,16 @@ private:
     // Other helpers
     // ════════════════════════════════════════════════════════════════════════
 
-    std::vector<PortInfo> getModulePorts(const std::string& module_name);
-    std::vector<PortConnection> buildConnections(const AutoInstInfo& inst,
-                                                  const std::vector<PortInfo>& ports);
-
-    std::optional<std::pair<std::string, std::string>>
-    extractInstanceInfo(const slang::syntax::MemberSyntax& member) const;
+    const ModulePorts& getModulePorts(const std::string& module_name);
+    std::vector<PortConnection> buildConnections(const AutoInstInfo& inst, InstGroup& group);
 
-    std::optional<std::string>
+    std::optional<std::string_view>
     extractDeclarationName(const slang::syntax::MemberSyntax& member) const;
 
     const AutoTemplate* findTemplate(const std::string& module_name,
                                       size_t before_line) const;
 
-    std::string generatePortConnections(const AutoInstInfo& inst,
-                                        const std::vector<PortInfo>& ports);
+    std::string generatePortConnections(const AutoInstInfo& inst, InstGroup& group);
     std::string generateAutologicDecls(const CollectedInfo& info);
     std::string detectIndent(const slang::syntax::SyntaxNode& node) const;
 
@@ -223,6 +334,24 @@ private:
     const std::vector<AutoTemplate>& templates_;
     AutosAnalyzerOptions options_;
     SignalAggregator aggregator_;
+    ExpressionCache expr_cache_;  ///< Template-generated expressions, shared across modules
+    PortCache own_port_cache_;  ///< Used when options_.port_cache is not set
+    std::mutex* port_mutex_ = nullptr;  ///< Serializes port lookups in parallel workers
+
+    // Per-module arena: reset at the start of each module. The initial buffer
+    // is reused across resets; only overflow goes to the heap.
+    CountingResource heap_counter_{std::pmr::new_delete_resource()};
+    std::vector<std::byte> arena_buffer_;
+    std::pmr::monotonic_buffer_resource arena_;
+    CountingResource arena_counter_{&arena_};
+    size_t arena_modules_ = 0;
+    size_t arena_peak_bytes_ = 0;
+    ArenaStats worker_arena_stats_;  ///< Accumulated from parallel workers
+    /// Identifiers of one expression, as views into the syntax tree. Reused
+    /// so that collecting assign statements allocates nothing per name.
+    std::vector<std::string_view> identifier_scratch_;
+    MatcherStats matcher_stats_;     ///< Summed over each module's matchers (and workers)
+    std::vector<std::string> submodule_types_;  ///< Unsorted, with duplicates (see submoduleTypes())
 
     std::string_view source_content_;  // Original source for comparison
     std::vector<Replacement> replacements_;
@@ -230,6 +359,8 @@ private:
     int autoinst_count_ = 0;
     int autologic_count_ = 0;
     int autoports_count_ = 0;
+    bool cancelled_ = false;
+    bool stopped_early_ = false;
 };
 
 } // namespace slang_autos
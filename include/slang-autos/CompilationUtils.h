@@ -1,7 +1,12 @@
 #pragma once
 
+#include <cstdint>
+#include <filesystem>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include "Diagnostics.h"
@@ -13,27 +18,43 @@ class Compilation;
 
 namespace slang_autos {
 
+class PortSnapshot;
+
+/// Port direction
+enum class PortDirection : uint8_t {
+    Input,
+    Output,
+    Inout
+};
+
+/// Verilog keyword for a port direction: "input", "output" or "inout"
+[[nodiscard]] constexpr std::string_view toString(PortDirection dir) {
+    switch (dir) {
+        case PortDirection::Input:  return "input";
+        case PortDirection::Output: return "output";
+        case PortDirection::Inout:  return "inout";
+    }
+    return "input";
+}
+
 /// Port information extracted from module definitions.
 /// Contains both resolved values (for connection) and original syntax (for declarations).
+/// Range strings are short enough to stay in the small-string buffer in the common case.
 struct PortInfo {
     std::string name;               ///< Port name
-    std::string direction;          ///< "input", "output", "inout"
-    std::string type_str = "logic"; ///< Type: "wire", "logic", "reg", etc.
-    int width = 1;                  ///< Resolved bit width (of element type for arrays)
     std::string range_str;          ///< Resolved packed range: "[7:0]"
     std::string original_range_str; ///< Original syntax: "[WIDTH-1:0]"
-    std::optional<int> msb;         ///< Most significant bit (if range)
-    std::optional<int> lsb;         ///< Least significant bit (if range)
-    bool is_signed = false;
-    bool is_array = false;
     std::string array_dims;         ///< Unpacked array dimensions: " [3:0][1:0]" (after name)
+    int width = 1;                  ///< Resolved bit width (of element type for arrays)
+    PortDirection direction = PortDirection::Input;
+    bool is_array = false;
 
     PortInfo() = default;
-    PortInfo(std::string n, std::string dir, int w = 1)
-        : name(std::move(n)), direction(std::move(dir)), width(w) {}
+    PortInfo(std::string n, PortDirection dir, int w = 1)
+        : name(std::move(n)), width(w), direction(dir) {}
 
     /// Get the packed range string, optionally preferring original syntax
-    [[nodiscard]] std::string getRangeStr(bool prefer_original = true) const {
+    [[nodiscard]] const std::string& getRangeStr(bool prefer_original = true) const {
         if (prefer_original && !original_range_str.empty()) {
             return original_range_str;
         }
@@ -41,7 +62,7 @@ struct PortInfo {
     }
 
     /// Get the unpacked array dimensions (go after the signal name)
-    [[nodiscard]] std::string getArrayDims() const {
+    [[nodiscard]] const std::string& getArrayDims() const {
         return array_dims;
     }
 };
@@ -52,11 +73,123 @@ struct PortInfo {
 /// @param module_name Name of the module to look up
 /// @param diagnostics Optional diagnostic collector for errors/warnings
 /// @param strictness Error vs warning for missing modules
+/// @param source_file If given, set to the full path of the file declaring the module
 /// @return Vector of port information (empty if module not found)
 [[nodiscard]] std::vector<PortInfo> getModulePortsFromCompilation(
     slang::ast::Compilation& compilation,
     const std::string& module_name,
     DiagnosticCollector* diagnostics = nullptr,
-    StrictnessMode strictness = StrictnessMode::Lenient);
+    StrictnessMode strictness = StrictnessMode::Lenient,
+    std::string* source_file = nullptr);
+
+/// A module's ports with precomputed presentation orders.
+/// Instance generation walks one of the orders instead of re-sorting the
+/// port list for every instance of the module.
+struct ModulePorts {
+    std::vector<PortInfo> ports;          ///< Declaration order
+    std::vector<uint32_t> alphabetical;   ///< Indices into ports, sorted by name
+    std::vector<uint32_t> by_direction;   ///< Outputs, inouts, inputs; declaration order within each
+    std::string source_file;              ///< File declaring the module (for --depfile)
+    bool default_parameters = false;      ///< From a snapshot; resolved ranges assume default parameters
+
+    ModulePorts() = default;
+    explicit ModulePorts(std::vector<PortInfo> p);
+};
+
+/// A module's parameters and ports, elaborated with default parameter values.
+/// This is what a port snapshot (PortSnapshot) stores per module.
+struct ModuleSignature {
+    struct Parameter {
+        std::string name;
+        std::string default_value;  ///< Resolved default ("8", "'hff"), or the type for type parameters
+    };
+
+    std::string name;
+    std::vector<Parameter> parameters;
+    std::vector<PortInfo> ports;
+    bool parameterized_ports = false;  ///< A port range mentions a parameter (defaults may not apply)
+};
+
+/// Signatures of every top-level instance of a compilation. Build a
+/// compilation with each library module as a top to capture a whole library.
+[[nodiscard]] std::vector<ModuleSignature> topModuleSignatures(
+    slang::ast::Compilation& compilation,
+    DiagnosticCollector* diagnostics = nullptr);
+
+/// Memoizes getModulePortsFromCompilation() per module for a single compilation.
+/// Port extraction walks the elaborated hierarchy, so repeated lookups of the
+/// same submodule (many instances, repeated expansions in the LSP) are costly.
+/// Only successful lookups are cached; a missing module is looked up (and
+/// reported) again each time. Call clear() when the compilation changes.
+///
+/// Port snapshots added with addSnapshot() are consulted before the
+/// compilation, so modules captured in one never need to be parsed.
+class PortCache {
+public:
+    /// Get ports for a module, computing and caching them on first use.
+    /// @param resolved_ranges The caller uses resolved ranges and widths, not
+    ///        just the original syntax (see addSnapshot())
+    /// @return Cached ports, or an empty vector if the module was not found
+    [[nodiscard]] const std::vector<PortInfo>& get(
+        slang::ast::Compilation& compilation,
+        const std::string& module_name,
+        DiagnosticCollector* diagnostics = nullptr,
+        StrictnessMode strictness = StrictnessMode::Lenient,
+        bool resolved_ranges = false);
+
+    /// Same as get(), including the precomputed port orders.
+    /// @return Cached entry, or an entry with no ports if the module was not found
+    [[nodiscard]] const ModulePorts& lookup(
+        slang::ast::Compilation& compilation,
+        const std::string& module_name,
+        DiagnosticCollector* diagnostics = nullptr,
+        StrictnessMode strictness = StrictnessMode::Lenient,
+        bool resolved_ranges = false);
+
+    /// Cached entry for a module, without looking it up
+    /// @return nullptr if the module has not been (successfully) looked up
+    [[nodiscard]] const ModulePorts* find(const std::string& module_name) const;
+
+    /// Consult `snapshot` (after earlier ones) before the compilation. A module
+    /// whose port ranges depend on parameters is served from the snapshot only
+    /// when ranges are not resolved, since its original range syntax holds for
+    /// any parameter values but its resolved widths assume the defaults. With
+    /// resolved ranges it must come from the compilation, and is reported if
+    /// it is not there.
+    void addSnapshot(std::shared_ptr<const PortSnapshot> snapshot);
+
+    /// Drop all cached entries (and reset counters); snapshots are kept
+    void clear();
+
+    /// Drop the entries read from `file`, and those whose source is unknown,
+    /// so that a recompilation after `file` changed looks them up again.
+    /// Entries for modules declared in other files stay valid.
+    void eraseSource(const std::filesystem::path& file);
+
+    [[nodiscard]] size_t size() const { return ports_.size(); }
+    [[nodiscard]] size_t hits() const { return hits_; }
+    [[nodiscard]] size_t misses() const { return misses_; }
+
+private:
+    std::unordered_map<std::string, ModulePorts> ports_;
+    std::vector<std::shared_ptr<const PortSnapshot>> snapshots_;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+};
+
+/// A module's interface as written in source, reduced to a hash, plus the
+/// module types it instantiates.
+struct ModuleInterface {
+    std::string name;
+    uint64_t hash = 0;  ///< Header plus body port/parameter declarations, ignoring whitespace and comments
+    std::vector<std::string> instances;  ///< Module types instantiated in the body (sorted, unique)
+};
+
+/// Hash the interface of every module and interface declared in `text`, and
+/// collect its instantiation sites, without elaborating. Body-only edits leave
+/// the hashes unchanged, so --watch and --affected-by treat a module's parents
+/// as stale only when its ports may have changed. The hash is stable across
+/// runs and builds, so it can be stored.
+[[nodiscard]] std::vector<ModuleInterface> moduleInterfaces(std::string_view text);
 
 } // namespace slang_autos
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "Diagnostics.h"
+
+namespace slang_autos {
+
+/// One command line forwarded to the daemon (slang-autos --client).
+struct DaemonRequest {
+    bool stop = false;              ///< Shut the daemon down instead of running a command
+    std::string cwd;                ///< Client working directory; the command runs there
+    std::vector<std::string> args;  ///< Full argv, including the program name
+};
+
+/// Serialize a request body (without the length header).
+[[nodiscard]] std::string encodeDaemonRequest(const DaemonRequest& request);
+
+/// Parse a request body. Returns nullopt if it is truncated or malformed.
+[[nodiscard]] std::optional<DaemonRequest> decodeDaemonRequest(std::string_view body);
+
+/// Per-user socket path: $XDG_RUNTIME_DIR/slang-autos.sock, else
+/// /tmp/slang-autos-<uid>/daemon.sock (the directory is created 0700 by
+/// DaemonServer::listen).
+[[nodiscard]] std::filesystem::path defaultDaemonSocketPath();
+
+/// Modification stamps of the files some cached state was built from.
+/// Files are compared by mtime and size; a file whose mtime moved but whose
+/// content hashes the same (a touch, or a checkout rewriting identical text)
+/// is re-stamped rather than reported. Directories are compared by mtime
+/// only, which catches files being added to or removed from them.
+class FileStamps {
+public:
+    /// Record the current state of a file or directory (once per path)
+    void add(const std::filesystem::path& path);
+
+    /// Check whether any recorded path was modified, created or removed
+    [[nodiscard]] bool changed();
+
+    [[nodiscard]] size_t size() const { return stamps_.size(); }
+
+private:
+    struct Stamp {
+        std::filesystem::path path;
+        bool exists = false;
+        bool is_directory = false;
+        std::filesystem::file_time_type mtime;
+        uintmax_t size = 0;
+        size_t hash = 0;  ///< Content hash (regular files only)
+    };
+
+    /// Stat a path (without hashing its content)
+    [[nodiscard]] static Stamp stat(const std::filesystem::path& path);
+    [[nodiscard]] static size_t hashContent(const std::filesystem::path& path);
+
+    std::vector<Stamp> stamps_;
+    std::unordered_set<std::string> seen_;
+};
+
+/// UNIX domain socket server for --daemon.
+/// Requests are served one at a time. The client passes its stdout and stderr
+/// with the request; for the duration of the handler they replace the
+/// daemon's own, and the working directory is the client's, so the handler
+/// can run a command line exactly as the CLI would.
+class DaemonServer {
+public:
+    /// Runs one command line and returns its exit code
+    using Handler = std::function<int(const DaemonRequest&)>;
+
+    DaemonServer() = default;
+    ~DaemonServer();
+
+    DaemonServer(const DaemonServer&) = delete;
+    DaemonServer& operator=(const DaemonServer&) = delete;
+
+    /// Bind and listen on `socket`. A stale socket file left by a daemon that
+    /// exited uncleanly is replaced; a live daemon on the same path is an error,
+    /// as is a socket directory owned or writable by another user. Connections
+    /// from other users are refused.
+    bool listen(const std::filesystem::path& socket, DiagnosticCollector& diagnostics);
+
+    /// Serve requests until a stop request arrives, then close the socket.
+    /// The handler runs on the calling thread.
+    void serve(const Handler& handler);
+
+private:
+    /// Stop listening and remove the socket file
+    void close();
+
+    /// Handle one connection. Returns false if it was a stop request.
+    bool serveConnection(int connection, const Handler& handler);
+
+    int fd_ = -1;
+    std::filesystem::path path_;
+};
+
+/// Forward a command line to the daemon listening on `socket`, together with
+/// this process's stdout and stderr, and wait for its exit code.
+/// @return nullopt if no daemon is listening (the caller runs locally);
+///         1 with an error in `diagnostics` if the daemon failed mid-request
+///         or runs as another user
+[[nodiscard]] std::optional<int> runDaemonClient(const std::filesystem::path& socket,
+                                                 const DaemonRequest& request,
+                                                 DiagnosticCollector& diagnostics);
+
+/// Ask the daemon listening on `socket` to exit.
+/// @return false if no daemon is listening
+bool stopDaemon(const std::filesystem::path& socket);
+
+} // namespace slang_autos
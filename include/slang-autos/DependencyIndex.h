@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "CompilationUtils.h"
+
+namespace slang_autos {
+
+/// Syntax-only module → parent index over the files to expand, for
+/// --affected-by. Built from module headers and instantiation sites
+/// (moduleInterfaces()), without elaborating anything.
+class DependencyIndex {
+public:
+    /// Index the modules declared in a file to expand (replacing earlier
+    /// entries for the same file)
+    void addFile(const std::string& file, std::string_view text);
+
+    [[nodiscard]] bool contains(const std::string& file) const { return files_.contains(file); }
+
+    /// Files to expand whose expansion may change when the ports of
+    /// `changed_modules` change: their parents, and transitively the parents
+    /// of those (re-expanding a parent can change its own ports via AUTOPORTS).
+    /// @return Indexed file names, sorted
+    [[nodiscard]] std::vector<std::string> affectedBy(const std::set<std::string>& changed_modules) const;
+
+private:
+    std::unordered_map<std::string, std::vector<ModuleInterface>> files_;
+    std::unordered_map<std::string, std::set<std::string>> parents_;  ///< Module → files instantiating it
+};
+
+/// Stored port signatures (module name → moduleInterfaces() hash), so that
+/// --affected-by can tell a port change from a body-only edit.
+using PortSignatures = std::map<std::string, uint64_t>;
+
+/// Read a signature file written by savePortSignatures().
+/// @return nullopt if the file does not exist or is malformed
+[[nodiscard]] std::optional<PortSignatures> loadPortSignatures(const std::filesystem::path& file);
+
+/// Write signatures as text, one "<module> <hex hash>" line each.
+/// @return false on I/O error
+bool savePortSignatures(const std::filesystem::path& file, const PortSignatures& signatures);
+
+} // namespace slang_autos
@@ -66,6 +66,9 @@ public:
     /// Get count of warnings
     [[nodiscard]] size_t warningCount() const { return warning_count_; }
 
+    /// Append all diagnostics from another collector, preserving their order
+    void merge(const DiagnosticCollector& other);
+
     /// Clear all diagnostics
     void clear();
 
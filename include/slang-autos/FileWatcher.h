@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace slang_autos {
+
+/// Directory change notification for --watch (inotify on Linux).
+/// Directories rather than files are watched, so that editors which save by
+/// writing a temporary file and renaming it over the original are seen, and
+/// so that files added to a library directory are noticed.
+class FileWatcher {
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /// Notification is available on this platform and was initialized
+    [[nodiscard]] bool valid() const { return fd_ >= 0; }
+
+    /// Watch a directory (non-recursively). Adding one twice is harmless.
+    /// @return false if the directory cannot be watched
+    bool addDirectory(const std::filesystem::path& dir);
+
+    /// Block until at least one file in a watched directory is written,
+    /// created, renamed or removed, then keep collecting until no event has
+    /// arrived for `settle` (so that one save, or a checkout touching many
+    /// files, comes back as a single batch).
+    /// @param timeout Give up after this long with nothing seen (default: wait forever)
+    /// @return Absolute paths of the changed files, sorted and unique; empty on timeout
+    [[nodiscard]] std::vector<std::filesystem::path> wait(
+        std::chrono::milliseconds settle,
+        std::optional<std::chrono::milliseconds> timeout = std::nullopt);
+
+private:
+    /// Read pending events into `changed`. Returns false on a read error.
+    bool drain(std::vector<std::filesystem::path>& changed);
+
+    int fd_ = -1;
+    std::unordered_map<int, std::filesystem::path> dirs_;  ///< Watch descriptor → directory
+};
+
+} // namespace slang_autos
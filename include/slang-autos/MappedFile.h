@@ -0,0 +1,37 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace slang_autos {
+
+/// Read-only view of a whole file, memory-mapped where the platform allows.
+/// Used by streaming expansion so that a very large source is not copied
+/// into a std::string just to be scanned and re-emitted.
+class MappedFile {
+public:
+    /// Map a file for reading.
+    /// @return The mapping, or nullptr if the file cannot be opened
+    [[nodiscard]] static std::shared_ptr<const MappedFile> open(const std::filesystem::path& file);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// File contents (valid for the life of this object)
+    [[nodiscard]] std::string_view view() const { return {data_, size_}; }
+    [[nodiscard]] size_t size() const { return size_; }
+
+private:
+    MappedFile() = default;
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;   ///< data_ is an mmap region (else points into fallback_)
+    std::string fallback_;  ///< Contents read normally when mapping is unavailable
+};
+
+} // namespace slang_autos
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CompilationUtils.h"
+#include "Diagnostics.h"
+#include "MappedFile.h"
+
+namespace slang_autos {
+
+/// Precompiled port signatures of a library (slang-port-snapshot), so that
+/// leaf IP need not be parsed and elaborated just to read its port lists.
+///
+/// The file is memory-mapped and read in place: a sorted index of module
+/// names is binary searched and only the matching record is decoded, so a
+/// lookup costs a few page faults however large the library is.
+///
+/// Layout (little-endian on all current targets; host byte order):
+///   header:  magic "SAPSNAP1", u32 module count
+///   index:   per module, sorted by name: u32 name offset, u32 name length,
+///            u32 record offset (offsets from the start of the file)
+///   records: u32 parameter count, (string name, string default) each,
+///            u8 parameterized_ports, u32 port count, per port: strings name,
+///            range, original range, array dims, i32 width, u8 direction,
+///            u8 is_array
+/// where a string is a u32 length followed by its bytes.
+class PortSnapshot {
+public:
+    /// Map a snapshot file.
+    /// @return nullptr (with an error in `diagnostics`) if it is missing or malformed
+    [[nodiscard]] static std::shared_ptr<const PortSnapshot> open(
+        const std::filesystem::path& file,
+        DiagnosticCollector* diagnostics = nullptr);
+
+    /// Serialize signatures into a snapshot file (duplicate names keep the first).
+    /// @return Number of modules written, or nullopt (with an error in
+    ///         `diagnostics`) on I/O error or if the file would exceed the
+    ///         4 GiB that 32-bit offsets can address
+    static std::optional<size_t> write(const std::filesystem::path& file,
+                                       std::vector<ModuleSignature> modules,
+                                       DiagnosticCollector* diagnostics = nullptr);
+
+    /// Look up a module's signature
+    [[nodiscard]] std::optional<ModuleSignature> find(std::string_view module_name) const;
+
+    /// Module names in the snapshot, sorted
+    [[nodiscard]] std::vector<std::string> moduleNames() const;
+
+    [[nodiscard]] size_t size() const { return count_; }
+    [[nodiscard]] const std::filesystem::path& path() const { return path_; }
+
+private:
+    PortSnapshot() = default;
+
+    /// Name of the module at index position `i`
+    [[nodiscard]] std::string_view nameAt(size_t i) const;
+
+    /// Decode the record at `offset`. Returns nullopt if it runs off the end.
+    [[nodiscard]] std::optional<ModuleSignature> decode(std::string_view name, uint32_t offset) const;
+
+    std::shared_ptr<const MappedFile> file_;
+    std::filesystem::path path_;
+    std::string_view data_;
+    size_t count_ = 0;
+};
+
+} // namespace slang_autos
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+
+namespace slang_autos {
+
+/// Phase boundaries reported while expanding a file.
+enum class ExpansionPhase {
+    Parse,      ///< Parsing sources into syntax trees
+    Elaborate,  ///< Elaborating the design (slang Compilation)
+    Analyze,    ///< Per-module AUTO analysis (one event per module)
+    Generate    ///< Applying replacements to produce the expanded text
+};
+
+/// Human-readable name of a phase (e.g. for progress messages).
+[[nodiscard]] constexpr std::string_view phaseName(ExpansionPhase phase) {
+    switch (phase) {
+        case ExpansionPhase::Parse:     return "parse";
+        case ExpansionPhase::Elaborate: return "elaborate";
+        case ExpansionPhase::Analyze:   return "analyze";
+        case ExpansionPhase::Generate:  return "generate";
+    }
+    return "";
+}
+
+/// A single progress notification.
+/// For ExpansionPhase::Analyze, `current`/`total` count modules in the file and
+/// `detail` is the module name; other phases report `current = total = 0`.
+struct ProgressEvent {
+    ExpansionPhase phase;
+    std::string_view detail;  ///< Optional detail (file path, module name)
+    size_t current = 0;       ///< Items completed before this event
+    size_t total = 0;         ///< Total items in this phase (0 if unknown)
+};
+
+/// Progress callback invoked at phase boundaries.
+/// Return false to request cancellation; the run stops at the next boundary
+/// and ExpansionResult::cancelled is set.
+using ProgressCallback = std::function<bool(const ProgressEvent&)>;
+
+/// Source span of a module declaration, as byte offsets into the analyzed text.
+struct ModuleSpan {
+    std::string_view name;
+    size_t start = 0;  ///< Offset of the `module` keyword
+    size_t end = 0;    ///< Offset just past `endmodule`
+};
+
+/// Module filter invoked before each module is analyzed.
+/// Return false to skip the module; it produces no replacements.
+/// Used for incremental analysis when only some modules have changed.
+using ModuleFilter = std::function<bool(const ModuleSpan&)>;
+
+} // namespace slang_autos
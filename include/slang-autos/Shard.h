@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Diagnostics.h"
+
+namespace slang_autos {
+
+/// One shard of a run split across CI runners (--shard=K/N, K counted from 1).
+struct ShardSpec {
+    uint32_t index = 1;  ///< K
+    uint32_t count = 1;  ///< N
+};
+
+/// Largest N accepted for a run split into shards
+constexpr uint32_t kMaxShards = 65536;
+
+/// Parse "K/N" with 1 <= K <= N <= kMaxShards. Returns nullopt if malformed.
+[[nodiscard]] std::optional<ShardSpec> parseShardSpec(std::string_view text);
+
+/// Estimated cost of expanding a file when no previous timings are known:
+/// its size plus a fixed weight per AUTOINST (each one elaborates and looks
+/// up a submodule).
+[[nodiscard]] uint64_t estimateExpansionCost(std::string_view text);
+
+/// Per-file expansion cost (microseconds) from a previous run's --stats=json
+/// output, keyed by path as written there. Every file costs at least 1.
+/// @return nullopt if the file cannot be read or is not stats JSON
+[[nodiscard]] std::optional<std::unordered_map<std::string, uint64_t>> loadStatsCosts(
+    const std::filesystem::path& stats_json);
+
+/// Deterministically pick the files of one shard. Files are placed in order
+/// of decreasing cost, each on the shard with the least total cost so far
+/// (then the fewest files; remaining ties go to the earlier file and the
+/// lower shard), so every runner
+/// computes the same partition from the same inputs and shards finish at
+/// about the same time.
+/// @return Indices into `costs` belonging to `shard`, in increasing order
+[[nodiscard]] std::vector<size_t> selectShard(const std::vector<uint64_t>& costs, ShardSpec shard);
+
+/// What one shard did (--shard-result), for merging with --merge-shards.
+struct ShardResult {
+    uint32_t shard = 1;
+    uint32_t shards = 1;
+    int exit_code = 0;
+    size_t files = 0;
+    size_t files_changed = 0;
+    int autoinst = 0;
+    int autologic = 0;
+    int autoports = 0;
+    bool partial = false;  ///< AUTO counts are lower bounds (--check stops at the first change)
+    std::vector<std::string> changed;  ///< Files changed (or that would be, with --check)
+};
+
+/// Format a shard result as a JSON object (with trailing newline)
+[[nodiscard]] std::string toJson(const ShardResult& result);
+
+/// Parse JSON written by toJson(). Returns nullopt if malformed, including
+/// counts that are not integers in range and shard numbers outside 1..kMaxShards.
+[[nodiscard]] std::optional<ShardResult> parseShardResult(std::string_view json);
+
+/// Combine the results of all N shards of a run. The exit code is the
+/// highest shard exit code; a missing, duplicated or mismatched shard, or a
+/// shard count above kMaxShards, is an error in `diagnostics` and makes the
+/// exit code at least 1.
+[[nodiscard]] ShardResult mergeShardResults(const std::vector<ShardResult>& results,
+                                            DiagnosticCollector& diagnostics);
+
+} // namespace slang_autos
@@ -1,12 +1,13 @@
 #pragma once
 
+#include <deque>
 #include <optional>
-#include <set>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 
 #include "Diagnostics.h"
+#include "StringPool.h"
 #include "TemplateMatcher.h"
 
 namespace slang::ast {
@@ -49,21 +50,72 @@ namespace slang_autos {
 [[nodiscard]] std::vector<std::string> extractIdentifiersFromSyntax(
     const slang::syntax::SyntaxNode& node);
 
+/// As extractIdentifiersFromSyntax(), but appends the names to `out` as views
+/// into the syntax tree's tokens, valid as long as the tree. Nothing is
+/// allocated per name, and `out` can be reused across calls.
+void extractIdentifierViewsFromSyntax(const slang::syntax::SyntaxNode& node,
+                                      std::vector<std::string_view>& out);
+
+/// Everything the aggregator needs to know about a signal expression,
+/// gathered in a single parse.
+struct ExpressionInfo {
+    std::vector<std::string> identifiers; ///< As extractIdentifiers()
+    int max_bit_index = -1;               ///< As extractMaxBitIndex()
+    bool is_concatenation = false;        ///< As isConcatenation()
+};
+
+/// Parse an expression string once and extract identifiers, max bit index
+/// and the concatenation flag.
+/// Example: "{a[7:0], b[15]}" -> {["a", "b"], 15, true}
+[[nodiscard]] ExpressionInfo analyzeExpression(std::string_view expr);
+
+/// Lexical fast path of analyzeExpression() for `id`, `id[N]`, `id[M:N]` and
+/// flat `{a, b[3], c[7:0]}` forms. Returns nullopt for anything else (constants,
+/// operators, keywords, escaped names), which then needs the full parser.
+[[nodiscard]] std::optional<ExpressionInfo> analyzeSimpleExpression(std::string_view expr);
+
+/// Same as analyzeExpression(), for an expression that is already parsed.
+[[nodiscard]] ExpressionInfo analyzeExpressionSyntax(const slang::syntax::SyntaxNode& node);
+
+/// Memoizes analyzeExpression() by expression text.
+/// Templates produce the same expressions over and over (a clock or reset on
+/// every instance), so each distinct expression is parsed only once.
+class ExpressionCache {
+public:
+    /// Analyze an expression, or return the cached result for the same text.
+    /// The reference stays valid until clear().
+    [[nodiscard]] const ExpressionInfo& get(std::string_view expr);
+
+    /// Drop all cached entries (and reset counters)
+    void clear();
+
+    [[nodiscard]] size_t size() const { return results_.size(); }
+    [[nodiscard]] size_t hits() const { return hits_; }
+    [[nodiscard]] size_t misses() const { return misses_; }
+
+private:
+    StringPool texts_;                   ///< Expression text -> result index
+    std::deque<ExpressionInfo> results_; ///< Indexed by texts_ ID (stable references)
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+};
+
 /// A single port connection in the expansion output.
 struct PortConnection {
     std::string port_name;      ///< Name of the port
     std::string signal_expr;    ///< Signal expression for output generation
-    std::string direction;      ///< "input", "output", "inout"
+    PortDirection direction = PortDirection::Input;
     std::vector<std::string> signal_identifiers; ///< Extracted signal names (pre-computed)
+    int max_bit_index = -1;     ///< Highest constant bit select in signal_expr (-1 if none)
     bool is_unconnected = false;///< Port left unconnected (via _ template)
     bool is_constant = false;   ///< Connected to constant ('0, '1, 'z)
     bool is_concatenation = false; ///< Expression is a concatenation {a, b}
 
     PortConnection() = default;
-    PortConnection(std::string port, std::string signal, std::string dir)
+    PortConnection(std::string port, std::string signal, PortDirection dir)
         : port_name(std::move(port))
         , signal_expr(std::move(signal))
-        , direction(std::move(dir)) {}
+        , direction(dir) {}
 };
 
 /// Grouping/sorting preference for generated declarations and ports.
@@ -131,18 +183,23 @@ struct NetInfo {
     }
 };
 
-/// Track how a net is used across all instances.
-struct NetUsage {
-    NetInfo info;
-    bool driven_by_instance = false;   ///< Connected to an instance output/inout
-    bool consumed_by_instance = false; ///< Connected to an instance input/inout
-    std::vector<std::string> source_instances; ///< Instances using this net
-};
+/// Interned net name ID. Nets are numbered in first-seen order.
+using NetId = SymbolId;
+
+/// Interned instance name ID.
+using InstId = SymbolId;
 
 /// Aggregates nets across all AUTOINSTs, resolving width conflicts.
 /// Tracks which nets are driven by instance outputs and which are consumed by instance inputs.
+///
+/// Net and instance names are interned, and per-net state is kept in a flat
+/// vector indexed by NetId, so aggregation is linear in the number of
+/// connections even for high-fanout nets such as clocks and resets.
+/// Getters return nets in first-seen order.
 class SignalAggregator {
 public:
+    SignalAggregator();
+
     /// Add port connections from an instance.
     /// For each port: record the net name, its width, and whether it's input/output/inout.
     void addFromInstance(const std::string& inst_name,
@@ -162,8 +219,11 @@ public:
     /// These are instance-to-instance connections that need logic declarations.
     [[nodiscard]] std::vector<NetInfo> getInternalNets() const;
 
-    /// Look up aggregated net info by name. Returns nullptr if not found.
-    [[nodiscard]] const NetInfo* getNetInfo(const std::string& name) const;
+    /// Look up aggregated net info by name. Returns nullopt if not found.
+    [[nodiscard]] std::optional<NetInfo> getNetInfo(std::string_view name) const;
+
+    /// Get the instances connected to a net, in first-connection order.
+    [[nodiscard]] std::vector<std::string> getSourceInstances(std::string_view name) const;
 
     /// Register an unused signal (for capturing discarded output bits).
     /// @param name Signal name (e.g., "unused_data_u_inst")
@@ -174,11 +234,28 @@ public:
     [[nodiscard]] const std::vector<NetInfo>& getUnusedSignals() const;
 
 private:
-    std::unordered_map<std::string, NetUsage> nets_;
-    std::set<std::string> inout_nets_;  ///< Nets connected to inout ports
-    std::set<std::string> concatenation_nets_;  ///< Nets from concatenation expressions (internal-only)
+    /// Compact per-net state. Range strings are interned in ranges_ since
+    /// most nets share a handful of distinct ranges.
+    struct NetRecord {
+        int width = 1;                  ///< Maximum width across all connections
+        SymbolId original_range = 0;    ///< Original syntax range (ranges_ ID)
+        SymbolId resolved_range = 0;    ///< Resolved packed range (ranges_ ID)
+        SymbolId array_dims = 0;        ///< Unpacked dimensions (ranges_ ID)
+        bool driven_by_instance = false;   ///< Connected to an instance output/inout
+        bool consumed_by_instance = false; ///< Connected to an instance input/inout
+        bool is_inout = false;             ///< Connected to an inout port
+        bool from_output_concat = false;   ///< Part of an output concatenation (internal-only)
+        std::vector<InstId> source_instances; ///< Instances using this net
+    };
+
+    /// Build the public NetInfo view of a net
+    [[nodiscard]] NetInfo makeNetInfo(NetId id) const;
+
+    StringPool net_names_;   ///< NetId -> net name
+    StringPool inst_names_;  ///< InstId -> instance name
+    StringPool ranges_;      ///< Range and dimension strings ("" is ID 0)
+    std::vector<NetRecord> nets_;  ///< Indexed by NetId
     std::vector<NetInfo> unused_signals_;  ///< Unused signals for output width adaptation
-    int next_order_ = 0;                ///< Counter for assigning first_seen_order to new nets
 };
 
 } // namespace slang_autos
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace slang_autos {
+
+/// Cost counters for expanding one file (or, summed, a whole run).
+/// Reported by --stats=json for tracking expansion cost over time.
+struct ExpansionStats {
+    uint64_t parse_us = 0;         ///< Template and syntax-tree parsing
+    uint64_t elaborate_us = 0;     ///< Elaboration (slang Compilation)
+    uint64_t analyze_us = 0;       ///< AUTO analysis and text generation
+    uint64_t write_us = 0;         ///< Applying replacements and writing output
+    size_t port_cache_hits = 0;
+    size_t port_cache_misses = 0;
+    size_t rule_evaluations = 0;   ///< Template rules tried against a port
+    size_t regex_compilations = 0; ///< Template patterns compiled
+    size_t bytes_read = 0;
+    size_t bytes_written = 0;      ///< 0 unless the file was rewritten
+    size_t replacements = 0;       ///< Replacements emitted
+    size_t peak_rss_bytes = 0;     ///< Process peak RSS when the file finished
+
+    ExpansionStats& operator+=(const ExpansionStats& other);
+};
+
+/// Allocation counters for the analyzer's per-module arena.
+/// Reported with --verbose to show how much collection state hit the heap.
+struct ArenaStats {
+    size_t modules = 0;           ///< Modules whose state was collected
+    size_t allocations = 0;       ///< Allocations served by the arena
+    size_t bytes = 0;             ///< Bytes served by the arena
+    size_t heap_allocations = 0;  ///< Blocks the arena had to take from the heap
+    size_t peak_module_bytes = 0; ///< Largest arena usage of a single module
+
+    ArenaStats& operator+=(const ArenaStats& other);
+};
+
+/// Peak resident set size of this process in bytes (0 if unavailable)
+[[nodiscard]] size_t peakRssBytes();
+
+/// Quote and escape a string for JSON output
+[[nodiscard]] std::string jsonQuote(std::string_view text);
+
+/// Format stats as a JSON object (single line, no trailing newline)
+[[nodiscard]] std::string toJson(const ExpansionStats& stats);
+
+} // namespace slang_autos
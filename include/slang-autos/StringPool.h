@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace slang_autos {
+
+/// Integer handle for an interned string.
+/// IDs are dense and assigned in first-intern order, so they also serve as
+/// stable insertion-order keys and as indices into parallel vectors.
+using SymbolId = uint32_t;
+
+/// Interns strings and maps them to dense integer IDs.
+///
+/// Lookups go through a flat open-addressing table (linear probing over
+/// stored hashes), so a repeated name such as `clk` costs one hash and one
+/// string compare. Interned strings keep stable addresses for the life of
+/// the pool, so views returned by str() stay valid across intern() calls.
+class StringPool {
+public:
+    /// Returned by find() when the string has not been interned
+    static constexpr SymbolId npos = UINT32_MAX;
+
+    /// Intern a string, returning its existing ID if already present
+    SymbolId intern(std::string_view s);
+
+    /// Look up a string without interning it
+    [[nodiscard]] SymbolId find(std::string_view s) const;
+
+    /// Get the string for an ID
+    [[nodiscard]] std::string_view str(SymbolId id) const { return strings_[id]; }
+
+    [[nodiscard]] size_t size() const { return strings_.size(); }
+    [[nodiscard]] bool empty() const { return strings_.empty(); }
+
+    void clear();
+
+private:
+    /// Slot holding `s`, or the empty slot where it would be inserted
+    [[nodiscard]] size_t probe(std::string_view s, size_t hash) const;
+    void grow();
+
+    std::deque<std::string> strings_;  ///< ID -> string (deque keeps addresses stable)
+    std::vector<size_t> hashes_;       ///< ID -> hash (avoids rehashing on grow)
+    std::vector<SymbolId> slots_;      ///< Open-addressing table, power-of-two size
+};
+
+} // namespace slang_autos
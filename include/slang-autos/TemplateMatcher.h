@@ -1,5 +1,6 @@
 #pragma once
 
+#include <optional>
 #include <regex>
 #include <set>
 #include <string>
@@ -22,6 +23,18 @@ struct MatchResult {
         : signal_name(std::move(name)), matched_rule(rule) {}
 };
 
+/// Work counters for a TemplateMatcher (reported by --stats).
+struct MatcherStats {
+    size_t rule_evaluations = 0;   ///< Rule patterns tried against a port name
+    size_t regex_compilations = 0; ///< Instance and port patterns compiled
+
+    MatcherStats& operator+=(const MatcherStats& other) {
+        rule_evaluations += other.rule_evaluations;
+        regex_compilations += other.regex_compilations;
+        return *this;
+    }
+};
+
 /// Matches ports against template rules and performs variable substitution.
 /// Supports:
 /// - Port captures: $1, $2, ${1}, ${2} from port pattern regex groups
@@ -35,6 +48,8 @@ public:
         DiagnosticCollector* diagnostics = nullptr);
 
     /// Set the current instance and extract captures from instance pattern.
+    /// The instance pattern is compiled on first use, so one matcher can be
+    /// reused across all instances of a template.
     /// @param instance_name The instance name to match
     /// @return true if instance matches the template pattern (or no template)
     bool setInstance(const std::string& instance_name);
@@ -54,6 +69,9 @@ public:
     /// Get the current instance name
     [[nodiscard]] const std::string& instanceName() const { return inst_name_; }
 
+    /// Rules evaluated and patterns compiled by this matcher so far
+    [[nodiscard]] const MatcherStats& stats() const { return stats_; }
+
 private:
     /// Apply variable substitution to a signal expression.
     /// @param expr Signal expression with placeholders
@@ -91,12 +109,18 @@ private:
     std::vector<std::string> inst_captures_;
     std::set<std::string> warned_unresolved_;  // Avoid duplicate warnings
 
+    /// Compiled instance pattern (nullopt if invalid or not yet compiled)
+    std::optional<std::regex> inst_pattern_;
+    bool inst_pattern_compiled_ = false;
+
     /// Cache of compiled regex patterns (keyed by pattern string)
     /// This avoids recompiling the same pattern for each port match.
     std::unordered_map<std::string, std::regex> regex_cache_;
 
     /// Set of patterns that failed to compile (to avoid repeated error reports)
     std::set<std::string> invalid_patterns_;
+
+    MatcherStats stats_;
 };
 
 } // namespace slang_autos
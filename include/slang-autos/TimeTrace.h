@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace slang_autos {
+
+/// Start recording time-trace spans for this process.
+/// Until this is called, TimeTraceScope does nothing beyond one relaxed
+/// atomic load, so the instrumentation can stay in release builds.
+void timeTraceBegin();
+
+/// True between timeTraceBegin() and timeTraceWrite()
+[[nodiscard]] bool timeTraceEnabled();
+
+/// Write the recorded spans as Chrome trace_event JSON (loadable in
+/// chrome://tracing or Perfetto) and stop recording.
+/// @return false if the file could not be written
+bool timeTraceWrite(const std::filesystem::path& file);
+
+/// Records a complete ("X") trace event spanning its lifetime.
+/// Scopes nest naturally; spans from different threads get their own track.
+///
+///     TimeTraceScope scope("Analyze", module_name);
+class TimeTraceScope {
+public:
+    explicit TimeTraceScope(std::string_view name, std::string_view detail = {});
+    ~TimeTraceScope();
+
+    TimeTraceScope(const TimeTraceScope&) = delete;
+    TimeTraceScope& operator=(const TimeTraceScope&) = delete;
+
+private:
+    bool active_ = false;
+    std::string_view name_;
+    std::string detail_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace slang_autos
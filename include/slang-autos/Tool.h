@@ -4,12 +4,17 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
+#include "CompilationUtils.h"
 #include "Diagnostics.h"
+#include "MappedFile.h"
 #include "SignalAggregator.h"
 #include "Parser.h"
+#include "Progress.h"
+#include "Stats.h"
 #include "Writer.h"
 
 // Forward declarations for slang types
@@ -24,16 +29,38 @@ namespace slang_autos {
 
 /// Result of expanding a single file
 struct ExpansionResult {
-    std::string original_content;   ///< Original file content
-    std::string modified_content;   ///< Content after expansion
-    std::vector<Replacement> replacements;  ///< All replacements made
+    std::string original_content;   ///< Original file content (empty when streamed)
+    std::string modified_content;   ///< Content after expansion (empty when streamed)
+    std::vector<Replacement> replacements;  ///< All replacements made (offsets into original_content)
     int autoinst_count = 0;         ///< Number of AUTOINSTs expanded
     int autologic_count = 0;        ///< Number of AUTOLOGICs expanded
     int autoports_count = 0;        ///< Number of AUTOPORTSs expanded
     bool success = true;            ///< false if fatal errors occurred
+    bool cancelled = false;         ///< true if the progress callback cancelled the run;
+                                    ///< replacements then hold the modules finished before it
+    ArenaStats arena_stats;         ///< Per-module arena allocation counters
+    ExpansionStats stats;           ///< Timings and work counters (--stats)
+    std::vector<std::string> submodules;  ///< Module types the expansion depends on (sorted)
+    std::vector<std::string> port_sources;  ///< Files the submodules' ports were read from (sorted)
+
+    /// Streaming mode (AutosTool::expandFileStreaming): the original stays
+    /// mapped, no content strings are built, and the change flags are
+    /// computed from the replacements alone.
+    struct StreamedChanges {
+        bool any = false;             ///< As hasChanges()
+        bool non_whitespace = false;  ///< As hasNonWhitespaceChanges()
+    };
+    std::shared_ptr<const MappedFile> original_view;  ///< Mapped original (streaming only)
+    std::optional<StreamedChanges> streamed;          ///< Set in streaming mode
+
+    /// Original text, whether held as a string or mapped
+    [[nodiscard]] std::string_view originalText() const {
+        return original_view ? original_view->view() : std::string_view(original_content);
+    }
 
     /// Check if any changes were made
     [[nodiscard]] bool hasChanges() const {
+        if (streamed) return streamed->any;
         return original_content != modified_content;
     }
 
@@ -54,6 +81,7 @@ struct AutosToolOptions {
     std::optional<DirectionComments> direction_comments; ///< Per-port direction arrows (nullopt = disabled)
     std::optional<PortGrouping> grouping; ///< Port grouping (nullopt = ByDirection default)
     NetType net_type = NetType::Logic; ///< Net type for generated declarations
+    unsigned module_jobs = 1; ///< Modules analyzed concurrently per file (0 = hardware threads)
 };
 
 /// Main orchestrator for AUTO macro expansion.
@@ -78,6 +106,17 @@ public:
     /// @return true if loading succeeded
     bool loadWithArgs(const std::vector<std::string>& args);
 
+    /// Recompile with the arguments of the last loadWithArgs() after
+    /// `changed_files` were modified on disk. Cached ports of modules declared
+    /// in other files are kept; those read from a changed file are dropped.
+    /// @return true if loading succeeded (false if nothing was loaded before)
+    bool reload(const std::vector<std::filesystem::path>& changed_files);
+
+    /// Full paths of every source buffer of the compilation (sources,
+    /// library files and includes), for deciding whether a change affects it.
+    /// Empty unless the design was loaded with loadWithArgs().
+    [[nodiscard]] std::vector<std::filesystem::path> sourceFiles() const;
+
     /// Set a pre-created compilation (alternative to loadWithArgs).
     /// Used when the driver is managed externally (e.g., by main.cpp).
     void setCompilation(std::unique_ptr<slang::ast::Compilation> compilation);
@@ -90,6 +129,39 @@ public:
         const std::filesystem::path& file,
         bool dry_run = false);
 
+    /// Expand all AUTO macros in a file with bounded memory.
+    /// The file is memory-mapped rather than read into a string, and output is
+    /// streamed to disk from the original and the replacement list, so neither
+    /// `original_content` nor `modified_content` is populated. Intended for very
+    /// large (e.g. flattened netlist) files; use expandFile() when the full
+    /// modified text is needed, such as for a diff.
+    /// @param file Path to the file to expand
+    /// @param dry_run If true, don't modify the file
+    /// @return Expansion result with `original_view`, `replacements` and `streamed` set
+    [[nodiscard]] ExpansionResult expandFileStreaming(
+        const std::filesystem::path& file,
+        bool dry_run = false);
+
+    /// Decide whether a file needs expansion (--check) as cheaply as possible.
+    /// The file is mapped as in expandFileStreaming() and nothing is built or
+    /// written: each replacement is compared in place with the text it would
+    /// replace, ignoring whitespace. Analysis stops after the first module
+    /// whose output differs, so counts and replacements may be partial.
+    /// @return Result with `original_view` and `streamed` set; `streamed->any`
+    ///         equals `streamed->non_whitespace` (whitespace is not checked)
+    [[nodiscard]] ExpansionResult checkFile(const std::filesystem::path& file);
+
+    /// Expand all AUTO macros in in-memory content (e.g. an unsaved editor buffer).
+    /// Nothing is written to disk.
+    /// @param file Path the content belongs to (for inline config and diagnostics)
+    /// @param content Source text to expand
+    /// @param filter Optional filter to analyze only some modules
+    /// @return Expansion result; `replacements` holds the minimal edits
+    [[nodiscard]] ExpansionResult expandContent(
+        const std::filesystem::path& file,
+        std::string content,
+        ModuleFilter filter = {});
+
     /// Get the diagnostics collector
     [[nodiscard]] DiagnosticCollector& diagnostics() { return diagnostics_; }
     [[nodiscard]] const DiagnosticCollector& diagnostics() const { return diagnostics_; }
@@ -97,13 +169,39 @@ public:
     /// Get current options
     [[nodiscard]] const Options& options() const { return options_; }
 
+    /// Submodule port cache for the current compilation
+    [[nodiscard]] const PortCache& portCache() const { return port_cache_; }
+
+    /// Take submodule ports from a precompiled snapshot where possible.
+    /// Snapshots are kept across compilations.
+    void addPortSnapshot(std::shared_ptr<const PortSnapshot> snapshot) {
+        port_cache_.addSnapshot(std::move(snapshot));
+    }
+
     /// Set options
     void setOptions(const Options& options) { options_ = options; }
 
     /// Set pre-parsed inline config for a file (avoids double-parsing)
     void setInlineConfig(const std::filesystem::path& file, const InlineConfig& config);
 
+    /// Set a callback invoked at phase boundaries of loadWithArgs() and expandFile().
+    /// The callback may return false to cancel the current run.
+    void setProgressCallback(ProgressCallback callback) { progress_ = std::move(callback); }
+
 private:
+    /// Analyze `content` and fill in `result.replacements` and the statistics,
+    /// or set `result.success`/`result.cancelled` on failure. Shared by the
+    /// in-memory, streaming and check paths; builds no output text.
+    /// @param stop_at_first_change Stop after the first module whose output differs
+    void analyzeContent(const std::filesystem::path& file,
+                        std::string_view content,
+                        ModuleFilter filter,
+                        ExpansionResult& result,
+                        bool stop_at_first_change = false);
+
+    /// Report a phase boundary. Returns false if the callback requested cancellation.
+    bool reportProgress(ExpansionPhase phase, std::string_view detail = {});
+
     /// Get inline config for a file (returns empty config if not set)
     [[nodiscard]] InlineConfig getInlineConfig(const std::filesystem::path& file) const;
     /// Extract port information for a module from compilation
@@ -114,11 +212,16 @@ private:
     std::unique_ptr<slang::driver::Driver> driver_;
     std::unique_ptr<slang::ast::Compilation> compilation_;
 
+    /// Arguments of the last loadWithArgs(), for reload()
+    std::vector<std::string> load_args_;
+
     /// Cache for module port lookups (avoids repeated AST traversal)
-    std::unordered_map<std::string, std::vector<PortInfo>> port_cache_;
+    PortCache port_cache_;
 
     /// Pre-parsed inline configs per file (set by main.cpp, avoids double-parsing)
     std::unordered_map<std::string, InlineConfig> inline_configs_;
+
+    ProgressCallback progress_;
 };
 
 } // namespace slang_autos
@@ -2,6 +2,7 @@
 
 #include <filesystem>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace slang_autos {
@@ -18,6 +19,17 @@ struct Replacement {
         : start(s), end(e), new_text(std::move(text)), description(std::move(desc)) {}
 };
 
+/// Compare two texts ignoring spaces and tabs, so that reindented AUTO
+/// output (e.g. by verible-verilog-format) is not reported as a change.
+[[nodiscard]] bool differsIgnoringWhitespace(std::string_view a, std::string_view b);
+
+/// Check whether applying replacements would change `content`, judging each
+/// replaced span against its new text rather than comparing whole files.
+/// @param ignore_whitespace Compare as differsIgnoringWhitespace() does
+[[nodiscard]] bool replacementsChangeContent(std::string_view content,
+                                             const std::vector<Replacement>& replacements,
+                                             bool ignore_whitespace = false);
+
 /// Handles in-place modification of source files.
 /// Applies replacements bottom-up (highest offset first) to preserve earlier offsets.
 class SourceWriter {
@@ -33,6 +45,20 @@ public:
         const std::string& content,
         std::vector<Replacement>& replacements);
 
+    /// Write the result of applying replacements straight to a file, without
+    /// building the modified content in memory. Unchanged gaps are copied from
+    /// `content` and the output goes to a temporary file next to `file` that
+    /// then replaces it, so a failed write leaves the original intact. If
+    /// `file` is a symlink, the file it resolves to is replaced instead.
+    /// @param file Path to write to
+    /// @param content Original text content (e.g. a MappedFile view)
+    /// @param replacements List of replacements (will be sorted)
+    /// @return true if file was written (false if dry_run or on I/O error)
+    bool writeReplacements(
+        const std::filesystem::path& file,
+        std::string_view content,
+        std::vector<Replacement>& replacements);
+
     /// Write content to a file.
     /// @param file Path to write to
     /// @param content Content to write
@@ -53,4 +79,9 @@ private:
     bool dry_run_;
 };
 
+/// Format one Make/Ninja depfile rule, `target: deps...`, escaping spaces,
+/// '#' and '$' in paths the way both tools read them back.
+[[nodiscard]] std::string formatDepfileRule(const std::string& target,
+                                            const std::vector<std::string>& deps);
+
 } // namespace slang_autos
@@ -0,0 +1,161 @@
+#include "slang-autos/AutoStripper.h"
+#include "slang-autos/Constants.h"
+
+#include <algorithm>
+#include <optional>
+
+#include <slang/syntax/SyntaxTree.h>
+#include <slang/syntax/SyntaxNode.h>
+#include <slang/text/SourceManager.h>
+
+namespace slang_autos {
+
+using namespace slang;
+using namespace slang::parsing;
+using namespace slang::syntax;
+
+namespace {
+
+/// State for the single pass over the token stream.
+class StripScanner {
+public:
+    StripScanner(const SourceManager& sm, std::string_view source,
+                 std::vector<Replacement>& replacements,
+                 DiagnosticCollector& diagnostics)
+        : sm_(sm), source_(source), replacements_(replacements), diagnostics_(diagnostics) {}
+
+    void visit(const SyntaxNode& node) {
+        for (size_t i = 0; i < node.getChildCount(); ++i) {
+            if (auto tok = node.childToken(i); tok.valid()) {
+                visitToken(tok);
+            } else if (auto* child = node.childNode(i)) {
+                visit(*child);
+            }
+        }
+    }
+
+    void finish() {
+        if (block_start_) {
+            diagnostics_.addWarning(
+                "Unterminated AUTOLOGIC block (missing '" +
+                std::string(markers::END_AUTOMATICS) + "') - left unchanged",
+                "", 0, "strip");
+        }
+    }
+
+private:
+    /// A marker whose expansion runs to the `)` closing paren depth `depth`
+    struct PendingStrip {
+        size_t marker_end;
+        int depth;
+        const char* what;
+    };
+
+    void visitToken(Token tok) {
+        auto loc = tok.location();
+        if (sm_.isMacroLoc(loc) || sm_.isIncludedFileLoc(loc)) {
+            return;
+        }
+
+        // Trivia is contiguous before the token (see AutosAnalyzer::findMarkerInTrivia)
+        size_t token_loc = loc.offset();
+        size_t total_trivia_len = 0;
+        for (const auto& trivia : tok.trivia()) {
+            total_trivia_len += trivia.getRawText().length();
+        }
+        size_t trivia_offset = token_loc - total_trivia_len;
+        for (const auto& trivia : tok.trivia()) {
+            auto raw = trivia.getRawText();
+            if (trivia.kind == TriviaKind::LineComment || trivia.kind == TriviaKind::BlockComment) {
+                visitComment(raw, trivia_offset);
+            }
+            trivia_offset += raw.length();
+        }
+
+        if (tok.kind == TokenKind::OpenParenthesis) {
+            ++depth_;
+        } else if (tok.kind == TokenKind::CloseParenthesis) {
+            if (!pending_.empty() && pending_.back().depth == depth_) {
+                auto pending = pending_.back();
+                pending_.pop_back();
+                addStrip(pending.marker_end, token_loc, pending.what);
+            }
+            --depth_;
+        }
+    }
+
+    void visitComment(std::string_view raw, size_t offset) {
+        if (auto pos = raw.find(markers::AUTOINST); pos != std::string_view::npos) {
+            pending_.push_back({offset + pos + markers::AUTOINST.length(), depth_, "AUTOINST"});
+        } else if (auto pos = raw.find(markers::AUTOPORTS); pos != std::string_view::npos) {
+            pending_.push_back({offset + pos + markers::AUTOPORTS.length(), depth_, "AUTOPORTS"});
+        } else if (auto pos = raw.find(markers::AUTOLOGIC); pos != std::string_view::npos) {
+            autologic_end_ = offset + pos + markers::AUTOLOGIC.length();
+        } else if (raw.starts_with(markers::BEGIN_AUTOLOGIC)) {
+            if (!block_start_) {
+                block_start_ = offset;
+                // A fresh expansion is inserted directly after the marker; take
+                // the separating whitespace too so stripping restores the original
+                if (autologic_end_ && *autologic_end_ <= offset) {
+                    auto gap = source_.substr(*autologic_end_, offset - *autologic_end_);
+                    if (gap.find_first_not_of(" \t\r\n") == std::string_view::npos) {
+                        block_start_ = autologic_end_;
+                    }
+                }
+            }
+        } else if (raw.starts_with(markers::END_AUTOMATICS)) {
+            if (block_start_) {
+                addStrip(*block_start_, offset + markers::END_AUTOMATICS.length(), "AUTOLOGIC");
+                block_start_.reset();
+                autologic_end_.reset();
+            }
+        }
+    }
+
+    void addStrip(size_t start, size_t end, const char* what) {
+        if (start >= end || end > source_.size()) {
+            return;
+        }
+        replacements_.push_back({start, end, "", std::string("strip ") + what});
+    }
+
+    const SourceManager& sm_;
+    std::string_view source_;
+    std::vector<Replacement>& replacements_;
+    DiagnosticCollector& diagnostics_;
+
+    int depth_ = 0;
+    std::vector<PendingStrip> pending_;
+    std::optional<size_t> autologic_end_;
+    std::optional<size_t> block_start_;
+};
+
+} // namespace
+
+void AutoStripper::analyze(const std::shared_ptr<SyntaxTree>& tree,
+                           std::string_view source_content) {
+    replacements_.clear();
+
+    StripScanner scanner(tree->sourceManager(), source_content, replacements_, diagnostics_);
+    scanner.visit(tree->root());
+    scanner.finish();
+
+    // Port lists close in source order except when nested, so sort once here
+    std::sort(replacements_.begin(), replacements_.end(),
+              [](const Replacement& a, const Replacement& b) { return a.start < b.start; });
+}
+
+std::string stripAutos(const std::string& source) {
+    auto tree = SyntaxTree::fromText(source);
+    AutoStripper stripper;
+    stripper.analyze(tree, source);
+
+    auto& replacements = stripper.getReplacements();
+    if (replacements.empty()) {
+        return source;
+    }
+    SourceWriter writer(true);
+    return writer.applyReplacements(source, replacements);
+}
+
+} // namespace slang_autos
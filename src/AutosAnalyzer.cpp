@@ -3,10 +3,13 @@
 #include "slang-autos/CompilationUtils.h"
 #include "slang-autos/SignalAggregator.h"
 #include "slang-autos/TemplateMatcher.h"
+#include "slang-autos/TimeTrace.h"
+#include "slang-autos/Writer.h"
 
-#include <sstream>
 #include <algorithm>
-#include <iomanip>
+#include <set>
+#include <thread>
+#include <utility>
 
 #include <slang/ast/Compilation.h>
 #include <slang/ast/symbols/InstanceSymbols.h>
@@ -30,6 +33,36 @@ const char* netTypeKeyword(NetType nt) {
         default:                 return "logic";
     }
 }
+
+/// Append `text` left-justified in a field of `width` characters.
+void appendPadded(std::string& out, std::string_view text, size_t width) {
+    out.append(text);
+    if (text.size() < width) {
+        out.append(width - text.size(), ' ');
+    }
+}
+
+/// Length of the text appendNetDecl() writes for `net`.
+size_t netDeclLength(std::string_view keyword, std::string_view range, const NetInfo& net) {
+    return keyword.size() + (range.empty() ? 0 : 1 + range.size()) +
+           1 + net.name.size() + net.array_dims.size();
+}
+
+/// Append a generated declaration: "<keyword>[ <range>] <name><array dims>".
+void appendNetDecl(std::string& out, std::string_view keyword, std::string_view range,
+                   const NetInfo& net) {
+    out.append(keyword);
+    if (!range.empty()) {
+        out += ' ';
+        out.append(range);
+    }
+    out += ' ';
+    out.append(net.name);
+    out.append(net.array_dims);
+}
+
+/// Initial arena buffer; enough for the collection state of typical modules.
+constexpr size_t kArenaInitialBytes = 16 * 1024;
 } // anonymous namespace
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -42,7 +75,48 @@ AutosAnalyzer::AutosAnalyzer(
     const AutosAnalyzerOptions& options)
     : compilation_(compilation)
     , templates_(templates)
-    , options_(options) {
+    , options_(options)
+    , arena_buffer_(kArenaInitialBytes)
+    , arena_(arena_buffer_.data(), arena_buffer_.size(), &heap_counter_) {
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// Arena support
+// ════════════════════════════════════════════════════════════════════════════
+
+void* AutosAnalyzer::CountingResource::do_allocate(size_t size, size_t alignment) {
+    ++allocations;
+    bytes += size;
+    return upstream_->allocate(size, alignment);
+}
+
+void AutosAnalyzer::CountingResource::do_deallocate(void* p, size_t size, size_t alignment) {
+    upstream_->deallocate(p, size, alignment);
+}
+
+void AutosAnalyzer::NameSet::seal() {
+    if (sealed_) return;
+    std::sort(names_.begin(), names_.end());
+    names_.erase(std::unique(names_.begin(), names_.end()), names_.end());
+    sealed_ = true;
+}
+
+bool AutosAnalyzer::NameSet::contains(std::string_view name) const {
+    if (sealed_) {
+        return std::binary_search(names_.begin(), names_.end(), name);
+    }
+    return std::find(names_.begin(), names_.end(), name) != names_.end();
+}
+
+ArenaStats AutosAnalyzer::arenaStats() const {
+    ArenaStats stats;
+    stats.modules = arena_modules_;
+    stats.allocations = arena_counter_.allocations;
+    stats.bytes = arena_counter_.bytes;
+    stats.heap_allocations = heap_counter_.allocations;
+    stats.peak_module_bytes = arena_peak_bytes_;
+    stats += worker_arena_stats_;
+    return stats;
 }
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -55,31 +129,221 @@ void AutosAnalyzer::analyze(const std::shared_ptr<SyntaxTree>& tree,
     autoinst_count_ = 0;
     autologic_count_ = 0;
     autoports_count_ = 0;
+    cancelled_ = false;
+    stopped_early_ = false;
+    submodule_types_.clear();
     source_content_ = source_content;
 
     auto& root = tree->root();
 
+    ModuleList modules;
     if (root.kind == SyntaxKind::CompilationUnit) {
         auto& cu = root.as<CompilationUnitSyntax>();
         for (auto* member : cu.members) {
             if (member->kind == SyntaxKind::ModuleDeclaration) {
-                processModule(member->as<ModuleDeclarationSyntax>());
+                modules.push_back(&member->as<ModuleDeclarationSyntax>());
             }
         }
     } else if (root.kind == SyntaxKind::ModuleDeclaration) {
-        processModule(root.as<ModuleDeclarationSyntax>());
+        modules.push_back(&root.as<ModuleDeclarationSyntax>());
+    }
+
+    unsigned jobs = options_.jobs != 0 ? options_.jobs
+                                       : std::max(1u, std::thread::hardware_concurrency());
+    if (jobs > 1 && modules.size() > 1) {
+        analyzeParallel(modules, static_cast<unsigned>(std::min<size_t>(jobs, modules.size())));
+        return;
+    }
+
+    for (size_t i = 0; i < modules.size(); ++i) {
+        bool skip = false;
+        if (!admitModule(modules, i, skip)) {
+            return;
+        }
+        if (!skip) {
+            size_t first = replacements_.size();
+            processModule(*modules[i]);
+            if (options_.stop_at_first_change && i + 1 < modules.size() && changesSource(first)) {
+                stopped_early_ = true;
+                return;
+            }
+        }
+    }
+}
+
+bool AutosAnalyzer::changesSource(size_t first) const {
+    for (size_t i = first; i < replacements_.size(); ++i) {
+        const auto& repl = replacements_[i];
+        if (repl.start > repl.end || repl.end > source_content_.size()) {
+            continue;  // Skipped by the writer as well
+        }
+        if (differsIgnoringWhitespace(source_content_.substr(repl.start, repl.end - repl.start),
+                                      repl.new_text)) {
+            return true;
+        }
     }
+    return false;
+}
+
+bool AutosAnalyzer::admitModule(const ModuleList& modules, size_t index, bool& skip) {
+    const auto& module = *modules[index];
+    if (options_.progress) {
+        ProgressEvent event{ExpansionPhase::Analyze, module.header->name.valueText(),
+                            index, modules.size()};
+        if (!options_.progress(event)) {
+            cancelled_ = true;
+            return false;
+        }
+    }
+    if (options_.module_filter) {
+        auto range = module.sourceRange();
+        ModuleSpan span{module.header->name.valueText(),
+                        range.start().offset(), range.end().offset()};
+        skip = !options_.module_filter(span);
+    }
+    return true;
+}
+
+void AutosAnalyzer::analyzeParallel(const ModuleList& modules, unsigned jobs) {
+    // Output of one module, merged in module order after all workers finish
+    struct ModuleOutput {
+        std::vector<Replacement> replacements;
+        DiagnosticCollector diagnostics;
+        int autoinst_count = 0;
+        int autologic_count = 0;
+        int autoports_count = 0;
+    };
+    std::vector<ModuleOutput> outputs(modules.size());
+    std::vector<ArenaStats> worker_stats(jobs);
+    std::vector<MatcherStats> worker_matcher_stats(jobs);
+    std::vector<std::vector<std::string>> worker_submodule_types(jobs);
+
+    // Modules are claimed in order under claim_mutex, which also guards the
+    // progress and filter callbacks, so progress events and the cancellation
+    // point are the same as in a sequential run.
+    std::mutex claim_mutex;
+    std::mutex port_mutex;
+    size_t next = 0;
+    bool stop = false;
+
+    PortCache& cache = options_.port_cache ? *options_.port_cache : own_port_cache_;
+
+    auto work = [&](unsigned worker_index) {
+        AutosAnalyzerOptions worker_options = options_;
+        worker_options.jobs = 1;
+        worker_options.progress = nullptr;
+        worker_options.module_filter = nullptr;
+        worker_options.port_cache = &cache;
+        AutosAnalyzer worker(compilation_, templates_, worker_options);
+        worker.port_mutex_ = &port_mutex;
+        worker.source_content_ = source_content_;
+
+        while (true) {
+            size_t index = 0;
+            {
+                std::lock_guard<std::mutex> lock(claim_mutex);
+                if (stop || next == modules.size()) break;
+                index = next++;
+                bool skip = false;
+                if (!admitModule(modules, index, skip)) {
+                    stop = true;
+                    break;
+                }
+                if (skip) continue;
+            }
+
+            auto& out = outputs[index];
+            worker.options_.diagnostics = &out.diagnostics;
+            worker.processModule(*modules[index]);
+            if (options_.stop_at_first_change && worker.changesSource(0)) {
+                std::lock_guard<std::mutex> lock(claim_mutex);
+                stopped_early_ = stopped_early_ || next < modules.size();
+                stop = true;
+            }
+            out.replacements = std::exchange(worker.replacements_, {});
+            out.autoinst_count = std::exchange(worker.autoinst_count_, 0);
+            out.autologic_count = std::exchange(worker.autologic_count_, 0);
+            out.autoports_count = std::exchange(worker.autoports_count_, 0);
+        }
+        worker_stats[worker_index] = worker.arenaStats();
+        worker_matcher_stats[worker_index] = worker.matcherStats();
+        worker_submodule_types[worker_index] = std::move(worker.submodule_types_);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(jobs - 1);
+    for (unsigned w = 1; w < jobs; ++w) {
+        threads.emplace_back(work, w);
+    }
+    work(0);
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // Deterministic merge: module order, as a sequential run would produce
+    for (auto& out : outputs) {
+        replacements_.insert(replacements_.end(),
+                             std::make_move_iterator(out.replacements.begin()),
+                             std::make_move_iterator(out.replacements.end()));
+        autoinst_count_ += out.autoinst_count;
+        autologic_count_ += out.autologic_count;
+        autoports_count_ += out.autoports_count;
+        if (options_.diagnostics) {
+            options_.diagnostics->merge(out.diagnostics);
+        }
+    }
+    for (const auto& stats : worker_stats) {
+        worker_arena_stats_ += stats;
+    }
+    for (const auto& stats : worker_matcher_stats) {
+        matcher_stats_ += stats;
+    }
+    for (auto& types : worker_submodule_types) {
+        submodule_types_.insert(submodule_types_.end(),
+                                std::make_move_iterator(types.begin()),
+                                std::make_move_iterator(types.end()));
+    }
+}
+
+std::vector<std::string> AutosAnalyzer::submoduleTypes() const {
+    std::vector<std::string> types = submodule_types_;
+    std::sort(types.begin(), types.end());
+    types.erase(std::unique(types.begin(), types.end()), types.end());
+    return types;
 }
 
 void AutosAnalyzer::processModule(const ModuleDeclarationSyntax& module) {
-    CollectedInfo info = collectModuleInfo(module);
+    TimeTraceScope trace("Module", module.header->name.valueText());
+
+    // Everything allocated from the arena belongs to the previous module's
+    // CollectedInfo, which has already been destroyed.
+    arena_.release();
+    size_t bytes_before = arena_counter_.bytes;
+    ++arena_modules_;
+
+    CollectedInfo info = [&] {
+        TimeTraceScope phase("Collect");
+        return collectModuleInfo(module);
+    }();
+    arena_peak_bytes_ = std::max(arena_peak_bytes_, arena_counter_.bytes - bytes_before);
 
     if (info.autoinsts.empty() && !info.has_autologic && !info.has_autoports) {
         return;
     }
 
-    resolvePortsAndSignals(module, info);
-    generateReplacements(module, info);
+    {
+        TimeTraceScope phase("Resolve");
+        resolvePortsAndSignals(module, info);
+    }
+    {
+        TimeTraceScope phase("Generate");
+        generateReplacements(module, info);
+    }
+
+    for (const auto& group : info.inst_groups) {
+        matcher_stats_ += group.matcher.stats();
+        submodule_types_.push_back(group.module_type);
+    }
 }
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -162,102 +426,11 @@ void AutosAnalyzer::processMemberRecursive(
     }
 
     // ─────────────────────────────────────────────────────────────────────────
-    // AUTOINST - find marker in port list, get close paren position
+    // Instantiations - each instance in the list is either an AUTOINST or a
+    // manual instance (collected for signal direction tracking)
     // ─────────────────────────────────────────────────────────────────────────
-    if (hasMarker(*member, std::string(markers::AUTOINST))) {
-        AutoInstInfo inst_info;
-        inst_info.node = member;
-
-        if (auto inst = extractInstanceInfo(*member)) {
-            inst_info.module_type = inst->first;
-            inst_info.instance_name = inst->second;
-
-            // Get line number of instance for template lookup
-            // (verilog-mode uses closest preceding template)
-            auto& hier = member->as<HierarchyInstantiationSyntax>();
-            size_t inst_offset = hier.type.location().offset();
-            size_t inst_line = 1;
-            for (size_t i = 0; i < inst_offset && i < source_content_.size(); ++i) {
-                if (source_content_[i] == '\n') ++inst_line;
-            }
-            inst_info.templ = findTemplate(inst_info.module_type, inst_line);
-
-            // Get positions from AST
-            // HierarchyInstantiationSyntax has: type, parameters, instances, semi
-            // HierarchicalInstanceSyntax has: decl, openParen, connections, closeParen
-            if (!hier.instances.empty()) {
-                auto& first_inst = *hier.instances[0];
-
-                // Close paren position from AST
-                inst_info.close_paren_pos = first_inst.closeParen.location().offset();
-
-                // Find AUTOINST marker in the instance (port list area)
-                if (auto pos = findMarkerInNode(first_inst, markers::AUTOINST)) {
-                    inst_info.marker_end = pos->second;
-                }
-
-                // Collect manual ports (before the marker)
-                for (auto* conn : first_inst.connections) {
-                    // Check if we've hit the marker
-                    if (auto tok = conn->getFirstToken(); tok.valid()) {
-                        if (hasMarkerInTokenTrivia(tok, std::string(markers::AUTOINST))) {
-                            break;  // Stop collecting manual ports
-                        }
-                    }
-                    // Extract port name from .port(signal) syntax
-                    if (conn->kind == SyntaxKind::NamedPortConnection) {
-                        auto& named = conn->as<NamedPortConnectionSyntax>();
-                        inst_info.manual_ports.insert(std::string(named.name.valueText()));
-                    }
-                }
-            }
-
-            if (inst_info.marker_end > 0 && inst_info.close_paren_pos > 0) {
-                info.autoinsts.push_back(inst_info);
-            }
-        }
-    }
-    // ─────────────────────────────────────────────────────────────────────────
-    // Manual instances (no AUTOINST) - collect for signal direction tracking
-    // ─────────────────────────────────────────────────────────────────────────
-    else if (member->kind == SyntaxKind::HierarchyInstantiation) {
-        auto& hier = member->as<HierarchyInstantiationSyntax>();
-        if (!hier.instances.empty()) {
-            ManualInstInfo manual_info;
-            manual_info.node = &hier;
-            manual_info.module_type = std::string(hier.type.valueText());
-
-            auto& first_inst = *hier.instances[0];
-            if (first_inst.decl) {
-                manual_info.instance_name = std::string(first_inst.decl->name.valueText());
-            }
-
-            // Extract port connections directly from AST
-            for (auto* conn : first_inst.connections) {
-                if (conn->kind == SyntaxKind::NamedPortConnection) {
-                    auto& named = conn->as<NamedPortConnectionSyntax>();
-                    std::string port_name = std::string(named.name.valueText());
-
-                    if (!port_name.empty()) {
-                        CollectedPortConnection port_conn;
-                        port_conn.port_name = port_name;
-
-                        if (named.expr) {
-                            // Keep string form for output generation
-                            port_conn.signal_expr = named.expr->toString();
-                            // Extract identifiers directly from AST - no re-parsing needed
-                            port_conn.signal_identifiers = extractIdentifiersFromSyntax(*named.expr);
-                        }
-
-                        manual_info.port_connections.push_back(std::move(port_conn));
-                    }
-                }
-            }
-
-            if (!manual_info.instance_name.empty()) {
-                info.manual_insts.push_back(manual_info);
-            }
-        }
+    if (member->kind == SyntaxKind::HierarchyInstantiation) {
+        collectInstantiation(member->as<HierarchyInstantiationSyntax>(), info);
     }
 
     // ─────────────────────────────────────────────────────────────────────────
@@ -314,17 +487,20 @@ void AutosAnalyzer::processMemberRecursive(
             if (expr->kind == SyntaxKind::AssignmentExpression) {
                 auto& binary = expr->as<BinaryExpressionSyntax>();
 
-                // Extract all identifiers from LHS - these are driven internally
-                auto lhs_signals = extractIdentifiersFromSyntax(*binary.left);
-                for (const auto& sig : lhs_signals) {
+                // Extract all identifiers from LHS - these are driven internally.
+                // Like the declared names, they are views into the syntax tree.
+                identifier_scratch_.clear();
+                extractIdentifierViewsFromSyntax(*binary.left, identifier_scratch_);
+                for (auto sig : identifier_scratch_) {
                     info.assign_driven.insert(sig);
                 }
 
                 // Extract all identifiers from RHS - these are consumed internally
                 // This prevents instance outputs that feed into assign from becoming
                 // external output ports (they're consumed locally)
-                auto rhs_signals = extractIdentifiersFromSyntax(*binary.right);
-                for (const auto& sig : rhs_signals) {
+                identifier_scratch_.clear();
+                extractIdentifierViewsFromSyntax(*binary.right, identifier_scratch_);
+                for (auto sig : identifier_scratch_) {
                     info.assign_consumed.insert(sig);
                 }
             }
@@ -341,14 +517,15 @@ void AutosAnalyzer::processMemberRecursive(
         auto& netDecl = member->as<NetDeclarationSyntax>();
         for (auto* declarator : netDecl.declarators) {
             // The declarator name is driven by the initializer (if any)
-            std::string net_name(declarator->name.valueText());
+            std::string_view net_name = declarator->name.valueText();
             if (!net_name.empty() && declarator->initializer) {
                 // The net itself is driven internally
                 info.assign_driven.insert(net_name);
 
                 // Extract signals from the initializer expression - these are consumed
-                auto init_signals = extractIdentifiersFromSyntax(*declarator->initializer);
-                for (const auto& sig : init_signals) {
+                identifier_scratch_.clear();
+                extractIdentifierViewsFromSyntax(*declarator->initializer, identifier_scratch_);
+                for (auto sig : identifier_scratch_) {
                     // Don't add the net name itself as consumed
                     if (sig != net_name) {
                         info.assign_consumed.insert(sig);
@@ -365,14 +542,15 @@ void AutosAnalyzer::processMemberRecursive(
     if (member->kind == SyntaxKind::DataDeclaration) {
         auto& dataDecl = member->as<DataDeclarationSyntax>();
         for (auto* declarator : dataDecl.declarators) {
-            std::string var_name(declarator->name.valueText());
+            std::string_view var_name = declarator->name.valueText();
             if (!var_name.empty() && declarator->initializer) {
                 // The variable itself is driven internally
                 info.assign_driven.insert(var_name);
 
                 // Extract signals from the initializer expression - these are consumed
-                auto init_signals = extractIdentifiersFromSyntax(*declarator->initializer);
-                for (const auto& sig : init_signals) {
+                identifier_scratch_.clear();
+                extractIdentifierViewsFromSyntax(*declarator->initializer, identifier_scratch_);
+                for (auto sig : identifier_scratch_) {
                     if (sig != var_name) {
                         info.assign_consumed.insert(sig);
                     }
@@ -382,9 +560,118 @@ void AutosAnalyzer::processMemberRecursive(
     }
 }
 
+void AutosAnalyzer::collectInstantiation(const HierarchyInstantiationSyntax& hier,
+                                         CollectedInfo& info) {
+    std::string module_type(hier.type.valueText());
+    if (module_type.empty() || hier.instances.empty()) return;
+
+    // Find AUTOINST markers first, so the template is only looked up when
+    // at least one instance in the list needs it.
+    // HierarchyInstantiationSyntax has: type, parameters, instances, semi
+    // HierarchicalInstanceSyntax has: decl, openParen, connections, closeParen
+    std::vector<size_t> marker_ends(hier.instances.size(), 0);
+    bool any_autoinst = false;
+    for (size_t i = 0; i < hier.instances.size(); ++i) {
+        if (auto pos = findMarkerInNode(*hier.instances[i], markers::AUTOINST)) {
+            marker_ends[i] = pos->second;
+            any_autoinst = true;
+        }
+    }
+
+    const AutoTemplate* templ = nullptr;
+    if (any_autoinst) {
+        // Get line number of instance for template lookup
+        // (verilog-mode uses closest preceding template)
+        size_t inst_offset = hier.type.location().offset();
+        size_t inst_line = 1;
+        for (size_t i = 0; i < inst_offset && i < source_content_.size(); ++i) {
+            if (source_content_[i] == '\n') ++inst_line;
+        }
+        templ = findTemplate(module_type, inst_line);
+    }
+
+    // One group per statement: ports and template matcher are shared by all
+    // instances in the list
+    size_t group = info.inst_groups.size();
+    info.inst_groups.emplace_back(std::move(module_type), templ);
+    bool group_used = false;
+
+    for (size_t i = 0; i < hier.instances.size(); ++i) {
+        auto& inst = *hier.instances[i];
+        if (!inst.decl) continue;
+        std::string instance_name(inst.decl->name.valueText());
+        if (instance_name.empty()) continue;
+
+        if (marker_ends[i] > 0) {
+            AutoInstInfo inst_info(&arena_counter_);
+            inst_info.node = &hier;
+            inst_info.group = group;
+            inst_info.instance_name = std::move(instance_name);
+            inst_info.marker_end = marker_ends[i];
+            // Replace from marker end to this instance's close paren
+            inst_info.close_paren_pos = inst.closeParen.location().offset();
+
+            // Collect manual ports (before the marker)
+            for (auto* conn : inst.connections) {
+                // Check if we've hit the marker
+                if (auto tok = conn->getFirstToken(); tok.valid()) {
+                    if (hasMarkerInTokenTrivia(tok, markers::AUTOINST)) {
+                        break;  // Stop collecting manual ports
+                    }
+                }
+                // Extract port name from .port(signal) syntax
+                if (conn->kind == SyntaxKind::NamedPortConnection) {
+                    auto& named = conn->as<NamedPortConnectionSyntax>();
+                    inst_info.manual_ports.insert(named.name.valueText());
+                }
+            }
+            inst_info.manual_ports.seal();
+
+            if (inst_info.close_paren_pos > 0) {
+                info.autoinsts.push_back(std::move(inst_info));
+                group_used = true;
+            }
+        } else {
+            ManualInstInfo manual_info;
+            manual_info.node = &hier;
+            manual_info.group = group;
+            manual_info.instance_name = std::move(instance_name);
+
+            // Extract port connections directly from AST
+            for (auto* conn : inst.connections) {
+                if (conn->kind == SyntaxKind::NamedPortConnection) {
+                    auto& named = conn->as<NamedPortConnectionSyntax>();
+                    std::string port_name = std::string(named.name.valueText());
+
+                    if (!port_name.empty()) {
+                        CollectedPortConnection port_conn;
+                        port_conn.port_name = port_name;
+
+                        if (named.expr) {
+                            // Keep string form for output generation
+                            port_conn.signal_expr = named.expr->toString();
+                            // Analyze directly from AST - no re-parsing needed
+                            port_conn.expr = analyzeExpressionSyntax(*named.expr);
+                        }
+
+                        manual_info.port_connections.push_back(std::move(port_conn));
+                    }
+                }
+            }
+
+            info.manual_insts.push_back(std::move(manual_info));
+            group_used = true;
+        }
+    }
+
+    if (!group_used) {
+        info.inst_groups.pop_back();
+    }
+}
+
 AutosAnalyzer::CollectedInfo
 AutosAnalyzer::collectModuleInfo(const ModuleDeclarationSyntax& module) {
-    CollectedInfo info;
+    CollectedInfo info(&arena_counter_);
     bool in_autologic_block = false;
 
     for (auto* member : module.members) {
@@ -438,7 +725,7 @@ AutosAnalyzer::collectModuleInfo(const ModuleDeclarationSyntax& module) {
                     // Port before marker - track name for filtering
                     if (port->kind == SyntaxKind::ImplicitAnsiPort) {
                         auto& implicit = port->as<ImplicitAnsiPortSyntax>();
-                        std::string name = std::string(implicit.declarator->name.valueText());
+                        std::string_view name = implicit.declarator->name.valueText();
                         info.autoports.existing_ports.insert(name);
                         info.existing_decls.insert(name);
                     }
@@ -447,6 +734,10 @@ AutosAnalyzer::collectModuleInfo(const ModuleDeclarationSyntax& module) {
         }
     }
 
+    info.existing_decls.seal();
+    info.assign_driven.seal();
+    info.assign_consumed.seal();
+    info.autoports.existing_ports.seal();
     return info;
 }
 
@@ -498,10 +789,6 @@ AutosAnalyzer::findMarkerInTrivia(Token tok, std::string_view marker) const {
     return std::nullopt;
 }
 
-bool AutosAnalyzer::hasMarker(const SyntaxNode& node, std::string_view marker) const {
-    return node.toString().find(marker) != std::string::npos;
-}
-
 std::optional<std::pair<size_t, size_t>>
 AutosAnalyzer::findMarkerInNode(const SyntaxNode& node, std::string_view marker) const {
     // Check all children (both nodes and tokens)
@@ -541,18 +828,23 @@ void AutosAnalyzer::resolvePortsAndSignals(
 
     aggregator_ = SignalAggregator();
 
+    // One port lookup per instantiation statement, shared by its instances
+    for (auto& group : info.inst_groups) {
+        group.submodule = &getModulePorts(group.module_type);
+    }
+
     // Process AUTOINST instances
     for (auto& inst : info.autoinsts) {
-        auto ports = getModulePorts(inst.module_type);
-        if (ports.empty()) continue;
+        auto& group = info.inst_groups[inst.group];
+        if (group.submodule->ports.empty()) continue;
 
-        auto connections = buildConnections(inst, ports);
-        aggregator_.addFromInstance(inst.instance_name, connections, ports);
+        auto connections = buildConnections(inst, group);
+        aggregator_.addFromInstance(inst.instance_name, connections, group.submodule->ports);
     }
 
     // Process manual (non-AUTOINST) instances for signal direction tracking
     for (auto& inst : info.manual_insts) {
-        auto ports = getModulePorts(inst.module_type);
+        const auto& ports = info.inst_groups[inst.group].submodule->ports;
         if (ports.empty()) continue;
 
         // Build connections from the manual port connections
@@ -567,8 +859,9 @@ void AutosAnalyzer::resolvePortsAndSignals(
                 conn.port_name = port_conn.port_name;
                 conn.signal_expr = port_conn.signal_expr;
                 conn.direction = port_it->direction;
-                // Use pre-extracted identifiers from AST traversal
-                conn.signal_identifiers = port_conn.signal_identifiers;
+                // Use pre-analyzed expression from AST traversal
+                conn.signal_identifiers = port_conn.expr.identifiers;
+                conn.max_bit_index = port_conn.expr.max_bit_index;
 
                 // Check for special values
                 if (TemplateMatcher::isSpecialValue(port_conn.signal_expr)) {
@@ -580,9 +873,9 @@ void AutosAnalyzer::resolvePortsAndSignals(
                 }
 
                 // Check if expression is a concatenation - signals inside should be internal
-                conn.is_concatenation = isConcatenation(port_conn.signal_expr);
+                conn.is_concatenation = port_conn.expr.is_concatenation;
 
-                connections.push_back(conn);
+                connections.push_back(std::move(conn));
             }
         }
 
@@ -590,21 +883,32 @@ void AutosAnalyzer::resolvePortsAndSignals(
     }
 }
 
-std::vector<PortInfo> AutosAnalyzer::getModulePorts(const std::string& module_name) {
-    return getModulePortsFromCompilation(
-        compilation_, module_name, options_.diagnostics, options_.strictness);
+const ModulePorts& AutosAnalyzer::getModulePorts(const std::string& module_name) {
+    // Ports are returned by reference from the cache, so instances of the
+    // same module share one port list instead of copying it
+    // Parallel workers share the cache and the Compilation, neither of which
+    // is thread-safe; cached entries are never moved, so the reference stays
+    // valid after the lock is released.
+    std::unique_lock<std::mutex> lock;
+    if (port_mutex_) {
+        lock = std::unique_lock<std::mutex>(*port_mutex_);
+    }
+    PortCache& cache = options_.port_cache ? *options_.port_cache : own_port_cache_;
+    return cache.lookup(compilation_, module_name, options_.diagnostics, options_.strictness,
+                        options_.resolved_ranges);
 }
 
 std::vector<PortConnection> AutosAnalyzer::buildConnections(
     const AutoInstInfo& inst,
-    const std::vector<PortInfo>& ports) {
+    InstGroup& group) {
 
+    const auto& ports = group.submodule->ports;
     std::vector<PortConnection> connections;
-    TemplateMatcher matcher(inst.templ, nullptr);
+    TemplateMatcher& matcher = group.matcher;
     matcher.setInstance(inst.instance_name);
 
     for (const auto& port : ports) {
-        if (inst.manual_ports.count(port.name)) continue;
+        if (inst.manual_ports.contains(port.name)) continue;
 
         PortConnection conn;
         conn.port_name = port.name;
@@ -620,14 +924,17 @@ std::vector<PortConnection> AutosAnalyzer::buildConnections(
                 conn.signal_expr = TemplateMatcher::formatSpecialValue(match.signal_name);
             }
         } else {
-            conn.signal_expr = match.signal_name;
-            // Extract identifiers from template result (parse once here, not in aggregator)
-            conn.signal_identifiers = extractIdentifiers(match.signal_name);
-            // Check if expression is a concatenation - signals inside should be internal
-            conn.is_concatenation = isConcatenation(match.signal_name);
+            // Analyze the template result once per distinct expression text
+            // (not per connection, and not again in the aggregator)
+            const ExpressionInfo& expr = expr_cache_.get(match.signal_name);
+            conn.signal_identifiers = expr.identifiers;
+            conn.max_bit_index = expr.max_bit_index;
+            // Concatenation - signals inside should be internal
+            conn.is_concatenation = expr.is_concatenation;
+            conn.signal_expr = std::move(match.signal_name);
         }
 
-        connections.push_back(conn);
+        connections.push_back(std::move(conn));
     }
 
     return connections;
@@ -639,12 +946,12 @@ std::vector<PortConnection> AutosAnalyzer::buildConnections(
 
 void AutosAnalyzer::generateReplacements(
     const ModuleDeclarationSyntax& module,
-    const CollectedInfo& info) {
+    CollectedInfo& info) {
 
     for (const auto& inst : info.autoinsts) {
-        auto ports = getModulePorts(inst.module_type);
-        if (!ports.empty()) {
-            generateAutoInstReplacement(inst, ports);
+        auto& group = info.inst_groups[inst.group];
+        if (!group.submodule->ports.empty()) {
+            generateAutoInstReplacement(inst, group);
         }
     }
 
@@ -659,17 +966,19 @@ void AutosAnalyzer::generateReplacements(
 
 void AutosAnalyzer::generateAutoInstReplacement(
     const AutoInstInfo& inst,
-    const std::vector<PortInfo>& ports) {
+    InstGroup& group) {
+
+    const auto& ports = group.submodule->ports;
 
     // Count how many ports will be auto-generated (not manually connected)
     size_t auto_port_count = 0;
     for (const auto& port : ports) {
-        if (!inst.manual_ports.count(port.name)) {
+        if (!inst.manual_ports.contains(port.name)) {
             ++auto_port_count;
         }
     }
 
-    std::string port_text = generatePortConnections(inst, ports);
+    std::string port_text = generatePortConnections(inst, group);
 
     // If there are manual ports AND auto ports to generate, check if we need
     // to add a comma between them. Look backwards from AUTOINST marker for the
@@ -741,35 +1050,45 @@ void AutosAnalyzer::generateAutologicReplacement(const CollectedInfo& info) {
         // Re-expansion: replace existing block
         // Note: block_start points to start of "// Beginning...", so the
         // preceding whitespace is preserved - don't add leading indent
-        std::ostringstream oss;
+        std::string text;
         // Note: block_start points to the "// Beginning" marker itself,
         // so any leading whitespace before it is preserved automatically.
         // block_end is right after "// End of automatics" text - the original
         // newline(s) after it are preserved, so we don't add one here.
         if (!decls.empty()) {
-            oss << markers::BEGIN_AUTOLOGIC << "\n";
-            oss << decls;
-            oss << options_.indent << markers::END_AUTOMATICS;
+            text.reserve(markers::BEGIN_AUTOLOGIC.size() + 1 + decls.size() +
+                         options_.indent.size() + markers::END_AUTOMATICS.size());
+            text.append(markers::BEGIN_AUTOLOGIC);
+            text += '\n';
+            text.append(decls);
+            text.append(options_.indent);
+            text.append(markers::END_AUTOMATICS);
         }
         // If decls empty, we remove the block entirely (empty replacement)
 
         replacements_.push_back({
             info.autologic.block_start,
             info.autologic.block_end,
-            oss.str(),
+            std::move(text),
             "AUTOLOGIC re-expansion"
         });
     } else {
         // Fresh expansion: insert after marker
-        std::ostringstream oss;
-        oss << "\n" << options_.indent << markers::BEGIN_AUTOLOGIC << "\n";
-        oss << decls;
-        oss << options_.indent << markers::END_AUTOMATICS;
+        std::string text;
+        text.reserve(1 + options_.indent.size() + markers::BEGIN_AUTOLOGIC.size() + 1 +
+                     decls.size() + options_.indent.size() + markers::END_AUTOMATICS.size());
+        text += '\n';
+        text.append(options_.indent);
+        text.append(markers::BEGIN_AUTOLOGIC);
+        text += '\n';
+        text.append(decls);
+        text.append(options_.indent);
+        text.append(markers::END_AUTOMATICS);
 
         replacements_.push_back({
             info.autologic.marker_end,
             info.autologic.marker_end,
-            oss.str(),
+            std::move(text),
             "AUTOLOGIC expansion"
         });
     }
@@ -795,9 +1114,9 @@ void AutosAnalyzer::generateAutoportsReplacement(
     auto filter_inputs = [&](std::vector<NetInfo>& nets) {
         nets.erase(std::remove_if(nets.begin(), nets.end(),
             [&](const NetInfo& n) {
-                return info.autoports.existing_ports.count(n.name) ||
-                       info.existing_decls.count(n.name) ||
-                       info.assign_driven.count(n.name);
+                return info.autoports.existing_ports.contains(n.name) ||
+                       info.existing_decls.contains(n.name) ||
+                       info.assign_driven.contains(n.name);
             }),
             nets.end());
     };
@@ -807,9 +1126,9 @@ void AutosAnalyzer::generateAutoportsReplacement(
     auto filter_outputs = [&](std::vector<NetInfo>& nets) {
         nets.erase(std::remove_if(nets.begin(), nets.end(),
             [&](const NetInfo& n) {
-                return info.autoports.existing_ports.count(n.name) ||
-                       info.existing_decls.count(n.name) ||
-                       info.assign_consumed.count(n.name);
+                return info.autoports.existing_ports.contains(n.name) ||
+                       info.existing_decls.contains(n.name) ||
+                       info.assign_consumed.contains(n.name);
             }),
             nets.end());
     };
@@ -818,10 +1137,10 @@ void AutosAnalyzer::generateAutoportsReplacement(
     auto filter_inouts = [&](std::vector<NetInfo>& nets) {
         nets.erase(std::remove_if(nets.begin(), nets.end(),
             [&](const NetInfo& n) {
-                return info.autoports.existing_ports.count(n.name) ||
-                       info.existing_decls.count(n.name) ||
-                       info.assign_driven.count(n.name) ||
-                       info.assign_consumed.count(n.name);
+                return info.autoports.existing_ports.contains(n.name) ||
+                       info.existing_decls.contains(n.name) ||
+                       info.assign_driven.contains(n.name) ||
+                       info.assign_consumed.contains(n.name);
             }),
             nets.end());
     };
@@ -830,40 +1149,26 @@ void AutosAnalyzer::generateAutoportsReplacement(
     filter_inouts(inouts);
     filter_inputs(inputs);
 
-    // Build replacement text (goes after marker, before close paren)
-    std::ostringstream oss;
-
-    bool prefer_original = preferOriginalSyntax();
-    const char* net_kw = netTypeKeyword(options_.net_type);
-    auto fmt = [prefer_original, net_kw](const std::string& dir, const NetInfo& n) {
-        std::ostringstream p;
-        p << dir << " " << net_kw;
-        if (!n.getRangeStr(prefer_original).empty()) p << " " << n.getRangeStr(prefer_original);
-        p << " " << n.name;
-        // Add unpacked array dimensions after the name
-        if (!n.getArrayDims().empty()) p << n.getArrayDims();
-        return p.str();
-    };
-
     // Order ports according to options_.grouping.
     // Mirrors generatePortConnections() for AUTOINST so both macros stay consistent.
-    std::vector<std::pair<std::string, NetInfo>> all_ports;
+    std::vector<std::pair<PortDirection, const NetInfo*>> all_ports;
+    all_ports.reserve(outputs.size() + inouts.size() + inputs.size());
     switch (options_.grouping) {
         case PortGrouping::Alphabetical: {
-            for (const auto& n : outputs) all_ports.emplace_back("output", n);
-            for (const auto& n : inouts)  all_ports.emplace_back("inout",  n);
-            for (const auto& n : inputs)  all_ports.emplace_back("input",  n);
+            for (const auto& n : outputs) all_ports.emplace_back(PortDirection::Output, &n);
+            for (const auto& n : inouts)  all_ports.emplace_back(PortDirection::Inout,  &n);
+            for (const auto& n : inputs)  all_ports.emplace_back(PortDirection::Input,  &n);
             std::sort(all_ports.begin(), all_ports.end(),
-                [](const auto& a, const auto& b) { return a.second.name < b.second.name; });
+                [](const auto& a, const auto& b) { return a.second->name < b.second->name; });
             break;
         }
         case PortGrouping::ByDeclaration: {
-            for (const auto& n : outputs) all_ports.emplace_back("output", n);
-            for (const auto& n : inouts)  all_ports.emplace_back("inout",  n);
-            for (const auto& n : inputs)  all_ports.emplace_back("input",  n);
+            for (const auto& n : outputs) all_ports.emplace_back(PortDirection::Output, &n);
+            for (const auto& n : inouts)  all_ports.emplace_back(PortDirection::Inout,  &n);
+            for (const auto& n : inputs)  all_ports.emplace_back(PortDirection::Input,  &n);
             std::stable_sort(all_ports.begin(), all_ports.end(),
                 [](const auto& a, const auto& b) {
-                    return a.second.first_seen_order < b.second.first_seen_order;
+                    return a.second->first_seen_order < b.second->first_seen_order;
                 });
             break;
         }
@@ -876,9 +1181,9 @@ void AutosAnalyzer::generateAutoportsReplacement(
             std::sort(outputs.begin(), outputs.end(), sort_by_name);
             std::sort(inouts.begin(),  inouts.end(),  sort_by_name);
             std::sort(inputs.begin(),  inputs.end(),  sort_by_name);
-            for (const auto& n : outputs) all_ports.emplace_back("output", n);
-            for (const auto& n : inouts)  all_ports.emplace_back("inout",  n);
-            for (const auto& n : inputs)  all_ports.emplace_back("input",  n);
+            for (const auto& n : outputs) all_ports.emplace_back(PortDirection::Output, &n);
+            for (const auto& n : inouts)  all_ports.emplace_back(PortDirection::Inout,  &n);
+            for (const auto& n : inputs)  all_ports.emplace_back(PortDirection::Input,  &n);
             break;
         }
     }
@@ -904,19 +1209,38 @@ void AutosAnalyzer::generateAutoportsReplacement(
         }
     }
 
-    // Generate port list with commas between items
+    // Generate port list with commas between items. Ranges are resolved once
+    // and used both to size the buffer and to write it.
+    bool prefer_original = preferOriginalSyntax();
+    std::string_view net_kw = netTypeKeyword(options_.net_type);
+    constexpr std::string_view port_indent = "\n    ";
+
+    std::vector<std::string> ranges;
+    ranges.reserve(all_ports.size());
+    size_t total = needs_leading_comma ? 2 : 1;
+    for (const auto& [dir, net] : all_ports) {
+        ranges.push_back(net->getRangeStr(prefer_original));
+        total += port_indent.size() + toString(dir).size() + 1 +
+                 netDeclLength(net_kw, ranges.back(), *net) + 1;
+    }
+
+    std::string text;
+    text.reserve(total);
     for (size_t i = 0; i < all_ports.size(); ++i) {
         const auto& [dir, net] = all_ports[i];
         // Add comma before first port if needed
         if (i == 0 && needs_leading_comma) {
-            oss << ",";
+            text += ',';
         }
-        oss << "\n    " << fmt(dir, net);
-        if (i < all_ports.size() - 1) oss << ",";
+        text.append(port_indent);
+        text.append(toString(dir));
+        text += ' ';
+        appendNetDecl(text, net_kw, ranges[i], *net);
+        if (i < all_ports.size() - 1) text += ',';
     }
 
     if (!all_ports.empty()) {
-        oss << "\n";
+        text += '\n';
     }
 
     // Determine replacement start position
@@ -962,7 +1286,7 @@ void AutosAnalyzer::generateAutoportsReplacement(
     replacements_.push_back({
         replacement_start,
         info.autoports.close_paren_pos,
-        oss.str(),
+        std::move(text),
         "AUTOPORTS"
     });
 
@@ -975,148 +1299,136 @@ void AutosAnalyzer::generateAutoportsReplacement(
 
 std::string AutosAnalyzer::generatePortConnections(
     const AutoInstInfo& inst,
-    const std::vector<PortInfo>& ports) {
+    InstGroup& group) {
+
+    const auto& ports = group.submodule->ports;
 
     std::string indent = detectIndent(*inst.node);
     // Port connections get one additional indent level
     std::string port_indent = indent + indent;
 
-    TemplateMatcher matcher(inst.templ, nullptr);
+    TemplateMatcher& matcher = group.matcher;
     matcher.setInstance(inst.instance_name);
 
-    // Filter to auto-connected ports
-    std::vector<const PortInfo*> auto_ports;
-    for (const auto& port : ports) {
-        if (!inst.manual_ports.count(port.name)) {
-            auto_ports.push_back(&port);
-        }
-    }
-
-    std::ostringstream oss;
-
-    if (auto_ports.empty()) {
-        oss << "\n" << indent;
-        return oss.str();
-    }
-
-    // Find max port name length for alignment
-    size_t max_len = 0;
-    if (options_.alignment) {
-        for (const auto* p : auto_ports) {
-            max_len = std::max(max_len, p->name.length());
-        }
+    // Walk the submodule's precomputed order for the grouping mode, skipping
+    // manually connected ports, instead of sorting per instance
+    const std::vector<uint32_t>* order = nullptr;
+    if (options_.grouping == PortGrouping::Alphabetical) {
+        order = &group.submodule->alphabetical;
+    } else if (options_.grouping == PortGrouping::ByDirection) {
+        order = &group.submodule->by_direction;
     }
 
-    // Group/sort ports based on grouping option
     std::vector<const PortInfo*> sorted_ports;
-    if (options_.grouping == PortGrouping::Alphabetical) {
-        sorted_ports = auto_ports;
-        std::sort(sorted_ports.begin(), sorted_ports.end(),
-            [](const PortInfo* a, const PortInfo* b) { return a->name < b->name; });
-    } else if (options_.grouping == PortGrouping::ByDeclaration) {
-        sorted_ports = auto_ports;
-    } else {
-        // ByDirection: outputs, inouts, inputs
-        for (const auto* p : auto_ports) {
-            if (p->direction == "output") sorted_ports.push_back(p);
-        }
-        for (const auto* p : auto_ports) {
-            if (p->direction == "inout") sorted_ports.push_back(p);
-        }
-        for (const auto* p : auto_ports) {
-            if (p->direction == "input") sorted_ports.push_back(p);
+    sorted_ports.reserve(ports.size());
+    size_t max_len = 0;  // Max port name length for alignment
+    for (size_t i = 0; i < ports.size(); ++i) {
+        const auto& port = ports[order ? (*order)[i] : i];
+        if (inst.manual_ports.contains(port.name)) continue;
+        sorted_ports.push_back(&port);
+        if (options_.alignment) {
+            max_len = std::max(max_len, port.name.length());
         }
     }
 
-    oss << "\n";
+    if (sorted_ports.empty()) {
+        return "\n" + indent;
+    }
 
-    // Build port connection strings (without direction comments) for potential alignment
+    // First pass: resolve each port's signal and measure its line, so the
+    // output can be written into a single pre-sized buffer.
     struct PortLine {
-        std::string prefix;     // Group comment line (e.g., "    // Outputs\n"), empty if none
-        std::string connection; // Port connection text (e.g., ".clk (clk),")
-        std::string direction;  // "input", "output", "inout"
+        const PortInfo* port = nullptr;
+        std::string_view group;  // Group comment (e.g. "Outputs"), empty if none
+        std::string signal;      // Connected signal, empty when unconnected
+        size_t length = 0;       // Connection text length (indent through comma)
     };
     std::vector<PortLine> port_lines;
     port_lines.reserve(sorted_ports.size());
 
-    std::string current_dir;
+    std::optional<PortDirection> current_dir;
     size_t max_connection_len = 0;
+    size_t total = 1 + indent.size();
 
     for (size_t i = 0; i < sorted_ports.size(); ++i) {
         const auto* port = sorted_ports[i];
         auto match = matcher.matchPort(*port);
 
         PortLine pl;
-        pl.direction = port->direction;
+        pl.port = port;
 
         // Direction group comment
         if (options_.grouping == PortGrouping::ByDirection && port->direction != current_dir) {
             current_dir = port->direction;
-            std::string comment = (current_dir == "output") ? "Outputs" :
-                                  (current_dir == "inout") ? "Inouts" : "Inputs";
-            pl.prefix = port_indent + "// " + comment + "\n";
+            pl.group = (current_dir == PortDirection::Output) ? "Outputs" :
+                       (current_dir == PortDirection::Inout) ? "Inouts" : "Inputs";
+            total += port_indent.size() + 3 + pl.group.size() + 1;
         }
 
-        // Build connection text
-        std::ostringstream conn;
-        conn << port_indent;
-
-        if (TemplateMatcher::isSpecialValue(match.signal_name) && match.signal_name == "_") {
-            if (options_.alignment) {
-                conn << "." << std::left << std::setw(static_cast<int>(max_len))
-                     << port->name << " ()";
-            } else {
-                conn << "." << port->name << " ()";
-            }
-        } else {
+        if (!(TemplateMatcher::isSpecialValue(match.signal_name) && match.signal_name == "_")) {
             std::string signal = TemplateMatcher::isSpecialValue(match.signal_name)
                 ? TemplateMatcher::formatSpecialValue(match.signal_name)
                 : match.signal_name;
 
-            signal = adaptSignalWidth(signal, *port, match, inst.instance_name);
-
-            if (options_.alignment) {
-                conn << "." << std::left << std::setw(static_cast<int>(max_len))
-                     << port->name << " (" << signal << ")";
-            } else {
-                conn << "." << port->name << " (" << signal << ")";
-            }
-        }
-
-        if (i < sorted_ports.size() - 1) {
-            conn << ",";
+            pl.signal = adaptSignalWidth(signal, *port, match, inst.instance_name);
         }
 
-        pl.connection = conn.str();
+        // "<indent>.<name padded to max_len> (<signal>)[,]"
+        pl.length = port_indent.size() + 1 + std::max(max_len, port->name.size()) +
+                    2 + pl.signal.size() + 1 + (i < sorted_ports.size() - 1 ? 1 : 0);
         if (options_.direction_comments.has_value()) {
-            max_connection_len = std::max(max_connection_len, pl.connection.length());
+            max_connection_len = std::max(max_connection_len, pl.length);
         }
+        total += pl.length + 1;
 
         port_lines.push_back(std::move(pl));
     }
 
-    // Output port lines, with optional direction comments
-    for (const auto& pl : port_lines) {
-        if (!pl.prefix.empty()) {
-            oss << pl.prefix;
+    const DirectionComments* dc = options_.direction_comments ? &*options_.direction_comments
+                                                               : nullptr;
+    if (dc) {
+        size_t max_arrow = std::max({dc->output.size(), dc->inout.size(), dc->input.size()});
+        total += port_lines.size() * (max_connection_len + 4 + max_arrow);
+    }
+
+    // Second pass: write the lines, with optional direction comments
+    std::string text;
+    text.reserve(total);
+    text += '\n';
+    for (size_t i = 0; i < port_lines.size(); ++i) {
+        const auto& pl = port_lines[i];
+        if (!pl.group.empty()) {
+            text.append(port_indent);
+            text.append("// ");
+            text.append(pl.group);
+            text += '\n';
         }
-        oss << pl.connection;
-        if (options_.direction_comments.has_value()) {
-            const auto& dc = *options_.direction_comments;
+
+        size_t line_start = text.size();
+        text.append(port_indent);
+        text += '.';
+        appendPadded(text, pl.port->name, max_len);
+        text.append(" (");
+        text.append(pl.signal);
+        text += ')';
+        if (i < port_lines.size() - 1) {
+            text += ',';
+        }
+
+        if (dc) {
             // Pad to align direction comments
-            if (pl.connection.length() < max_connection_len) {
-                oss << std::string(max_connection_len - pl.connection.length(), ' ');
-            }
-            const std::string& arrow = (pl.direction == "output") ? dc.output :
-                                       (pl.direction == "inout")  ? dc.inout :
-                                                                    dc.input;
-            oss << " // " << arrow;
+            appendPadded(text, {}, max_connection_len - (text.size() - line_start));
+            const std::string& arrow = (pl.port->direction == PortDirection::Output) ? dc->output :
+                                       (pl.port->direction == PortDirection::Inout)  ? dc->inout :
+                                                                                        dc->input;
+            text.append(" // ");
+            text.append(arrow);
         }
-        oss << "\n";
+        text += '\n';
     }
 
-    oss << indent;
-    return oss.str();
+    text.append(indent);
+    return text;
 }
 
 std::string AutosAnalyzer::generateAutologicDecls(const CollectedInfo& info) {
@@ -1126,10 +1438,10 @@ std::string AutosAnalyzer::generateAutologicDecls(const CollectedInfo& info) {
     const auto& unused_signals = aggregator_.getUnusedSignals();
 
     std::vector<NetInfo> to_declare;
-    std::set<std::string> already_added;
+    std::set<std::string, std::less<>> already_added;
 
     for (const auto& net : nets) {
-        if (!existing_decls.count(net.name)) {
+        if (!existing_decls.contains(net.name)) {
             to_declare.push_back(net);
             already_added.insert(net.name);
         }
@@ -1137,7 +1449,7 @@ std::string AutosAnalyzer::generateAutologicDecls(const CollectedInfo& info) {
 
     // Also add unused signals (for output width adaptation)
     for (const auto& unused : unused_signals) {
-        if (!existing_decls.count(unused.name) && !already_added.count(unused.name)) {
+        if (!existing_decls.contains(unused.name) && !already_added.count(unused.name)) {
             to_declare.push_back(unused);
             already_added.insert(unused.name);
         }
@@ -1147,14 +1459,14 @@ std::string AutosAnalyzer::generateAutologicDecls(const CollectedInfo& info) {
     // These aren't "internal" by the driven_by_instance && consumed_by_instance rule,
     // but they DO need declarations because they're used by instances.
     for (const auto& sig_name : info.assign_driven) {
-        if (existing_decls.count(sig_name) || already_added.count(sig_name)) {
+        if (existing_decls.contains(sig_name) || already_added.count(sig_name)) {
             continue;  // Already declared or already added
         }
         // Check if this signal is consumed by an instance
-        const NetInfo* net_info = aggregator_.getNetInfo(sig_name);
+        auto net_info = aggregator_.getNetInfo(sig_name);
         if (net_info) {
             to_declare.push_back(*net_info);
-            already_added.insert(sig_name);
+            already_added.emplace(sig_name);
         }
     }
 
@@ -1162,37 +1474,40 @@ std::string AutosAnalyzer::generateAutologicDecls(const CollectedInfo& info) {
     // These are internal wires that need declarations.
     // Example: assign sys2aux = {ctrl_sig, ...}; where ctrl_sig is an instance output
     for (const auto& sig_name : info.assign_consumed) {
-        if (existing_decls.count(sig_name) || already_added.count(sig_name)) {
+        if (existing_decls.contains(sig_name) || already_added.count(sig_name)) {
             continue;  // Already declared or already added
         }
         // Check if this signal is driven by an instance (it's in the aggregator)
-        const NetInfo* net_info = aggregator_.getNetInfo(sig_name);
+        auto net_info = aggregator_.getNetInfo(sig_name);
         if (net_info) {
             to_declare.push_back(*net_info);
-            already_added.insert(sig_name);
+            already_added.emplace(sig_name);
         }
     }
 
     if (to_declare.empty()) return "";
 
     bool prefer_original = preferOriginalSyntax();
+    std::string_view net_kw = netTypeKeyword(options_.net_type);
 
-    const char* net_kw = netTypeKeyword(options_.net_type);
-    std::ostringstream oss;
+    // Resolve each range once, size the output, then write it in one pass
+    std::vector<std::string> ranges;
+    ranges.reserve(to_declare.size());
+    size_t total = 0;
     for (const auto& net : to_declare) {
-        oss << options_.indent << net_kw;
-        if (!net.getRangeStr(prefer_original).empty()) {
-            oss << " " << net.getRangeStr(prefer_original);
-        }
-        oss << " " << net.name;
-        // Add unpacked array dimensions after the name
-        if (!net.getArrayDims().empty()) {
-            oss << net.getArrayDims();
-        }
-        oss << ";\n";
+        ranges.push_back(net.getRangeStr(prefer_original));
+        total += options_.indent.size() + netDeclLength(net_kw, ranges.back(), net) + 2;
     }
 
-    return oss.str();
+    std::string text;
+    text.reserve(total);
+    for (size_t i = 0; i < to_declare.size(); ++i) {
+        text.append(options_.indent);
+        appendNetDecl(text, net_kw, ranges[i], to_declare[i]);
+        text.append(";\n");
+    }
+
+    return text;
 }
 
 std::string AutosAnalyzer::adaptSignalWidth(
@@ -1212,7 +1527,7 @@ std::string AutosAnalyzer::adaptSignalWidth(
     }
 
     // Rule 3: Look up aggregated width for this signal
-    const NetInfo* net_info = aggregator_.getNetInfo(signal);
+    auto net_info = aggregator_.getNetInfo(signal);
     if (!net_info) {
         // Signal not in aggregator - return unchanged
         return signal;
@@ -1239,10 +1554,10 @@ std::string AutosAnalyzer::adaptSignalWidth(
 
     // Rule 6: Port wider than signal - pad/extend
     // port_width > aggregated_width
-    if (port.direction == "input") {
+    if (port.direction == PortDirection::Input) {
         // Zero-pad inputs: {'0, signal}
         return "{\'0, " + signal + "}";
-    } else if (port.direction == "output") {
+    } else if (port.direction == PortDirection::Output) {
         // Use unused signal for upper bits
         std::string unused_name = "unused_" + signal + "_" + instance_name;
         int unused_width = port_width - aggregated_width;
@@ -1285,34 +1600,18 @@ std::string AutosAnalyzer::detectIndent(const SyntaxNode& node) const {
 // Other Helpers
 // ════════════════════════════════════════════════════════════════════════════
 
-std::optional<std::pair<std::string, std::string>>
-AutosAnalyzer::extractInstanceInfo(const MemberSyntax& member) const {
-    if (member.kind != SyntaxKind::HierarchyInstantiation) return std::nullopt;
-
-    auto& hier = member.as<HierarchyInstantiationSyntax>();
-    std::string module_type = std::string(hier.type.valueText());
-    if (module_type.empty()) return std::nullopt;
-
-    if (hier.instances.empty()) return std::nullopt;
-    auto& first = *hier.instances[0];
-    if (!first.decl) return std::nullopt;
-
-    std::string inst_name = std::string(first.decl->name.valueText());
-    return std::make_pair(module_type, inst_name);
-}
-
-std::optional<std::string>
+std::optional<std::string_view>
 AutosAnalyzer::extractDeclarationName(const MemberSyntax& member) const {
     if (member.kind == SyntaxKind::DataDeclaration) {
         auto& decl = member.as<DataDeclarationSyntax>();
         if (!decl.declarators.empty()) {
-            return std::string(decl.declarators[0]->name.valueText());
+            return decl.declarators[0]->name.valueText();
         }
     }
     if (member.kind == SyntaxKind::NetDeclaration) {
         auto& decl = member.as<NetDeclarationSyntax>();
         if (!decl.declarators.empty()) {
-            return std::string(decl.declarators[0]->name.valueText());
+            return decl.declarators[0]->name.valueText();
         }
     }
     return std::nullopt;
@@ -1,17 +1,24 @@
 #include "slang-autos/CompilationUtils.h"
+#include "slang-autos/PortSnapshot.h"
 
 #include "slang/ast/Compilation.h"
 #include "slang/ast/symbols/BlockSymbols.h"
 #include "slang/ast/symbols/CompilationUnitSymbols.h"
 #include "slang/ast/symbols/InstanceSymbols.h"
+#include "slang/ast/symbols/ParameterSymbols.h"
 #include "slang/ast/symbols/PortSymbols.h"
 #include "slang/ast/types/Type.h"
 #include "slang/ast/types/AllTypes.h"
 #include "slang/ast/types/DeclaredType.h"
 #include "slang/syntax/AllSyntax.h"
+#include "slang/syntax/SyntaxTree.h"
+#include "slang/syntax/SyntaxVisitor.h"
 #include "slang/text/SourceManager.h"
 
+#include <algorithm>
+#include <cctype>
 #include <functional>
+#include <numeric>
 #include <sstream>
 
 namespace slang_autos {
@@ -203,13 +210,87 @@ std::string extractOriginalDimensions(const PortSymbol& portSym, const slang::So
     return result;
 }
 
+/// Ports of an elaborated module body, as PortInfo
+std::vector<PortInfo> portsFromBody(const InstanceBodySymbol& body,
+                                    const slang::SourceManager& sm,
+                                    const std::string& module_name,
+                                    DiagnosticCollector* diagnostics) {
+    std::vector<PortInfo> ports;
+
+    // Extract ports from the body's port list
+    for (auto* port : body.getPortList()) {
+        PortInfo info;
+        info.name = std::string(port->name);
+
+        // Empty port name indicates a parsing failure (e.g., undefined macros)
+        if (info.name.empty()) {
+            if (diagnostics) {
+                diagnostics->addError(
+                    "Port with empty name in module '" + module_name +
+                    "' (likely caused by undefined macros in port declaration). "
+                    "Ensure all required macros are defined via +define+ or include files.",
+                    "", 0, "port_parse");
+            }
+            return {};  // Return empty - caller will handle the error
+        }
+
+        if (auto* portSym = port->as_if<PortSymbol>()) {
+            switch (portSym->direction) {
+                case ArgumentDirection::In:
+                    info.direction = PortDirection::Input;
+                    break;
+                case ArgumentDirection::Out:
+                    info.direction = PortDirection::Output;
+                    break;
+                case ArgumentDirection::InOut:
+                    info.direction = PortDirection::Inout;
+                    break;
+                default:
+                    info.direction = PortDirection::Input;
+                    break;
+            }
+
+            auto& type = portSym->getType();
+
+            // For unpacked arrays, we need to get the element type for packed dimensions
+            // e.g., logic [7:0] data [3:0] has element type logic [7:0]
+            const Type* elementType = &type;
+            if (type.kind == SymbolKind::FixedSizeUnpackedArrayType) {
+                // Walk down to find the non-unpacked element type
+                while (elementType->kind == SymbolKind::FixedSizeUnpackedArrayType) {
+                    elementType = &elementType->getCanonicalType().as<FixedSizeUnpackedArrayType>().elementType;
+                }
+                info.is_array = true;
+                info.array_dims = extractUnpackedDimensions(type);
+            }
+
+            info.width = elementType->getBitWidth();
+
+            // Try to extract original syntax (preserves parameters/macros)
+            info.original_range_str = extractOriginalDimensions(*portSym, sm);
+
+            // Fallback: extract from resolved type (preserves multi-dimensional structure)
+            if (elementType->isPackedArray()) {
+                info.range_str = extractPackedDimensions(*elementType);
+            } else if (info.width > 1) {
+                info.range_str = "[" + std::to_string(info.width - 1) + ":0]";
+            }
+        }
+
+        ports.push_back(info);
+    }
+
+    return ports;
+}
+
 } // anonymous namespace
 
 std::vector<PortInfo> getModulePortsFromCompilation(
     slang::ast::Compilation& compilation,
     const std::string& module_name,
     DiagnosticCollector* diagnostics,
-    StrictnessMode strictness) {
+    StrictnessMode strictness,
+    std::string* source_file) {
 
     std::vector<PortInfo> ports;
 
@@ -315,70 +396,253 @@ std::vector<PortInfo> getModulePortsFromCompilation(
         return ports;
     }
 
-    // Extract ports from the body's port list
-    for (auto* port : found_body->getPortList()) {
-        PortInfo info;
-        info.name = std::string(port->name);
-
-        // Empty port name indicates a parsing failure (e.g., undefined macros)
-        if (info.name.empty()) {
-            if (diagnostics) {
-                diagnostics->addError(
-                    "Port with empty name in module '" + module_name +
-                    "' (likely caused by undefined macros in port declaration). "
-                    "Ensure all required macros are defined via +define+ or include files.",
-                    "", 0, "port_parse");
-            }
-            return {};  // Return empty - caller will handle the error
+    if (source_file) {
+        if (auto* sm = compilation.getSourceManager()) {
+            auto location = sm->getFullyOriginalLoc(found_body->getDefinition().location);
+            *source_file = sm->getFullPath(location.buffer()).string();
         }
+    }
 
-        if (auto* portSym = port->as_if<PortSymbol>()) {
-            switch (portSym->direction) {
-                case ArgumentDirection::In:
-                    info.direction = "input";
-                    break;
-                case ArgumentDirection::Out:
-                    info.direction = "output";
-                    break;
-                case ArgumentDirection::InOut:
-                    info.direction = "inout";
-                    break;
-                default:
-                    info.direction = "input";
-                    break;
+    return portsFromBody(*found_body, *compilation.getSourceManager(), module_name, diagnostics);
+}
+
+std::vector<ModuleSignature> topModuleSignatures(Compilation& compilation,
+                                                 DiagnosticCollector* diagnostics) {
+    std::vector<ModuleSignature> signatures;
+    const auto& sm = *compilation.getSourceManager();
+
+    for (auto* top : compilation.getRoot().topInstances) {
+        const auto& body = top->body;
+        ModuleSignature signature;
+        signature.name = std::string(body.name);
+
+        for (auto* param : body.getParameters()) {
+            ModuleSignature::Parameter parameter;
+            parameter.name = std::string(param->symbol.name);
+            if (auto* value = param->symbol.as_if<ParameterSymbol>()) {
+                parameter.default_value = value->getValue().toString();
+            } else if (auto* type = param->symbol.as_if<TypeParameterSymbol>()) {
+                parameter.default_value = type->targetType.getType().toString();
             }
+            signature.parameters.push_back(std::move(parameter));
+        }
 
-            auto& type = portSym->getType();
+        signature.ports = portsFromBody(body, sm, signature.name, diagnostics);
 
-            // For unpacked arrays, we need to get the element type for packed dimensions
-            // e.g., logic [7:0] data [3:0] has element type logic [7:0]
-            const Type* elementType = &type;
-            if (type.kind == SymbolKind::FixedSizeUnpackedArrayType) {
-                // Walk down to find the non-unpacked element type
-                while (elementType->kind == SymbolKind::FixedSizeUnpackedArrayType) {
-                    elementType = &elementType->getCanonicalType().as<FixedSizeUnpackedArrayType>().elementType;
+        // Whole-word search for each parameter in the port ranges
+        auto mentions = [](const std::string& text, const std::string& word) {
+            auto is_ident = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$'; };
+            for (size_t pos = text.find(word); pos != std::string::npos; pos = text.find(word, pos + 1)) {
+                bool starts = pos == 0 || !is_ident(text[pos - 1]);
+                bool ends = pos + word.size() == text.size() || !is_ident(text[pos + word.size()]);
+                if (starts && ends) return true;
+            }
+            return false;
+        };
+        for (const auto& port : signature.ports) {
+            for (const auto& parameter : signature.parameters) {
+                if (mentions(port.original_range_str, parameter.name) ||
+                    mentions(port.array_dims, parameter.name)) {
+                    signature.parameterized_ports = true;
                 }
-                info.is_array = true;
-                info.array_dims = extractUnpackedDimensions(type);
             }
+        }
 
-            info.width = elementType->getBitWidth();
+        signatures.push_back(std::move(signature));
+    }
+    return signatures;
+}
 
-            // Try to extract original syntax (preserves parameters/macros)
-            info.original_range_str = extractOriginalDimensions(*portSym, *compilation.getSourceManager());
+ModulePorts::ModulePorts(std::vector<PortInfo> p) : ports(std::move(p)) {
+    const auto count = static_cast<uint32_t>(ports.size());
 
-            // Fallback: extract from resolved type (preserves multi-dimensional structure)
-            if (elementType->isPackedArray()) {
-                info.range_str = extractPackedDimensions(*elementType);
-            } else if (info.width > 1) {
-                info.range_str = "[" + std::to_string(info.width - 1) + ":0]";
+    alphabetical.resize(count);
+    std::iota(alphabetical.begin(), alphabetical.end(), 0u);
+    std::sort(alphabetical.begin(), alphabetical.end(),
+        [&](uint32_t a, uint32_t b) { return ports[a].name < ports[b].name; });
+
+    by_direction.reserve(count);
+    for (auto dir : {PortDirection::Output, PortDirection::Inout, PortDirection::Input}) {
+        for (uint32_t i = 0; i < count; ++i) {
+            if (ports[i].direction == dir) by_direction.push_back(i);
+        }
+    }
+}
+
+const std::vector<PortInfo>& PortCache::get(
+    slang::ast::Compilation& compilation,
+    const std::string& module_name,
+    DiagnosticCollector* diagnostics,
+    StrictnessMode strictness,
+    bool resolved_ranges) {
+    return lookup(compilation, module_name, diagnostics, strictness, resolved_ranges).ports;
+}
+
+const ModulePorts& PortCache::lookup(
+    slang::ast::Compilation& compilation,
+    const std::string& module_name,
+    DiagnosticCollector* diagnostics,
+    StrictnessMode strictness,
+    bool resolved_ranges) {
+
+    static const ModulePorts empty;
+
+    // A default-parameter entry cached for an earlier file is not good enough
+    // for one with resolved ranges. Every lookup of one analysis run passes
+    // the same flag, so an entry is never replaced while it is referenced.
+    auto cached = ports_.find(module_name);
+    if (cached != ports_.end() && !(resolved_ranges && cached->second.default_parameters)) {
+        ++hits_;
+        return cached->second;
+    }
+
+    ++misses_;
+    const PortSnapshot* parameterized_in = nullptr;
+    for (const auto& snapshot : snapshots_) {
+        auto signature = snapshot->find(module_name);
+        if (!signature || signature->ports.empty()) {
+            continue;
+        }
+        if (signature->parameterized_ports && resolved_ranges) {
+            if (!parameterized_in) parameterized_in = snapshot.get();
+            continue;
+        }
+        auto& entry = ports_.insert_or_assign(module_name, ModulePorts(std::move(signature->ports)))
+                          .first->second;
+        entry.source_file = snapshot->path().string();
+        entry.default_parameters = signature->parameterized_ports;
+        return entry;
+    }
+
+    // A module known only to a snapshot gets a diagnostic that says why it
+    // cannot be used, instead of the compilation's generic "not found"
+    std::string source_file;
+    auto ports = getModulePortsFromCompilation(compilation, module_name,
+                                               parameterized_in ? nullptr : diagnostics,
+                                               strictness, &source_file);
+    if (ports.empty()) {
+        if (parameterized_in && diagnostics) {
+            std::string msg = "Module '" + module_name +
+                              "' has parameter-dependent port ranges in port snapshot " +
+                              parameterized_in->path().string() +
+                              "; resolved ranges need it elaborated from source";
+            if (strictness == StrictnessMode::Strict) {
+                diagnostics->addError(msg);
+            } else {
+                diagnostics->addWarning(msg);
             }
         }
+        return empty;
+    }
+    auto& entry = ports_.insert_or_assign(module_name, ModulePorts(std::move(ports))).first->second;
+    entry.source_file = std::move(source_file);
+    return entry;
+}
 
-        ports.push_back(info);
+const ModulePorts* PortCache::find(const std::string& module_name) const {
+    auto it = ports_.find(module_name);
+    return it != ports_.end() ? &it->second : nullptr;
+}
+
+void PortCache::addSnapshot(std::shared_ptr<const PortSnapshot> snapshot) {
+    if (snapshot) {
+        snapshots_.push_back(std::move(snapshot));
     }
+}
 
-    return ports;
+void PortCache::clear() {
+    ports_.clear();
+    hits_ = 0;
+    misses_ = 0;
+}
+
+void PortCache::eraseSource(const std::filesystem::path& file) {
+    std::erase_if(ports_, [&](const auto& item) {
+        const std::string& source = item.second.source_file;
+        if (source.empty()) return true;
+        std::error_code ec;
+        bool same = std::filesystem::equivalent(source, file, ec);
+        return ec ? std::filesystem::path(source) == file : same;
+    });
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// Module interface hashing
+// ════════════════════════════════════════════════════════════════════════════
+
+namespace {
+
+/// Hashes the text of every token under a node, skipping trivia (FNV-1a,
+/// with a separator between tokens so that "a bc" and "ab c" differ)
+struct TokenHasher : public SyntaxVisitor<TokenHasher> {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    void visitToken(slang::parsing::Token token) {
+        for (char c : token.rawText()) {
+            mix(static_cast<unsigned char>(c));
+        }
+        mix(0);
+    }
+
+    void mix(unsigned char byte) {
+        hash ^= byte;
+        hash *= 0x100000001b3ULL;
+    }
+};
+
+/// Collects the module type of every instantiation under a node
+struct InstanceCollector : public SyntaxVisitor<InstanceCollector> {
+    std::vector<std::string> types;
+
+    void handle(const HierarchyInstantiationSyntax& node) {
+        types.emplace_back(node.type.valueText());
+    }
+};
+
+} // anonymous namespace
+
+std::vector<ModuleInterface> moduleInterfaces(std::string_view text) {
+    auto tree = SyntaxTree::fromText(text);
+    auto& root = tree->root();
+
+    std::vector<const ModuleDeclarationSyntax*> modules;
+    if (root.kind == SyntaxKind::CompilationUnit) {
+        for (auto* member : root.as<CompilationUnitSyntax>().members) {
+            if (member->kind == SyntaxKind::ModuleDeclaration ||
+                member->kind == SyntaxKind::InterfaceDeclaration) {
+                modules.push_back(&member->as<ModuleDeclarationSyntax>());
+            }
+        }
+    } else if (root.kind == SyntaxKind::ModuleDeclaration ||
+               root.kind == SyntaxKind::InterfaceDeclaration) {
+        modules.push_back(&root.as<ModuleDeclarationSyntax>());
+    }
+
+    std::vector<ModuleInterface> result;
+    result.reserve(modules.size());
+    for (const auto* module : modules) {
+        TokenHasher hasher;
+        module->header->visit(hasher);
+
+        // Non-ANSI port declarations and body parameters also shape the ports
+        for (const auto* member : module->members) {
+            if (member->kind == SyntaxKind::PortDeclaration ||
+                member->kind == SyntaxKind::ParameterDeclarationStatement) {
+                member->visit(hasher);
+            }
+        }
+        InstanceCollector instances;
+        for (const auto* member : module->members) {
+            member->visit(instances);
+        }
+        std::sort(instances.types.begin(), instances.types.end());
+        instances.types.erase(std::unique(instances.types.begin(), instances.types.end()),
+                              instances.types.end());
+
+        result.push_back({std::string(module->header->name.valueText()), hasher.hash,
+                          std::move(instances.types)});
+    }
+    return result;
 }
 
 } // namespace slang_autos
@@ -0,0 +1,571 @@
+#include "slang-autos/Daemon.h"
+#include "slang-autos/MappedFile.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define SLANG_AUTOS_HAVE_UNIX_SOCKETS 1
+#endif
+
+namespace slang_autos {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/// Requests are a few kilobytes of arguments; anything larger is garbage.
+constexpr uint32_t kMaxRequestBytes = 64u << 20;
+
+void appendU32(std::string& out, uint32_t value) {
+    char bytes[sizeof(value)];
+    std::memcpy(bytes, &value, sizeof(value));
+    out.append(bytes, sizeof(value));
+}
+
+void appendString(std::string& out, std::string_view text) {
+    appendU32(out, static_cast<uint32_t>(text.size()));
+    out.append(text);
+}
+
+/// Bounds-checked reader over a request body
+class BodyReader {
+public:
+    explicit BodyReader(std::string_view body) : body_(body) {}
+
+    bool readU32(uint32_t& value) {
+        if (body_.size() - pos_ < sizeof(value)) return false;
+        std::memcpy(&value, body_.data() + pos_, sizeof(value));
+        pos_ += sizeof(value);
+        return true;
+    }
+
+    bool readString(std::string& text) {
+        uint32_t size = 0;
+        if (!readU32(size) || body_.size() - pos_ < size) return false;
+        text.assign(body_.substr(pos_, size));
+        pos_ += size;
+        return true;
+    }
+
+    bool readByte(char& c) {
+        if (pos_ >= body_.size()) return false;
+        c = body_[pos_++];
+        return true;
+    }
+
+    [[nodiscard]] bool atEnd() const { return pos_ == body_.size(); }
+
+private:
+    std::string_view body_;
+    size_t pos_ = 0;
+};
+
+#ifdef SLANG_AUTOS_HAVE_UNIX_SOCKETS
+
+bool writeAll(int fd, const void* data, size_t size) {
+    auto* p = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = ::write(fd, p, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool readAll(int fd, void* data, size_t size) {
+    auto* p = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t n = ::read(fd, p, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) return false;  // Peer closed early
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool makeAddress(const fs::path& socket, sockaddr_un& addr) {
+    const std::string& path = socket.native();
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) return false;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+/// Whether the process at the other end of a connected socket runs as this
+/// user. Requests carry file descriptors and run commands, so they are only
+/// exchanged with ourselves.
+bool peerIsSelf(int connection) {
+#if defined(SO_PEERCRED)
+    ucred cred{};
+    socklen_t len = sizeof(cred);
+    if (::getsockopt(connection, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) return false;
+    return cred.uid == ::geteuid();
+#else
+    uid_t uid = 0;
+    gid_t gid = 0;
+    if (::getpeereid(connection, &uid, &gid) != 0) return false;
+    return uid == ::geteuid();
+#endif
+}
+
+/// Make sure nobody else can replace the socket: create its directory
+/// (mode 0700) if missing, and refuse a directory another user controls.
+/// Shared sticky directories such as /tmp are accepted, since others cannot
+/// remove or rename our socket there; the socket itself is 0600.
+bool checkSocketDirectory(const fs::path& socket, DiagnosticCollector& diagnostics) {
+    fs::path dir = socket.parent_path();
+    if (dir.empty()) dir = ".";
+
+    if (::mkdir(dir.c_str(), S_IRWXU) != 0 && errno != EEXIST) {
+        diagnostics.addError("Failed to create daemon socket directory " + dir.string() + ": " +
+                             std::strerror(errno));
+        return false;
+    }
+
+    struct stat st{};
+    if (::lstat(dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        diagnostics.addError("Daemon socket directory is not a directory: " + dir.string());
+        return false;
+    }
+    bool trusted_owner = st.st_uid == ::geteuid() || st.st_uid == 0;
+    bool others_can_write = (st.st_mode & (S_IWGRP | S_IWOTH)) != 0;
+    if (!trusted_owner || (others_can_write && !(st.st_mode & S_ISVTX))) {
+        diagnostics.addError("Daemon socket directory " + dir.string() +
+                             " is owned or writable by another user");
+        return false;
+    }
+    return true;
+}
+
+/// Connect to a listening socket, or return -1
+int connectTo(const fs::path& socket) {
+    sockaddr_un addr;
+    if (!makeAddress(socket, addr)) return -1;
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/// Send a framed request. The length header carries `fds` as SCM_RIGHTS.
+bool sendRequest(int connection, const DaemonRequest& request, const int* fds, size_t fd_count) {
+    std::string body = encodeDaemonRequest(request);
+    uint32_t size = static_cast<uint32_t>(body.size());
+
+    iovec iov{&size, sizeof(size)};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))];
+    if (fd_count > 0) {
+        std::memset(control, 0, sizeof(control));
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(fd_count * sizeof(int));
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(fd_count * sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), fds, fd_count * sizeof(int));
+    }
+
+    ssize_t sent;
+    do {
+        sent = ::sendmsg(connection, &msg, 0);
+    } while (sent < 0 && errno == EINTR);
+    if (sent < 0) return false;
+
+    // A short send of the header is unusual but legal; finish it plainly
+    auto done = static_cast<size_t>(sent);
+    return writeAll(connection, reinterpret_cast<const char*>(&size) + done, sizeof(size) - done) &&
+           writeAll(connection, body.data(), body.size());
+}
+
+/// Receive a framed request and up to two passed descriptors (-1 if absent)
+bool receiveRequest(int connection, DaemonRequest& request, int (&fds)[2]) {
+    fds[0] = fds[1] = -1;
+
+    uint32_t size = 0;
+    iovec iov{&size, sizeof(size)};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    alignas(cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))];
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t received;
+    do {
+        received = ::recvmsg(connection, &msg, 0);
+    } while (received < 0 && errno == EINTR);
+    if (received <= 0) return false;
+
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+        size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (size_t i = 0; i < count; ++i) {
+            int fd;
+            std::memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+            if (i < 2) {
+                fds[i] = fd;
+            } else {
+                ::close(fd);
+            }
+        }
+    }
+
+    auto done = static_cast<size_t>(received);
+    if (!readAll(connection, reinterpret_cast<char*>(&size) + done, sizeof(size) - done) ||
+        size > kMaxRequestBytes) {
+        return false;
+    }
+
+    std::string body(size, '\0');
+    if (!readAll(connection, body.data(), body.size())) return false;
+
+    auto decoded = decodeDaemonRequest(body);
+    if (!decoded) return false;
+    request = std::move(*decoded);
+    return true;
+}
+
+void flushStandardStreams() {
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+}
+
+#endif // SLANG_AUTOS_HAVE_UNIX_SOCKETS
+
+} // anonymous namespace
+
+// ════════════════════════════════════════════════════════════════════════════
+// Wire format
+// ════════════════════════════════════════════════════════════════════════════
+// Each request is a 4-byte body length followed by the body:
+//   kind ('R' run, 'S' stop), cwd, argument count, arguments
+// with strings as a 4-byte length plus bytes, in host byte order (both ends
+// are on the same machine). The reply is a 4-byte exit code.
+
+std::string encodeDaemonRequest(const DaemonRequest& request) {
+    std::string out;
+    out.push_back(request.stop ? 'S' : 'R');
+    appendString(out, request.cwd);
+    appendU32(out, static_cast<uint32_t>(request.args.size()));
+    for (const auto& arg : request.args) {
+        appendString(out, arg);
+    }
+    return out;
+}
+
+std::optional<DaemonRequest> decodeDaemonRequest(std::string_view body) {
+    BodyReader reader(body);
+    DaemonRequest request;
+
+    char kind = 0;
+    if (!reader.readByte(kind) || (kind != 'R' && kind != 'S')) return std::nullopt;
+    request.stop = kind == 'S';
+
+    uint32_t count = 0;
+    if (!reader.readString(request.cwd) || !reader.readU32(count)) return std::nullopt;
+    for (uint32_t i = 0; i < count; ++i) {
+        std::string arg;
+        if (!reader.readString(arg)) return std::nullopt;
+        request.args.push_back(std::move(arg));
+    }
+
+    if (!reader.atEnd()) return std::nullopt;
+    return request;
+}
+
+fs::path defaultDaemonSocketPath() {
+    if (const char* runtime = std::getenv("XDG_RUNTIME_DIR"); runtime && *runtime) {
+        return fs::path(runtime) / "slang-autos.sock";
+    }
+#ifdef SLANG_AUTOS_HAVE_UNIX_SOCKETS
+    // A private directory rather than a file directly in /tmp, where another
+    // user could create the path first
+    return fs::temp_directory_path() / ("slang-autos-" + std::to_string(::getuid())) /
+           "daemon.sock";
+#else
+    return fs::temp_directory_path() / "slang-autos.sock";
+#endif
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// FileStamps
+// ════════════════════════════════════════════════════════════════════════════
+
+FileStamps::Stamp FileStamps::stat(const fs::path& path) {
+    Stamp stamp;
+    stamp.path = path;
+
+    std::error_code ec;
+    auto status = fs::status(path, ec);
+    if (ec || !fs::exists(status)) return stamp;
+
+    stamp.exists = true;
+    stamp.is_directory = fs::is_directory(status);
+    stamp.mtime = fs::last_write_time(path, ec);
+    if (!stamp.is_directory) {
+        stamp.size = fs::file_size(path, ec);
+        if (ec) stamp.size = 0;
+    }
+    return stamp;
+}
+
+size_t FileStamps::hashContent(const fs::path& path) {
+    auto file = MappedFile::open(path);
+    return file ? std::hash<std::string_view>{}(file->view()) : 0;
+}
+
+void FileStamps::add(const fs::path& path) {
+    if (!seen_.insert(path.string()).second) return;
+
+    Stamp stamp = stat(path);
+    if (stamp.exists && !stamp.is_directory) {
+        stamp.hash = hashContent(path);
+    }
+    stamps_.push_back(std::move(stamp));
+}
+
+bool FileStamps::changed() {
+    for (auto& stamp : stamps_) {
+        Stamp now = stat(stamp.path);
+        if (now.exists != stamp.exists || now.is_directory != stamp.is_directory) return true;
+        if (!now.exists || now.mtime == stamp.mtime) continue;
+        if (now.is_directory || now.size != stamp.size) return true;
+
+        // Same size, new mtime: only a content change counts
+        size_t hash = hashContent(stamp.path);
+        if (hash != stamp.hash) return true;
+        stamp.mtime = now.mtime;
+    }
+    return false;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// Server
+// ════════════════════════════════════════════════════════════════════════════
+
+DaemonServer::~DaemonServer() {
+    close();
+}
+
+void DaemonServer::close() {
+#ifdef SLANG_AUTOS_HAVE_UNIX_SOCKETS
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+        std::error_code ec;
+        fs::remove(path_, ec);
+    }
+#endif
+}
+
+bool DaemonServer::listen(const fs::path& socket, DiagnosticCollector& diagnostics) {
+#ifdef SLANG_AUTOS_HAVE_UNIX_SOCKETS
+    sockaddr_un addr;
+    if (!makeAddress(socket, addr)) {
+        diagnostics.addError("Invalid daemon socket path: " + socket.string());
+        return false;
+    }
+    if (!checkSocketDirectory(socket, diagnostics)) {
+        return false;
+    }
+
+    std::error_code ec;
+    if (fs::exists(fs::symlink_status(socket, ec))) {
+        if (int live = connectTo(socket); live >= 0) {
+            ::close(live);
+            diagnostics.addError("A daemon is already listening on " + socket.string());
+            return false;
+        }
+        fs::remove(socket, ec);  // Left behind by a daemon that was killed
+    }
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        diagnostics.addError(std::string("Failed to create daemon socket: ") + std::strerror(errno));
+        return false;
+    }
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::chmod(addr.sun_path, S_IRUSR | S_IWUSR) != 0 || ::listen(fd, 16) != 0) {
+        diagnostics.addError("Failed to listen on " + socket.string() + ": " + std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    fd_ = fd;
+    path_ = socket;
+    return true;
+#else
+    diagnostics.addError("The daemon needs UNIX domain sockets, which this platform lacks: " +
+                         socket.string());
+    return false;
+#endif
+}
+
+void DaemonServer::serve(const Handler& handler) {
+#ifdef SLANG_AUTOS_HAVE_UNIX_SOCKETS
+    // A client that disconnects mid-request must not kill the daemon
+    std::signal(SIGPIPE, SIG_IGN);
+
+    while (fd_ >= 0) {
+        int connection = ::accept(fd_, nullptr, nullptr);
+        if (connection < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+        if (!peerIsSelf(connection)) {
+            std::fprintf(stderr, "warning: rejected daemon connection from another user\n");
+            ::close(connection);
+            continue;
+        }
+        bool keep_going = serveConnection(connection, handler);
+        ::close(connection);
+        if (!keep_going) break;
+    }
+
+    // Later clients must find no daemon rather than queue on a dead listener
+    close();
+#else
+    (void)handler;
+#endif
+}
+
+bool DaemonServer::serveConnection(int connection, const Handler& handler) {
+#ifdef SLANG_AUTOS_HAVE_UNIX_SOCKETS
+    DaemonRequest request;
+    int fds[2];
+    bool received = receiveRequest(connection, request, fds);
+
+    auto closeFds = [&] {
+        for (int fd : fds) {
+            if (fd >= 0) ::close(fd);
+        }
+    };
+
+    if (!received) {
+        closeFds();
+        return true;
+    }
+
+    if (request.stop) {
+        closeFds();
+        int32_t code = 0;
+        writeAll(connection, &code, sizeof(code));
+        return false;
+    }
+
+    // ─────────────────────────────────────────────────────────────────────────
+    // Run in the client's directory, writing to the client's stdout/stderr
+    // ─────────────────────────────────────────────────────────────────────────
+    int32_t code = 1;
+    std::error_code ec;
+    fs::path daemon_cwd = fs::current_path(ec);
+    fs::current_path(request.cwd, ec);
+    if (ec) {
+        std::string message = "error: daemon cannot enter " + request.cwd + ": " + ec.message() + "\n";
+        if (fds[1] >= 0) writeAll(fds[1], message.data(), message.size());
+    } else {
+        flushStandardStreams();
+        int saved_out = ::dup(STDOUT_FILENO);
+        int saved_err = ::dup(STDERR_FILENO);
+        if (fds[0] >= 0) ::dup2(fds[0], STDOUT_FILENO);
+        if (fds[1] >= 0) ::dup2(fds[1], STDERR_FILENO);
+
+        try {
+            code = handler(request);
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "error: %s\n", e.what());
+            code = 1;
+        }
+
+        flushStandardStreams();
+        ::dup2(saved_out, STDOUT_FILENO);
+        ::dup2(saved_err, STDERR_FILENO);
+        ::close(saved_out);
+        ::close(saved_err);
+        fs::current_path(daemon_cwd, ec);
+    }
+
+    closeFds();
+    writeAll(connection, &code, sizeof(code));
+    return true;
+#else
+    (void)connection;
+    (void)handler;
+    return false;
+#endif
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// Client
+// ════════════════════════════════════════════════════════════════════════════
+
+std::optional<int> runDaemonClient(const fs::path& socket,
+                                   const DaemonRequest& request,
+                                   DiagnosticCollector& diagnostics) {
+#ifdef SLANG_AUTOS_HAVE_UNIX_SOCKETS
+    int connection = connectTo(socket);
+    if (connection < 0) return std::nullopt;
+    if (!peerIsSelf(connection)) {
+        // Never hand our stdout/stderr to someone else's process
+        ::close(connection);
+        diagnostics.addError("Daemon on " + socket.string() + " is run by another user");
+        return 1;
+    }
+
+    const int fds[2] = {STDOUT_FILENO, STDERR_FILENO};
+    flushStandardStreams();
+
+    int32_t code = 1;
+    bool ok = sendRequest(connection, request, fds, request.stop ? 0 : 2) &&
+              readAll(connection, &code, sizeof(code));
+    ::close(connection);
+
+    if (!ok) {
+        diagnostics.addError("Lost connection to the daemon on " + socket.string());
+        return 1;
+    }
+    return code;
+#else
+    (void)socket;
+    (void)request;
+    (void)diagnostics;
+    return std::nullopt;
+#endif
+}
+
+bool stopDaemon(const fs::path& socket) {
+    DaemonRequest request;
+    request.stop = true;
+    DiagnosticCollector diagnostics;
+    return runDaemonClient(socket, request, diagnostics).has_value();
+}
+
+} // namespace slang_autos
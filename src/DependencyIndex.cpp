@@ -0,0 +1,101 @@
+#include "slang-autos/DependencyIndex.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+
+namespace slang_autos {
+
+namespace {
+
+constexpr std::string_view kSignaturesHeader = "# slang-autos port signatures v1";
+
+} // anonymous namespace
+
+// ════════════════════════════════════════════════════════════════════════════
+// DependencyIndex
+// ════════════════════════════════════════════════════════════════════════════
+
+void DependencyIndex::addFile(const std::string& file, std::string_view text) {
+    if (auto it = files_.find(file); it != files_.end()) {
+        for (const auto& module : it->second) {
+            for (const auto& type : module.instances) {
+                parents_[type].erase(file);
+            }
+        }
+    }
+
+    auto& modules = files_[file];
+    modules = moduleInterfaces(text);
+    for (const auto& module : modules) {
+        for (const auto& type : module.instances) {
+            parents_[type].insert(file);
+        }
+    }
+}
+
+std::vector<std::string> DependencyIndex::affectedBy(const std::set<std::string>& changed_modules) const {
+    std::set<std::string> stale;
+    std::vector<std::string> pending(changed_modules.begin(), changed_modules.end());
+    std::set<std::string> visited(changed_modules.begin(), changed_modules.end());
+
+    while (!pending.empty()) {
+        std::string module = std::move(pending.back());
+        pending.pop_back();
+
+        auto it = parents_.find(module);
+        if (it == parents_.end()) continue;
+
+        for (const auto& file : it->second) {
+            if (!stale.insert(file).second) continue;
+            for (const auto& declared : files_.at(file)) {
+                if (visited.insert(declared.name).second) {
+                    pending.push_back(declared.name);
+                }
+            }
+        }
+    }
+    return {stale.begin(), stale.end()};
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// Port signature file
+// ════════════════════════════════════════════════════════════════════════════
+
+std::optional<PortSignatures> loadPortSignatures(const std::filesystem::path& file) {
+    std::ifstream ifs(file);
+    if (!ifs) return std::nullopt;
+
+    std::string line;
+    if (!std::getline(ifs, line) || line != kSignaturesHeader) return std::nullopt;
+
+    PortSignatures signatures;
+    while (std::getline(ifs, line)) {
+        if (line.empty()) continue;
+        auto space = line.find(' ');
+        if (space == std::string::npos || space == 0) return std::nullopt;
+
+        uint64_t hash = 0;
+        const char* first = line.data() + space + 1;
+        const char* last = line.data() + line.size();
+        auto [ptr, ec] = std::from_chars(first, last, hash, 16);
+        if (ec != std::errc() || ptr != last) return std::nullopt;
+
+        signatures[line.substr(0, space)] = hash;
+    }
+    return signatures;
+}
+
+bool savePortSignatures(const std::filesystem::path& file, const PortSignatures& signatures) {
+    std::ostringstream out;
+    out << kSignaturesHeader << '\n' << std::hex;
+    for (const auto& [module, hash] : signatures) {
+        out << module << ' ' << hash << '\n';
+    }
+
+    std::ofstream ofs(file, std::ios::binary);
+    return static_cast<bool>(ofs << out.str());
+}
+
+} // namespace slang_autos
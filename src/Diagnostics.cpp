@@ -20,6 +20,12 @@ void DiagnosticCollector::addError(const std::string& msg,
     ++error_count_;
 }
 
+void DiagnosticCollector::merge(const DiagnosticCollector& other) {
+    diagnostics_.insert(diagnostics_.end(), other.diagnostics_.begin(), other.diagnostics_.end());
+    error_count_ += other.error_count_;
+    warning_count_ += other.warning_count_;
+}
+
 void DiagnosticCollector::clear() {
     diagnostics_.clear();
     error_count_ = 0;
@@ -0,0 +1,128 @@
+#include "slang-autos/FileWatcher.h"
+
+#include <algorithm>
+#include <cerrno>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#define SLANG_AUTOS_HAVE_INOTIFY 1
+#endif
+
+namespace slang_autos {
+
+namespace fs = std::filesystem;
+
+#ifdef SLANG_AUTOS_HAVE_INOTIFY
+
+namespace {
+
+/// Events that can change what a file contains. IN_MODIFY is left out: it
+/// fires on every write() of a save, and IN_CLOSE_WRITE follows at the end.
+constexpr uint32_t kWatchMask =
+    IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+
+} // anonymous namespace
+
+FileWatcher::FileWatcher() {
+    fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+}
+
+FileWatcher::~FileWatcher() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool FileWatcher::addDirectory(const fs::path& dir) {
+    if (fd_ < 0) return false;
+
+    std::error_code ec;
+    fs::path absolute = fs::absolute(dir, ec).lexically_normal();
+    if (ec || !fs::is_directory(absolute, ec)) return false;
+
+    // The kernel hands back the same descriptor for a directory watched twice
+    int wd = ::inotify_add_watch(fd_, absolute.c_str(), kWatchMask | IN_ONLYDIR);
+    if (wd < 0) return false;
+    dirs_[wd] = absolute;
+    return true;
+}
+
+bool FileWatcher::drain(std::vector<fs::path>& changed) {
+    alignas(inotify_event) char buffer[16 * 1024];
+    while (true) {
+        ssize_t n = ::read(fd_, buffer, sizeof(buffer));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        if (n == 0) return true;
+
+        for (ssize_t offset = 0; offset < n;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            if (event->mask & IN_IGNORED) {
+                dirs_.erase(event->wd);  // Directory removed or unmounted
+                continue;
+            }
+            if (event->len == 0 || (event->mask & IN_ISDIR)) continue;
+
+            auto it = dirs_.find(event->wd);
+            if (it != dirs_.end()) {
+                changed.push_back(it->second / event->name);
+            }
+        }
+    }
+}
+
+std::vector<fs::path> FileWatcher::wait(std::chrono::milliseconds settle,
+                                        std::optional<std::chrono::milliseconds> timeout) {
+    std::vector<fs::path> changed;
+    if (fd_ < 0) return changed;
+
+    pollfd pfd{fd_, POLLIN, 0};
+
+    // First event: block (up to the timeout)
+    int first_wait = timeout ? static_cast<int>(timeout->count()) : -1;
+    while (changed.empty()) {
+        int ready = ::poll(&pfd, 1, first_wait);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready <= 0 || !drain(changed)) return {};
+        if (changed.empty() && timeout) return {};  // Only directory events; don't re-wait forever
+    }
+
+    // Then debounce until the burst is over
+    while (true) {
+        int ready = ::poll(&pfd, 1, static_cast<int>(settle.count()));
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready <= 0 || !drain(changed)) break;
+    }
+
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    return changed;
+}
+
+#else // !SLANG_AUTOS_HAVE_INOTIFY
+
+FileWatcher::FileWatcher() = default;
+FileWatcher::~FileWatcher() = default;
+
+bool FileWatcher::addDirectory(const fs::path&) {
+    return false;
+}
+
+bool FileWatcher::drain(std::vector<fs::path>&) {
+    return false;
+}
+
+std::vector<fs::path> FileWatcher::wait(std::chrono::milliseconds,
+                                        std::optional<std::chrono::milliseconds>) {
+    return {};
+}
+
+#endif // SLANG_AUTOS_HAVE_INOTIFY
+
+} // namespace slang_autos
@@ -0,0 +1,62 @@
+#include "slang-autos/MappedFile.h"
+
+#include <fstream>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SLANG_AUTOS_HAVE_MMAP 1
+#endif
+
+namespace slang_autos {
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::filesystem::path& file) {
+    std::shared_ptr<MappedFile> mapped(new MappedFile());
+
+#ifdef SLANG_AUTOS_HAVE_MMAP
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            ::madvise(data, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+            mapped->data_ = static_cast<const char*>(data);
+            mapped->size_ = static_cast<size_t>(st.st_size);
+            mapped->mapped_ = true;
+        }
+    }
+    ::close(fd);
+    if (mapped->mapped_) {
+        return mapped;
+    }
+#endif
+
+    // Empty files, non-regular files and platforms without mmap
+    std::ifstream ifs(file, std::ios::binary);
+    if (!ifs) {
+        return nullptr;
+    }
+    std::stringstream buffer;
+    buffer << ifs.rdbuf();
+    mapped->fallback_ = buffer.str();
+    mapped->data_ = mapped->fallback_.data();
+    mapped->size_ = mapped->fallback_.size();
+    return mapped;
+}
+
+MappedFile::~MappedFile() {
+#ifdef SLANG_AUTOS_HAVE_MMAP
+    if (mapped_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
+
+} // namespace slang_autos
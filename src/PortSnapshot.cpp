@@ -0,0 +1,253 @@
+#include "slang-autos/PortSnapshot.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace slang_autos {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::string_view kMagic = "SAPSNAP1";
+constexpr size_t kHeaderSize = 8 + sizeof(uint32_t);
+constexpr size_t kIndexEntrySize = 3 * sizeof(uint32_t);
+
+template<typename T>
+void append(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+void appendString(std::string& out, std::string_view text) {
+    append(out, static_cast<uint32_t>(text.size()));
+    out.append(text);
+}
+
+/// Bounds-checked reader over a mapped snapshot
+class SnapshotReader {
+public:
+    SnapshotReader(std::string_view data, size_t pos) : data_(data), pos_(pos) {}
+
+    template<typename T>
+    bool read(T& value) {
+        if (pos_ > data_.size() || data_.size() - pos_ < sizeof(T)) return false;
+        std::memcpy(&value, data_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool readString(std::string& text) {
+        uint32_t size = 0;
+        if (!read(size) || data_.size() - pos_ < size) return false;
+        text.assign(data_.substr(pos_, size));
+        pos_ += size;
+        return true;
+    }
+
+private:
+    std::string_view data_;
+    size_t pos_;
+};
+
+} // anonymous namespace
+
+// ════════════════════════════════════════════════════════════════════════════
+// Writing
+// ════════════════════════════════════════════════════════════════════════════
+
+std::optional<size_t> PortSnapshot::write(const fs::path& file,
+                                          std::vector<ModuleSignature> modules,
+                                          DiagnosticCollector* diagnostics) {
+    std::stable_sort(modules.begin(), modules.end(),
+                     [](const ModuleSignature& a, const ModuleSignature& b) { return a.name < b.name; });
+    modules.erase(std::unique(modules.begin(), modules.end(),
+                              [](const ModuleSignature& a, const ModuleSignature& b) {
+                                  return a.name == b.name;
+                              }),
+                  modules.end());
+
+    // Names and records go after the index; compute the index as we go
+    std::string body;
+    std::vector<uint32_t> name_offsets;
+    std::vector<uint32_t> record_offsets;
+    const size_t body_start = kHeaderSize + modules.size() * kIndexEntrySize;
+
+    for (const auto& module : modules) {
+        name_offsets.push_back(static_cast<uint32_t>(body_start + body.size()));
+        body += module.name;
+
+        record_offsets.push_back(static_cast<uint32_t>(body_start + body.size()));
+        append(body, static_cast<uint32_t>(module.parameters.size()));
+        for (const auto& parameter : module.parameters) {
+            appendString(body, parameter.name);
+            appendString(body, parameter.default_value);
+        }
+        append(body, static_cast<uint8_t>(module.parameterized_ports));
+        append(body, static_cast<uint32_t>(module.ports.size()));
+        for (const auto& port : module.ports) {
+            appendString(body, port.name);
+            appendString(body, port.range_str);
+            appendString(body, port.original_range_str);
+            appendString(body, port.array_dims);
+            append(body, static_cast<int32_t>(port.width));
+            append(body, static_cast<uint8_t>(port.direction));
+            append(body, static_cast<uint8_t>(port.is_array));
+        }
+    }
+
+    // Offsets were truncated to 32 bits above; they are only valid if the
+    // whole file fits
+    if (body_start + body.size() > std::numeric_limits<uint32_t>::max()) {
+        if (diagnostics) {
+            diagnostics->addError("Port snapshot would exceed 4 GiB; split the library",
+                                  file.string());
+        }
+        return std::nullopt;
+    }
+
+    std::string out;
+    out.reserve(body_start + body.size());
+    out.append(kMagic);
+    append(out, static_cast<uint32_t>(modules.size()));
+    for (size_t i = 0; i < modules.size(); ++i) {
+        append(out, name_offsets[i]);
+        append(out, static_cast<uint32_t>(modules[i].name.size()));
+        append(out, record_offsets[i]);
+    }
+    out += body;
+
+    std::ofstream ofs(file, std::ios::binary);
+    if (!(ofs << out) || !ofs.flush()) {
+        if (diagnostics) {
+            diagnostics->addError("Failed to write port snapshot", file.string());
+        }
+        return std::nullopt;
+    }
+    return modules.size();
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// Reading
+// ════════════════════════════════════════════════════════════════════════════
+
+std::shared_ptr<const PortSnapshot> PortSnapshot::open(const fs::path& file,
+                                                       DiagnosticCollector* diagnostics) {
+    auto fail = [&](const std::string& why) -> std::shared_ptr<const PortSnapshot> {
+        if (diagnostics) {
+            diagnostics->addError("Cannot load port snapshot: " + why, file.string());
+        }
+        return nullptr;
+    };
+
+    auto mapped = MappedFile::open(file);
+    if (!mapped) return fail("cannot open file");
+
+    std::string_view data = mapped->view();
+    if (data.size() < kHeaderSize || data.substr(0, kMagic.size()) != kMagic) {
+        return fail("not a port snapshot");
+    }
+
+    uint32_t count = 0;
+    SnapshotReader(data, kMagic.size()).read(count);
+    if ((data.size() - kHeaderSize) / kIndexEntrySize < count) return fail("truncated index");
+
+    std::shared_ptr<PortSnapshot> snapshot(new PortSnapshot());
+    snapshot->file_ = std::move(mapped);
+    snapshot->path_ = file;
+    snapshot->data_ = data;
+    snapshot->count_ = count;
+
+    // Names must lie within the file for the binary search to be safe
+    for (size_t i = 0; i < count; ++i) {
+        SnapshotReader entry(data, kHeaderSize + i * kIndexEntrySize);
+        uint32_t offset = 0;
+        uint32_t size = 0;
+        entry.read(offset);
+        entry.read(size);
+        if (offset > data.size() || data.size() - offset < size) return fail("corrupt index");
+    }
+    return snapshot;
+}
+
+std::string_view PortSnapshot::nameAt(size_t i) const {
+    SnapshotReader entry(data_, kHeaderSize + i * kIndexEntrySize);
+    uint32_t offset = 0;
+    uint32_t size = 0;
+    entry.read(offset);
+    entry.read(size);
+    return data_.substr(offset, size);
+}
+
+std::optional<ModuleSignature> PortSnapshot::find(std::string_view module_name) const {
+    size_t lo = 0;
+    size_t hi = count_;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        std::string_view name = nameAt(mid);
+        if (name < module_name) {
+            lo = mid + 1;
+        } else if (module_name < name) {
+            hi = mid;
+        } else {
+            SnapshotReader entry(data_, kHeaderSize + mid * kIndexEntrySize + 2 * sizeof(uint32_t));
+            uint32_t record = 0;
+            entry.read(record);
+            return decode(name, record);
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<std::string> PortSnapshot::moduleNames() const {
+    std::vector<std::string> names;
+    names.reserve(count_);
+    for (size_t i = 0; i < count_; ++i) {
+        names.emplace_back(nameAt(i));
+    }
+    return names;
+}
+
+std::optional<ModuleSignature> PortSnapshot::decode(std::string_view name, uint32_t offset) const {
+    SnapshotReader reader(data_, offset);
+    ModuleSignature signature;
+    signature.name = std::string(name);
+
+    uint32_t parameter_count = 0;
+    if (!reader.read(parameter_count)) return std::nullopt;
+    for (uint32_t i = 0; i < parameter_count; ++i) {
+        ModuleSignature::Parameter parameter;
+        if (!reader.readString(parameter.name) || !reader.readString(parameter.default_value)) {
+            return std::nullopt;
+        }
+        signature.parameters.push_back(std::move(parameter));
+    }
+
+    uint8_t parameterized = 0;
+    uint32_t port_count = 0;
+    if (!reader.read(parameterized) || !reader.read(port_count)) return std::nullopt;
+    signature.parameterized_ports = parameterized != 0;
+
+    for (uint32_t i = 0; i < port_count; ++i) {
+        PortInfo port;
+        int32_t width = 0;
+        uint8_t direction = 0;
+        uint8_t is_array = 0;
+        if (!reader.readString(port.name) || !reader.readString(port.range_str) ||
+            !reader.readString(port.original_range_str) || !reader.readString(port.array_dims) ||
+            !reader.read(width) || !reader.read(direction) || !reader.read(is_array) ||
+            direction > static_cast<uint8_t>(PortDirection::Inout)) {
+            return std::nullopt;
+        }
+        port.width = width;
+        port.direction = static_cast<PortDirection>(direction);
+        port.is_array = is_array != 0;
+        signature.ports.push_back(std::move(port));
+    }
+    return signature;
+}
+
+} // namespace slang_autos
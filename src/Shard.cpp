@@ -0,0 +1,424 @@
+#include "slang-autos/Shard.h"
+#include "slang-autos/Stats.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <locale>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <sstream>
+
+namespace slang_autos {
+
+namespace {
+
+/// Cost of one AUTOINST relative to one byte of source (see estimateExpansionCost)
+constexpr uint64_t kInstanceWeight = 4096;
+
+// ════════════════════════════════════════════════════════════════════════════
+// Minimal JSON reader
+// ════════════════════════════════════════════════════════════════════════════
+// Enough to read back what slang-autos itself writes (--stats=json and
+// --shard-result): objects, arrays, strings, integers and booleans.
+
+struct JsonValue {
+    enum class Kind { Null, Bool, Number, String, Array, Object } kind = Kind::Null;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::map<std::string, JsonValue, std::less<>> object;
+
+    [[nodiscard]] const JsonValue* get(std::string_view key) const {
+        if (kind != Kind::Object) return nullptr;
+        auto it = object.find(key);
+        return it != object.end() ? &it->second : nullptr;
+    }
+};
+
+class JsonReader {
+public:
+    explicit JsonReader(std::string_view text) : text_(text) {}
+
+    /// Parse a single value spanning the whole text
+    std::optional<JsonValue> parse() {
+        JsonValue value;
+        if (!parseValue(value, 0)) return std::nullopt;
+        skipSpace();
+        if (pos_ != text_.size()) return std::nullopt;
+        return value;
+    }
+
+private:
+    static constexpr int kMaxDepth = 64;
+
+    void skipSpace() {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\n' || text_[pos_] == '\r' || text_[pos_] == '\t')) {
+            ++pos_;
+        }
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    bool consumeWord(std::string_view word) {
+        if (text_.substr(pos_, word.size()) != word) return false;
+        pos_ += word.size();
+        return true;
+    }
+
+    bool parseValue(JsonValue& value, int depth) {
+        if (depth > kMaxDepth) return false;
+        skipSpace();
+        if (pos_ >= text_.size()) return false;
+
+        char c = text_[pos_];
+        if (c == '{') return parseObject(value, depth);
+        if (c == '[') return parseArray(value, depth);
+        if (c == '"') {
+            value.kind = JsonValue::Kind::String;
+            return parseString(value.string);
+        }
+        if (consumeWord("true")) {
+            value.kind = JsonValue::Kind::Bool;
+            value.boolean = true;
+            return true;
+        }
+        if (consumeWord("false")) {
+            value.kind = JsonValue::Kind::Bool;
+            return true;
+        }
+        if (consumeWord("null")) {
+            value.kind = JsonValue::Kind::Null;
+            return true;
+        }
+        return parseNumber(value);
+    }
+
+    bool parseObject(JsonValue& value, int depth) {
+        value.kind = JsonValue::Kind::Object;
+        ++pos_;  // '{'
+        if (consume('}')) return true;
+        do {
+            skipSpace();
+            std::string key;
+            if (!parseString(key) || !consume(':')) return false;
+            if (!parseValue(value.object[key], depth + 1)) return false;
+        } while (consume(','));
+        return consume('}');
+    }
+
+    bool parseArray(JsonValue& value, int depth) {
+        value.kind = JsonValue::Kind::Array;
+        ++pos_;  // '['
+        if (consume(']')) return true;
+        do {
+            if (!parseValue(value.array.emplace_back(), depth + 1)) return false;
+        } while (consume(','));
+        return consume(']');
+    }
+
+    bool parseString(std::string& out) {
+        if (pos_ >= text_.size() || text_[pos_] != '"') return false;
+        ++pos_;
+        while (pos_ < text_.size()) {
+            char c = text_[pos_++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ >= text_.size()) return false;
+            switch (char e = text_[pos_++]) {
+                case '"': case '\\': case '/': out += e; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned code = 0;
+                    auto hex = text_.substr(pos_, 4);
+                    auto [ptr, ec] = std::from_chars(hex.data(), hex.data() + hex.size(), code, 16);
+                    if (hex.size() != 4 || ec != std::errc() || ptr != hex.data() + 4) return false;
+                    pos_ += 4;
+                    appendUtf8(out, code);
+                    break;
+                }
+                default: return false;
+            }
+        }
+        return false;  // Unterminated
+    }
+
+    static void appendUtf8(std::string& out, unsigned code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xc0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        } else {
+            out += static_cast<char>(0xe0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        }
+    }
+
+    bool parseNumber(JsonValue& value) {
+        size_t start = pos_;
+        while (pos_ < text_.size() && (std::isdigit(static_cast<unsigned char>(text_[pos_])) ||
+                                       text_[pos_] == '-' || text_[pos_] == '+' ||
+                                       text_[pos_] == '.' || text_[pos_] == 'e' || text_[pos_] == 'E')) {
+            ++pos_;
+        }
+        if (start == pos_) return false;
+        std::istringstream in(std::string(text_.substr(start, pos_ - start)));
+        in.imbue(std::locale::classic());
+        if (!(in >> value.number) || in.peek() != std::char_traits<char>::eof()) return false;
+        value.kind = JsonValue::Kind::Number;
+        return true;
+    }
+
+    std::string_view text_;
+    size_t pos_ = 0;
+};
+
+std::optional<JsonValue> parseJson(std::string_view text) {
+    return JsonReader(text).parse();
+}
+
+std::optional<std::string> readText(const std::filesystem::path& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) return std::nullopt;
+    std::stringstream buffer;
+    buffer << ifs.rdbuf();
+    return buffer.str();
+}
+
+/// Read a non-negative integer field. Missing or mistyped fields fail, as
+/// do fractions and values that do not fit in T (the cast would be undefined).
+template<typename T>
+bool readCount(const JsonValue& object, std::string_view key, T& out) {
+    auto* value = object.get(key);
+    if (!value || value->kind != JsonValue::Kind::Number) return false;
+    double number = value->number;
+    // 2^digits is exact as a double, unlike numeric_limits<T>::max() for 64-bit T
+    const double limit = std::ldexp(1.0, std::numeric_limits<T>::digits);
+    if (!std::isfinite(number) || number < 0 || number >= limit || std::trunc(number) != number) {
+        return false;
+    }
+    out = static_cast<T>(number);
+    return true;
+}
+
+} // anonymous namespace
+
+// ════════════════════════════════════════════════════════════════════════════
+// Shard selection
+// ════════════════════════════════════════════════════════════════════════════
+
+std::optional<ShardSpec> parseShardSpec(std::string_view text) {
+    auto slash = text.find('/');
+    if (slash == std::string_view::npos) return std::nullopt;
+
+    ShardSpec spec;
+    auto parse = [](std::string_view part, uint32_t& out) {
+        auto [ptr, ec] = std::from_chars(part.data(), part.data() + part.size(), out);
+        return !part.empty() && ec == std::errc() && ptr == part.data() + part.size();
+    };
+    if (!parse(text.substr(0, slash), spec.index) || !parse(text.substr(slash + 1), spec.count)) {
+        return std::nullopt;
+    }
+    if (spec.count == 0 || spec.count > kMaxShards || spec.index == 0 || spec.index > spec.count) {
+        return std::nullopt;
+    }
+    return spec;
+}
+
+uint64_t estimateExpansionCost(std::string_view text) {
+    uint64_t instances = 0;
+    for (size_t pos = text.find("AUTOINST"); pos != std::string_view::npos;
+         pos = text.find("AUTOINST", pos + 8)) {
+        ++instances;
+    }
+    return text.size() + instances * kInstanceWeight;
+}
+
+std::optional<std::unordered_map<std::string, uint64_t>> loadStatsCosts(
+    const std::filesystem::path& stats_json) {
+    auto text = readText(stats_json);
+    if (!text) return std::nullopt;
+    auto root = parseJson(*text);
+    if (!root) return std::nullopt;
+
+    auto* files = root->get("files");
+    if (!files || files->kind != JsonValue::Kind::Array) return std::nullopt;
+
+    std::unordered_map<std::string, uint64_t> costs;
+    for (const auto& file : files->array) {
+        auto* path = file.get("path");
+        auto* stats = file.get("stats");
+        if (!path || path->kind != JsonValue::Kind::String || !stats) return std::nullopt;
+
+        uint64_t total = 0;
+        for (auto key : {"parse_us", "elaborate_us", "analyze_us", "write_us"}) {
+            uint64_t us = 0;
+            if (!readCount(*stats, key, us)) return std::nullopt;
+            total += us;
+        }
+        // A file always costs something, even if it ran below the timer resolution
+        costs[path->string] = std::max<uint64_t>(total, 1);
+    }
+    return costs;
+}
+
+std::vector<size_t> selectShard(const std::vector<uint64_t>& costs, ShardSpec shard) {
+    std::vector<size_t> order(costs.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return costs[a] > costs[b]; });
+
+    // Shards are compared by total cost, then by file count, so files with
+    // no measured cost are still spread across shards
+    std::vector<std::pair<uint64_t, size_t>> load(shard.count, {0, 0});
+    std::vector<size_t> selected;
+    for (size_t file : order) {
+        auto lightest = static_cast<uint32_t>(
+            std::min_element(load.begin(), load.end()) - load.begin());
+        load[lightest].first += costs[file];
+        ++load[lightest].second;
+        if (lightest + 1 == shard.index) {
+            selected.push_back(file);
+        }
+    }
+    std::sort(selected.begin(), selected.end());
+    return selected;
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// Shard results
+// ════════════════════════════════════════════════════════════════════════════
+
+std::string toJson(const ShardResult& result) {
+    std::string json = "{\"shard\":" + std::to_string(result.shard) +
+                       ",\"shards\":" + std::to_string(result.shards) +
+                       ",\"exit_code\":" + std::to_string(result.exit_code) +
+                       ",\"files\":" + std::to_string(result.files) +
+                       ",\"files_changed\":" + std::to_string(result.files_changed) +
+                       ",\"autoinst\":" + std::to_string(result.autoinst) +
+                       ",\"autologic\":" + std::to_string(result.autologic) +
+                       ",\"autoports\":" + std::to_string(result.autoports) +
+                       ",\"partial\":" + (result.partial ? "true" : "false") +
+                       ",\"changed\":[";
+    for (size_t i = 0; i < result.changed.size(); ++i) {
+        if (i) json += ',';
+        json += jsonQuote(result.changed[i]);
+    }
+    json += "]}\n";
+    return json;
+}
+
+std::optional<ShardResult> parseShardResult(std::string_view json) {
+    auto root = parseJson(json);
+    if (!root || root->kind != JsonValue::Kind::Object) return std::nullopt;
+
+    ShardResult result;
+    if (!readCount(*root, "shard", result.shard) || !readCount(*root, "shards", result.shards) ||
+        !readCount(*root, "exit_code", result.exit_code) || !readCount(*root, "files", result.files) ||
+        !readCount(*root, "files_changed", result.files_changed) ||
+        !readCount(*root, "autoinst", result.autoinst) ||
+        !readCount(*root, "autologic", result.autologic) ||
+        !readCount(*root, "autoports", result.autoports)) {
+        return std::nullopt;
+    }
+    if (result.shards == 0 || result.shards > kMaxShards || result.shard == 0 ||
+        result.shard > result.shards) {
+        return std::nullopt;
+    }
+    if (auto* partial = root->get("partial")) {
+        if (partial->kind != JsonValue::Kind::Bool) return std::nullopt;
+        result.partial = partial->boolean;
+    }
+
+    auto* changed = root->get("changed");
+    if (!changed || changed->kind != JsonValue::Kind::Array) return std::nullopt;
+    for (const auto& path : changed->array) {
+        if (path.kind != JsonValue::Kind::String) return std::nullopt;
+        result.changed.push_back(path.string);
+    }
+    return result;
+}
+
+ShardResult mergeShardResults(const std::vector<ShardResult>& results,
+                              DiagnosticCollector& diagnostics) {
+    ShardResult merged;
+    merged.shard = 0;
+    merged.shards = results.empty() ? 0 : results.front().shards;
+    if (merged.shards > kMaxShards) {
+        // Results need not come from parseShardResult(); do not size by an unchecked count
+        diagnostics.addError("Shard result claims " + std::to_string(merged.shards) +
+                             " shards; at most " + std::to_string(kMaxShards) + " are supported");
+        merged.shards = 0;
+        merged.exit_code = 1;
+        return merged;
+    }
+
+    // Every result must agree with the first on the shard count
+    std::vector<bool> seen(merged.shards, false);
+    bool consistent = !results.empty();
+    for (const auto& result : results) {
+        if (result.shards != merged.shards || result.shard == 0 || result.shard > merged.shards) {
+            diagnostics.addError("Shard result " + std::to_string(result.shard) + "/" +
+                                 std::to_string(result.shards) + " does not belong to a " +
+                                 std::to_string(merged.shards) + "-shard run");
+            consistent = false;
+            continue;
+        }
+        if (seen[result.shard - 1]) {
+            diagnostics.addError("Duplicate result for shard " + std::to_string(result.shard));
+            consistent = false;
+            continue;
+        }
+        seen[result.shard - 1] = true;
+
+        merged.exit_code = std::max(merged.exit_code, result.exit_code);
+        merged.files += result.files;
+        merged.files_changed += result.files_changed;
+        merged.autoinst += result.autoinst;
+        merged.autologic += result.autologic;
+        merged.autoports += result.autoports;
+        merged.partial = merged.partial || result.partial;
+        merged.changed.insert(merged.changed.end(), result.changed.begin(), result.changed.end());
+    }
+
+    for (uint32_t i = 0; i < merged.shards; ++i) {
+        if (!seen[i]) {
+            diagnostics.addError("Missing result for shard " + std::to_string(i + 1) + "/" +
+                                 std::to_string(merged.shards));
+            consistent = false;
+        }
+    }
+    if (results.empty()) {
+        diagnostics.addError("No shard results to merge");
+    }
+    if (!consistent) {
+        merged.exit_code = std::max(merged.exit_code, 1);
+    }
+
+    std::sort(merged.changed.begin(), merged.changed.end());
+    return merged;
+}
+
+} // namespace slang_autos
@@ -1,8 +1,12 @@
 #include "slang-autos/SignalAggregator.h"
 
 #include <algorithm>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
 
 #include <slang/ast/Scope.h>
+#include <slang/parsing/LexerFacts.h>
 #include <slang/parsing/Parser.h>
 #include <slang/parsing/Preprocessor.h>
 #include <slang/syntax/AllSyntax.h>
@@ -69,23 +73,27 @@ int extractMaxBitFromSelectors(const slang::syntax::SyntaxList<slang::syntax::El
 /// the root/base identifier, not the member or scoped part.
 struct IdentifierCollector : public slang::syntax::SyntaxVisitor<IdentifierCollector> {
     std::vector<std::string> identifiers;
+    std::vector<std::string_view>* views = nullptr;  // If set, names go here instead
     int max_bit_index = -1;  // Track maximum bit index seen across all selects
 
-    // Handle simple identifiers like "sig_a"
-    void handle(const slang::syntax::IdentifierNameSyntax& node) {
-        auto name = node.identifier.valueText();
-        if (!name.empty()) {
+    void add(std::string_view name) {
+        if (name.empty()) return;
+        if (views) {
+            views->push_back(name);
+        } else {
             identifiers.emplace_back(name);
         }
     }
 
+    // Handle simple identifiers like "sig_a"
+    void handle(const slang::syntax::IdentifierNameSyntax& node) {
+        add(node.identifier.valueText());
+    }
+
     // Handle identifiers with bit/part selects like "sig_a[7:0]"
     // IdentifierSelectNameSyntax contains an identifier token and element selects
     void handle(const slang::syntax::IdentifierSelectNameSyntax& node) {
-        auto name = node.identifier.valueText();
-        if (!name.empty()) {
-            identifiers.emplace_back(name);
-        }
+        add(node.identifier.valueText());
         // Extract max bit index from selectors
         int bit = extractMaxBitFromSelectors(node.selectors);
         if (bit > max_bit_index) max_bit_index = bit;
@@ -132,6 +140,108 @@ struct IdentifierCollector : public slang::syntax::SyntaxVisitor<IdentifierColle
     }
 };
 
+/// Hand-written scanner for the expression forms templates produce almost
+/// exclusively: `id`, `id[N]`, `id[M:N]` (selects may repeat) and a flat
+/// `{term, term, ...}` of those. Anything it does not recognize is left to
+/// the slang parser, so the result always matches analyzeExpressionSyntax().
+class SimpleExpressionScanner {
+public:
+    explicit SimpleExpressionScanner(std::string_view text) : text_(text) {}
+
+    bool scan(ExpressionInfo& info) {
+        skipSpace();
+        if (peek() == '{') {
+            ++pos_;
+            info.is_concatenation = true;
+            do {
+                if (!scanTerm(info)) return false;
+            } while (consume(','));
+            if (!consume('}')) return false;
+        } else if (!scanTerm(info)) {
+            return false;
+        }
+        skipSpace();
+        return pos_ == text_.size();
+    }
+
+private:
+    char peek() const { return pos_ < text_.size() ? text_[pos_] : '\0'; }
+
+    void skipSpace() {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\t' ||
+                text_[pos_] == '\n' || text_[pos_] == '\r')) {
+            ++pos_;
+        }
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (peek() != c) return false;
+        ++pos_;
+        return true;
+    }
+
+    static bool isIdentStart(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+
+    static bool isIdentChar(char c) {
+        return isIdentStart(c) || (c >= '0' && c <= '9') || c == '$';
+    }
+
+    /// Identifier followed by any number of constant bit/range selects.
+    bool scanTerm(ExpressionInfo& info) {
+        skipSpace();
+        size_t start = pos_;
+        if (!isIdentStart(peek())) return false;
+        while (isIdentChar(peek())) ++pos_;
+        std::string_view name = text_.substr(start, pos_ - start);
+
+        // Keywords parse as something other than a name
+        static const auto* keywords = slang::parsing::LexerFacts::getKeywordTable(
+            slang::parsing::KeywordVersion::v1800_2017);
+        if (keywords->find(name) != keywords->end()) return false;
+
+        while (consume('[')) {
+            int left = 0;
+            if (!scanIndex(left)) return false;
+            info.max_bit_index = std::max(info.max_bit_index, left);
+            if (consume(':')) {
+                int right = 0;
+                if (!scanIndex(right)) return false;
+                info.max_bit_index = std::max(info.max_bit_index, right);
+            }
+            if (!consume(']')) return false;
+        }
+
+        info.identifiers.emplace_back(name);
+        return true;
+    }
+
+    /// Plain decimal literal. Values that do not fit in an int become -1,
+    /// as tryExtractIntegerLiteral() does.
+    bool scanIndex(int& value) {
+        skipSpace();
+        size_t start = pos_;
+        long long parsed = 0;
+        while (peek() >= '0' && peek() <= '9') {
+            if (parsed <= std::numeric_limits<int>::max()) {
+                parsed = parsed * 10 + (peek() - '0');
+            }
+            ++pos_;
+        }
+        if (pos_ == start) return false;
+        // Underscores, bases and reals need the real lexer
+        if (isIdentChar(peek()) || peek() == '\'' || peek() == '.') return false;
+        value = parsed <= std::numeric_limits<int>::max() ? static_cast<int>(parsed) : -1;
+        return true;
+    }
+
+    std::string_view text_;
+    size_t pos_ = 0;
+};
+
 } // anonymous namespace
 
 bool isVerilogConstant(const std::string& s) {
@@ -174,30 +284,36 @@ std::vector<std::string> extractIdentifiersFromSyntax(const slang::syntax::Synta
     return collector.identifiers;
 }
 
-std::vector<std::string> extractIdentifiers(const std::string& expr) {
-    if (expr.empty()) return {};
-
-    // Trim whitespace
-    size_t start = expr.find_first_not_of(" \t\n\r");
-    if (start == std::string::npos) return {};
-
-    // Parse the expression using slang
-    slang::BumpAllocator alloc;
-    slang::Diagnostics diagnostics;
-    slang::SourceManager sourceManager;
+void extractIdentifierViewsFromSyntax(const slang::syntax::SyntaxNode& node,
+                                      std::vector<std::string_view>& out) {
+    IdentifierCollector collector;
+    collector.views = &out;
+    node.visit(collector);
+}
 
-    slang::parsing::Preprocessor preprocessor(sourceManager, alloc, diagnostics);
-    preprocessor.pushSource(expr);
+ExpressionInfo analyzeExpressionSyntax(const slang::syntax::SyntaxNode& node) {
+    IdentifierCollector collector;
+    node.visit(collector);
 
-    slang::parsing::Parser parser(preprocessor);
-    auto& exprSyntax = parser.parseExpression();
+    ExpressionInfo info;
+    info.identifiers = std::move(collector.identifiers);
+    info.max_bit_index = collector.max_bit_index;
+    info.is_concatenation = node.kind == slang::syntax::SyntaxKind::ConcatenationExpression;
+    return info;
+}
 
-    // Use the shared implementation
-    return extractIdentifiersFromSyntax(exprSyntax);
+std::optional<ExpressionInfo> analyzeSimpleExpression(std::string_view expr) {
+    ExpressionInfo info;
+    if (!SimpleExpressionScanner(expr).scan(info)) return std::nullopt;
+    return info;
 }
 
-int extractMaxBitIndex(const std::string& expr) {
-    if (expr.empty()) return -1;
+ExpressionInfo analyzeExpression(std::string_view expr) {
+    // Skip the parser entirely for blank expressions
+    if (expr.find_first_not_of(" \t\n\r") == std::string_view::npos) return {};
+
+    // Plain names, constant selects and flat concatenations need no parser
+    if (auto simple = analyzeSimpleExpression(expr)) return std::move(*simple);
 
     // Parse the expression using slang
     slang::BumpAllocator alloc;
@@ -208,124 +324,151 @@ int extractMaxBitIndex(const std::string& expr) {
     preprocessor.pushSource(expr);
 
     slang::parsing::Parser parser(preprocessor);
-    auto& exprSyntax = parser.parseExpression();
+    return analyzeExpressionSyntax(parser.parseExpression());
+}
 
-    // Visit the syntax tree to find max bit index
-    IdentifierCollector collector;
-    exprSyntax.visit(collector);
-    return collector.max_bit_index;
+std::vector<std::string> extractIdentifiers(const std::string& expr) {
+    return analyzeExpression(expr).identifiers;
 }
 
-bool isConcatenation(const std::string& expr) {
-    if (expr.empty()) return false;
+int extractMaxBitIndex(const std::string& expr) {
+    return analyzeExpression(expr).max_bit_index;
+}
 
-    // Parse the expression using slang
-    slang::BumpAllocator alloc;
-    slang::Diagnostics diagnostics;
-    slang::SourceManager sourceManager;
+bool isConcatenation(const std::string& expr) {
+    return analyzeExpression(expr).is_concatenation;
+}
 
-    slang::parsing::Preprocessor preprocessor(sourceManager, alloc, diagnostics);
-    preprocessor.pushSource(expr);
+const ExpressionInfo& ExpressionCache::get(std::string_view expr) {
+    SymbolId id = texts_.find(expr);
+    if (id != StringPool::npos) {
+        ++hits_;
+        return results_[id];
+    }
 
-    slang::parsing::Parser parser(preprocessor);
-    auto& exprSyntax = parser.parseExpression();
+    ++misses_;
+    texts_.intern(expr);
+    return results_.emplace_back(analyzeExpression(expr));
+}
 
-    // Check if the top-level expression is a concatenation
-    return exprSyntax.kind == slang::syntax::SyntaxKind::ConcatenationExpression;
+void ExpressionCache::clear() {
+    texts_.clear();
+    results_.clear();
+    hits_ = 0;
+    misses_ = 0;
 }
 
 // ============================================================================
 // SignalAggregator Implementation
 // ============================================================================
 
+SignalAggregator::SignalAggregator() {
+    ranges_.intern("");  // ID 0 = no range
+}
+
 void SignalAggregator::addFromInstance(
     const std::string& inst_name,
     const std::vector<PortConnection>& connections,
     const std::vector<PortInfo>& ports) {
 
+    // A brand-new instance cannot already be listed on any net, so duplicate
+    // checks reduce to comparing with the last entry (nets repeat within one
+    // instance only through concatenations or bit-selects).
+    bool new_instance = inst_names_.find(inst_name) == StringPool::npos;
+    InstId inst_id = inst_names_.intern(inst_name);
+
+    // Index ports by name once instead of searching per connection
+    std::unordered_map<std::string_view, const PortInfo*> port_index;
+    port_index.reserve(ports.size());
+    for (const auto& port : ports) {
+        port_index.emplace(port.name, &port);
+    }
+
     for (const auto& conn : connections) {
         // Skip unconnected and constant ports
         if (conn.is_unconnected || conn.is_constant) {
             continue;
         }
 
-        // Find the port info to get width
-        auto port_it = std::find_if(ports.begin(), ports.end(),
-            [&](const PortInfo& p) { return p.name == conn.port_name; });
+        // Use pre-extracted signal identifiers
+        // These were populated at connection creation time
+        if (conn.signal_identifiers.empty()) {
+            continue;
+        }
 
-        if (port_it == ports.end()) {
+        // Find the port info to get width
+        auto port_it = port_index.find(conn.port_name);
+        if (port_it == port_index.end()) {
             continue;
         }
+        const PortInfo& port = *port_it->second;
 
-        int port_width = port_it->width;
         // Get both original syntax and resolved range (preserves packed array structure)
-        std::string original_range = port_it->getRangeStr(true);   // e.g., "[WIDTH-1:0][3:0]"
-        std::string resolved_range = port_it->getRangeStr(false);  // e.g., "[7:0][3:0]"
-        std::string array_dims = port_it->getArrayDims();          // e.g., " [3:0]" (unpacked)
-
-        // Extract max bit index from signal expression (e.g., signal[7] -> 7)
-        // This handles cases where templates map multiple ports to different
-        // bits of the same signal: data_in([0-9]) => data_bus[$1]
-        int max_bit = extractMaxBitIndex(conn.signal_expr);
-        int effective_width = port_width;
-        std::string effective_original_range = original_range;
-        std::string effective_resolved_range = resolved_range;
-        std::string effective_array_dims = array_dims;
-
+        int effective_width = port.width;
+        SymbolId original_range = ranges_.intern(port.getRangeStr(true));   // e.g., "[WIDTH-1:0][3:0]"
+        SymbolId resolved_range = ranges_.intern(port.getRangeStr(false));  // e.g., "[7:0][3:0]"
+        SymbolId array_dims = ranges_.intern(port.getArrayDims());          // e.g., " [3:0]" (unpacked)
+
+        // Max bit index of the signal expression (e.g., signal[7] -> 7), computed
+        // when the connection was built. This handles cases where templates map
+        // multiple ports to different bits of the same signal:
+        // data_in([0-9]) => data_bus[$1]
+        int max_bit = conn.max_bit_index;
         if (max_bit >= 0) {
             // If bit index is specified, required width is max_bit + 1
             int required_width = max_bit + 1;
             if (required_width > effective_width) {
                 effective_width = required_width;
                 // Generate range string for the computed width (loses packed array structure)
-                std::string computed_range = "[" + std::to_string(max_bit) + ":0]";
-                effective_original_range = computed_range;
-                effective_resolved_range = computed_range;
-                effective_array_dims = "";  // Lose unpacked dims when width is overridden
+                SymbolId computed_range = ranges_.intern("[" + std::to_string(max_bit) + ":0]");
+                original_range = computed_range;
+                resolved_range = computed_range;
+                array_dims = 0;  // Lose unpacked dims when width is overridden
             }
         }
 
-        // Use pre-extracted signal identifiers
-        // These were populated at connection creation time
-        if (conn.signal_identifiers.empty()) {
-            continue;
-        }
-
         // Process each extracted signal
         for (const auto& net_name : conn.signal_identifiers) {
-            // Get or create net usage entry
-            auto& usage = nets_[net_name];
-            if (usage.info.name.empty()) {
-                usage.info.name = net_name;
-                usage.info.width = effective_width;
-                usage.info.original_range_str = effective_original_range;
-                usage.info.range_str = effective_resolved_range;
-                usage.info.array_dims = effective_array_dims;
-                usage.info.first_seen_order = next_order_++;
-                if (effective_width > 1) {
-                    usage.info.msb = effective_width - 1;
-                    usage.info.lsb = 0;
-                }
-            } else {
+            // Get or create the net record
+            NetId id = net_names_.intern(net_name);
+            if (id == nets_.size()) {
+                NetRecord& created = nets_.emplace_back();
+                created.width = effective_width;
+                created.original_range = original_range;
+                created.resolved_range = resolved_range;
+                created.array_dims = array_dims;
+            } else if (effective_width > nets_[id].width) {
                 // Merge - take max width, keep ranges from widest
-                usage.info.merge(effective_width, effective_original_range, effective_resolved_range, effective_array_dims);
+                NetRecord& widened = nets_[id];
+                widened.width = effective_width;
+                if (original_range != 0) widened.original_range = original_range;
+                if (resolved_range != 0) widened.resolved_range = resolved_range;
+                if (array_dims != 0) widened.array_dims = array_dims;
             }
+            NetRecord& net = nets_[id];
 
             // Track instance source
-            if (std::find(usage.source_instances.begin(), usage.source_instances.end(), inst_name)
-                == usage.source_instances.end()) {
-                usage.source_instances.push_back(inst_name);
+            auto& sources = net.source_instances;
+            bool listed = new_instance
+                ? (!sources.empty() && sources.back() == inst_id)
+                : std::find(sources.begin(), sources.end(), inst_id) != sources.end();
+            if (!listed) {
+                sources.push_back(inst_id);
             }
 
             // Track direction usage
-            if (conn.direction == "output") {
-                usage.driven_by_instance = true;
-            } else if (conn.direction == "input") {
-                usage.consumed_by_instance = true;
-            } else if (conn.direction == "inout") {
-                usage.driven_by_instance = true;
-                usage.consumed_by_instance = true;
-                inout_nets_.insert(net_name);
+            switch (conn.direction) {
+                case PortDirection::Output:
+                    net.driven_by_instance = true;
+                    break;
+                case PortDirection::Input:
+                    net.consumed_by_instance = true;
+                    break;
+                case PortDirection::Inout:
+                    net.driven_by_instance = true;
+                    net.consumed_by_instance = true;
+                    net.is_inout = true;
+                    break;
             }
 
             // Mark signals from OUTPUT concatenations as internal-only
@@ -333,89 +476,99 @@ void SignalAggregator::addFromInstance(
             // are receiving parts of the output - they're internal wires.
             // But when an input port connects to {sig_a, sig_b}, those signals
             // are being combined as input - they should be ports.
-            if (conn.is_concatenation && conn.direction == "output") {
-                concatenation_nets_.insert(net_name);
+            if (conn.is_concatenation && conn.direction == PortDirection::Output) {
+                net.from_output_concat = true;
             }
         }
     }
 }
 
-// nets_ is an unordered_map, so iteration order is unstable. Sort the returned
-// vector by first_seen_order so callers receive nets in declaration order
-// (i.e. the order each net was first encountered while walking instances).
-static void sortByFirstSeen(std::vector<NetInfo>& nets) {
-    std::sort(nets.begin(), nets.end(),
-        [](const NetInfo& a, const NetInfo& b) {
-            return a.first_seen_order < b.first_seen_order;
-        });
+NetInfo SignalAggregator::makeNetInfo(NetId id) const {
+    const NetRecord& net = nets_[id];
+    NetInfo info(std::string(net_names_.str(id)), net.width,
+                 std::string(ranges_.str(net.original_range)),
+                 std::string(ranges_.str(net.resolved_range)),
+                 std::string(ranges_.str(net.array_dims)));
+    info.first_seen_order = static_cast<int>(id);
+    return info;
 }
 
+// NetIds are assigned in first-seen order, so walking nets_ by index yields
+// nets in declaration order (the order each net was first encountered while
+// walking instances) without sorting.
+
 std::vector<NetInfo> SignalAggregator::getExternalInputNets() const {
     std::vector<NetInfo> result;
-    for (const auto& [name, usage] : nets_) {
+    for (NetId id = 0; id < nets_.size(); ++id) {
+        const NetRecord& net = nets_[id];
         // External input: consumed by instance input but NOT driven by any instance output
         // Exclude signals from concatenations (those are internal wires)
-        if (usage.consumed_by_instance && !usage.driven_by_instance &&
-            concatenation_nets_.find(name) == concatenation_nets_.end()) {
-            result.push_back(usage.info);
+        if (net.consumed_by_instance && !net.driven_by_instance && !net.from_output_concat) {
+            result.push_back(makeNetInfo(id));
         }
     }
-    sortByFirstSeen(result);
     return result;
 }
 
 std::vector<NetInfo> SignalAggregator::getExternalOutputNets() const {
     std::vector<NetInfo> result;
-    for (const auto& [name, usage] : nets_) {
+    for (NetId id = 0; id < nets_.size(); ++id) {
+        const NetRecord& net = nets_[id];
         // External output: driven by instance output but NOT consumed by any instance input
         // Also exclude inouts and signals from concatenations (those are internal wires)
-        if (usage.driven_by_instance && !usage.consumed_by_instance &&
-            inout_nets_.find(name) == inout_nets_.end() &&
-            concatenation_nets_.find(name) == concatenation_nets_.end()) {
-            result.push_back(usage.info);
+        if (net.driven_by_instance && !net.consumed_by_instance &&
+            !net.is_inout && !net.from_output_concat) {
+            result.push_back(makeNetInfo(id));
         }
     }
-    sortByFirstSeen(result);
     return result;
 }
 
 std::vector<NetInfo> SignalAggregator::getInoutNets() const {
     std::vector<NetInfo> result;
-    for (const auto& net_name : inout_nets_) {
-        auto it = nets_.find(net_name);
-        if (it != nets_.end()) {
-            result.push_back(it->second.info);
+    for (NetId id = 0; id < nets_.size(); ++id) {
+        if (nets_[id].is_inout) {
+            result.push_back(makeNetInfo(id));
         }
     }
-    sortByFirstSeen(result);
     return result;
 }
 
 std::vector<NetInfo> SignalAggregator::getInternalNets() const {
     std::vector<NetInfo> result;
-    for (const auto& [name, usage] : nets_) {
+    for (NetId id = 0; id < nets_.size(); ++id) {
+        const NetRecord& net = nets_[id];
         // Internal net: driven by instance output AND consumed by instance input
         // Excludes inouts (those are external bidirectional ports)
-        bool is_internal = usage.driven_by_instance && usage.consumed_by_instance &&
-                          inout_nets_.find(name) == inout_nets_.end();
+        bool is_internal = net.driven_by_instance && net.consumed_by_instance && !net.is_inout;
 
         // Also include signals from concatenations - these are internal wires
         // that need AUTOLOGIC declarations even if not both driven and consumed
-        bool is_concat_signal = concatenation_nets_.find(name) != concatenation_nets_.end();
-
-        if (is_internal || is_concat_signal) {
-            result.push_back(usage.info);
+        if (is_internal || net.from_output_concat) {
+            result.push_back(makeNetInfo(id));
         }
     }
     return result;
 }
 
-const NetInfo* SignalAggregator::getNetInfo(const std::string& name) const {
-    auto it = nets_.find(name);
-    if (it != nets_.end()) {
-        return &it->second.info;
+std::optional<NetInfo> SignalAggregator::getNetInfo(std::string_view name) const {
+    NetId id = net_names_.find(name);
+    if (id == StringPool::npos) {
+        return std::nullopt;
     }
-    return nullptr;
+    return makeNetInfo(id);
+}
+
+std::vector<std::string> SignalAggregator::getSourceInstances(std::string_view name) const {
+    std::vector<std::string> result;
+    NetId id = net_names_.find(name);
+    if (id == StringPool::npos) {
+        return result;
+    }
+    for (InstId inst : nets_[id].source_instances) {
+        result.emplace_back(inst_names_.str(inst));
+    }
+    return result;
 }
 
 void SignalAggregator::addUnusedSignal(const std::string& name, int width) {
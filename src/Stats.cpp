@@ -0,0 +1,103 @@
+#include "slang-autos/Stats.h"
+
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace slang_autos {
+
+ExpansionStats& ExpansionStats::operator+=(const ExpansionStats& other) {
+    parse_us += other.parse_us;
+    elaborate_us += other.elaborate_us;
+    analyze_us += other.analyze_us;
+    write_us += other.write_us;
+    port_cache_hits += other.port_cache_hits;
+    port_cache_misses += other.port_cache_misses;
+    rule_evaluations += other.rule_evaluations;
+    regex_compilations += other.regex_compilations;
+    bytes_read += other.bytes_read;
+    bytes_written += other.bytes_written;
+    replacements += other.replacements;
+    peak_rss_bytes = std::max(peak_rss_bytes, other.peak_rss_bytes);
+    return *this;
+}
+
+ArenaStats& ArenaStats::operator+=(const ArenaStats& other) {
+    modules += other.modules;
+    allocations += other.allocations;
+    bytes += other.bytes;
+    heap_allocations += other.heap_allocations;
+    peak_module_bytes = std::max(peak_module_bytes, other.peak_module_bytes);
+    return *this;
+}
+
+size_t peakRssBytes() {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss);          // bytes
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;   // kilobytes
+#endif
+#else
+    return 0;
+#endif
+}
+
+std::string jsonQuote(std::string_view text) {
+    std::string out;
+    out.reserve(text.size() + 2);
+    out += '"';
+    for (char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    constexpr char hex[] = "0123456789abcdef";
+                    out += "\\u00";
+                    out += hex[(c >> 4) & 0xf];
+                    out += hex[c & 0xf];
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+    return out;
+}
+
+std::string toJson(const ExpansionStats& stats) {
+    std::string out = "{";
+    auto field = [&out](std::string_view name, uint64_t value) {
+        if (out.size() > 1) out += ',';
+        out += '"';
+        out += name;
+        out += "\":";
+        out += std::to_string(value);
+    };
+    field("parse_us", stats.parse_us);
+    field("elaborate_us", stats.elaborate_us);
+    field("analyze_us", stats.analyze_us);
+    field("write_us", stats.write_us);
+    field("port_cache_hits", stats.port_cache_hits);
+    field("port_cache_misses", stats.port_cache_misses);
+    field("rule_evaluations", stats.rule_evaluations);
+    field("regex_compilations", stats.regex_compilations);
+    field("bytes_read", stats.bytes_read);
+    field("bytes_written", stats.bytes_written);
+    field("replacements", stats.replacements);
+    field("peak_rss_bytes", stats.peak_rss_bytes);
+    out += '}';
+    return out;
+}
+
+} // namespace slang_autos
@@ -0,0 +1,63 @@
+#include "slang-autos/StringPool.h"
+
+#include <functional>
+
+namespace slang_autos {
+
+size_t StringPool::probe(std::string_view s, size_t hash) const {
+    size_t mask = slots_.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        SymbolId id = slots_[i];
+        if (id == npos || (hashes_[id] == hash && strings_[id] == s)) {
+            return i;
+        }
+    }
+}
+
+SymbolId StringPool::find(std::string_view s) const {
+    if (slots_.empty()) {
+        return npos;
+    }
+    return slots_[probe(s, std::hash<std::string_view>{}(s))];
+}
+
+SymbolId StringPool::intern(std::string_view s) {
+    // Keep the load factor at or below 1/2 so probe sequences stay short
+    if ((strings_.size() + 1) * 2 > slots_.size()) {
+        grow();
+    }
+
+    size_t hash = std::hash<std::string_view>{}(s);
+    size_t slot = probe(s, hash);
+    if (slots_[slot] != npos) {
+        return slots_[slot];
+    }
+
+    auto id = static_cast<SymbolId>(strings_.size());
+    strings_.emplace_back(s);
+    hashes_.push_back(hash);
+    slots_[slot] = id;
+    return id;
+}
+
+void StringPool::grow() {
+    size_t size = slots_.empty() ? 16 : slots_.size() * 2;
+    slots_.assign(size, npos);
+
+    size_t mask = size - 1;
+    for (SymbolId id = 0; id < strings_.size(); ++id) {
+        size_t i = hashes_[id] & mask;
+        while (slots_[i] != npos) {
+            i = (i + 1) & mask;
+        }
+        slots_[i] = id;
+    }
+}
+
+void StringPool::clear() {
+    strings_.clear();
+    hashes_.clear();
+    slots_.clear();
+}
+
+} // namespace slang_autos
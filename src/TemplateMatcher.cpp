@@ -39,42 +39,46 @@ bool TemplateMatcher::setInstance(const std::string& instance_name) {
 
     // Match instance name against template's instance pattern
     // Default pattern extracts first number from instance name (verilog-mode compatible)
-    try {
-        std::smatch match;
-        bool use_default = template_->instance_pattern.empty();
-
-        if (use_default) {
-            // Default: search for first number anywhere in instance name
-            std::regex default_pattern("([0-9]+)");
-            if (std::regex_search(instance_name, match, default_pattern)) {
-                inst_captures_.push_back(match[1].str());
-            }
-            return true;
+    std::smatch match;
+    if (template_->instance_pattern.empty()) {
+        // Default: search for first number anywhere in instance name
+        static const std::regex default_pattern("([0-9]+)");
+        if (std::regex_search(instance_name, match, default_pattern)) {
+            inst_captures_.push_back(match[1].str());
         }
+        return true;
+    }
 
-        // User-provided pattern: match entire instance name
-        std::regex pattern(template_->instance_pattern);
-        if (std::regex_match(instance_name, match, pattern)) {
-            // Extract capture groups (skip match[0] which is full match)
-            for (size_t i = 1; i < match.size(); ++i) {
-                inst_captures_.push_back(match[i].str());
+    // User-provided pattern: compiled once per matcher
+    if (!inst_pattern_compiled_) {
+        inst_pattern_compiled_ = true;
+        ++stats_.regex_compilations;
+        try {
+            inst_pattern_.emplace(template_->instance_pattern);
+        } catch (const std::regex_error& e) {
+            if (diagnostics_) {
+                diagnostics_->addWarning(
+                    "Invalid regex in instance pattern '" + template_->instance_pattern +
+                    "': " + e.what() + ". Treating as literal match.",
+                    "", 0, "template_regex");
             }
-            return true;
-        } else {
-            // Pattern didn't match - still use template but no captures
-            inst_captures_.clear();
-            return true;
-        }
-    } catch (const std::regex_error& e) {
-        // Invalid regex - warn and treat as literal match
-        if (diagnostics_) {
-            diagnostics_->addWarning(
-                "Invalid regex in instance pattern '" + template_->instance_pattern +
-                "': " + e.what() + ". Treating as literal match.",
-                "", 0, "template_regex");
         }
+    }
+
+    if (!inst_pattern_) {
+        // Invalid regex - treat as literal match
         return instance_name == template_->instance_pattern;
     }
+
+    // Match entire instance name
+    if (std::regex_match(instance_name, match, *inst_pattern_)) {
+        // Extract capture groups (skip match[0] which is full match)
+        for (size_t i = 1; i < match.size(); ++i) {
+            inst_captures_.push_back(match[i].str());
+        }
+    }
+    // Pattern didn't match - still use template but no captures
+    return true;
 }
 
 const std::regex* TemplateMatcher::getOrCompileRegex(const std::string& pattern) {
@@ -90,6 +94,7 @@ const std::regex* TemplateMatcher::getOrCompileRegex(const std::string& pattern)
     }
 
     // Try to compile the regex
+    ++stats_.regex_compilations;
     try {
         auto [inserted_it, success] = regex_cache_.emplace(pattern, std::regex(pattern));
         return &inserted_it->second;
@@ -118,6 +123,7 @@ MatchResult TemplateMatcher::matchPort(const PortInfo& port) {
         const std::regex* pattern = getOrCompileRegex(rule.port_pattern);
 
         if (pattern) {
+            ++stats_.rule_evaluations;
             std::smatch match;
 
             if (std::regex_match(port.name, match, *pattern)) {
@@ -133,7 +139,7 @@ MatchResult TemplateMatcher::matchPort(const PortInfo& port) {
                 signal_name = evaluateTernary(signal_name);
 
                 // Warn if assigning a constant to an output port
-                if (diagnostics_ && port.direction == "output" &&
+                if (diagnostics_ && port.direction == PortDirection::Output &&
                     (signal_name == "'0" || signal_name == "'1" || signal_name == "'z")) {
                     diagnostics_->addWarning(
                         "Constant '" + signal_name + "' assigned to output port '" + port.name +
@@ -154,7 +160,7 @@ MatchResult TemplateMatcher::matchPort(const PortInfo& port) {
                 signal_name = evaluateTernary(signal_name);
 
                 // Warn if assigning a constant to an output port
-                if (diagnostics_ && port.direction == "output" &&
+                if (diagnostics_ && port.direction == PortDirection::Output &&
                     (signal_name == "'0" || signal_name == "'1" || signal_name == "'z")) {
                     diagnostics_->addWarning(
                         "Constant '" + signal_name + "' assigned to output port '" + port.name +
@@ -252,12 +258,12 @@ std::string TemplateMatcher::substitute(
             result.replace(pos, 10, port.range_str);
         }
         while ((pos = result.find("port.direction")) != std::string::npos) {
-            result.replace(pos, 14, port.direction);
+            result.replace(pos, 14, toString(port.direction));
         }
         // Direction boolean variables (for ternary expressions)
-        std::string is_input = (port.direction == "input") ? "1" : "0";
-        std::string is_output = (port.direction == "output") ? "1" : "0";
-        std::string is_inout = (port.direction == "inout") ? "1" : "0";
+        std::string is_input = (port.direction == PortDirection::Input) ? "1" : "0";
+        std::string is_output = (port.direction == PortDirection::Output) ? "1" : "0";
+        std::string is_inout = (port.direction == PortDirection::Inout) ? "1" : "0";
 
         while ((pos = result.find("port.input")) != std::string::npos) {
             result.replace(pos, 10, is_input);
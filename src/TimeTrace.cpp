@@ -0,0 +1,125 @@
+#include "slang-autos/TimeTrace.h"
+#include "slang-autos/Stats.h"
+
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace slang_autos {
+
+namespace {
+
+struct TraceEvent {
+    std::string_view name;   ///< Static span names only
+    std::string detail;
+    long long start_us = 0;  ///< Relative to the trace start
+    long long dur_us = 0;
+    size_t tid = 0;
+};
+
+struct TraceState {
+    std::atomic<bool> enabled{false};
+    std::mutex mutex;
+    std::chrono::steady_clock::time_point origin;
+    std::vector<TraceEvent> events;
+    std::unordered_map<std::thread::id, size_t> thread_ids;  ///< Dense per-thread track numbers
+};
+
+TraceState& state() {
+    static TraceState s;
+    return s;
+}
+
+} // anonymous namespace
+
+void timeTraceBegin() {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.events.clear();
+    s.thread_ids.clear();
+    s.thread_ids.emplace(std::this_thread::get_id(), 0);  // Calling thread is track 0
+    s.origin = std::chrono::steady_clock::now();
+    s.enabled.store(true, std::memory_order_relaxed);
+}
+
+bool timeTraceEnabled() {
+    return state().enabled.load(std::memory_order_relaxed);
+}
+
+bool timeTraceWrite(const std::filesystem::path& file) {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.enabled.store(false, std::memory_order_relaxed);
+
+    std::string json;
+    json.reserve(64 + s.events.size() * 96);
+    json += "{\"traceEvents\":[";
+    bool first = true;
+    for (const auto& ev : s.events) {
+        if (!first) json += ',';
+        first = false;
+        json += "\n{\"ph\":\"X\",\"pid\":1,\"tid\":";
+        json += std::to_string(ev.tid);
+        json += ",\"ts\":";
+        json += std::to_string(ev.start_us);
+        json += ",\"dur\":";
+        json += std::to_string(ev.dur_us);
+        json += ",\"name\":";
+        json += jsonQuote(ev.name);
+        if (!ev.detail.empty()) {
+            json += ",\"args\":{\"detail\":";
+            json += jsonQuote(ev.detail);
+            json += '}';
+        }
+        json += '}';
+    }
+    json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    s.events.clear();
+    s.thread_ids.clear();
+
+    std::ofstream ofs(file, std::ios::binary);
+    if (!ofs) {
+        return false;
+    }
+    ofs << json;
+    return static_cast<bool>(ofs);
+}
+
+TimeTraceScope::TimeTraceScope(std::string_view name, std::string_view detail) {
+    if (!timeTraceEnabled()) {
+        return;
+    }
+    active_ = true;
+    name_ = name;
+    detail_ = detail;
+    start_ = std::chrono::steady_clock::now();
+}
+
+TimeTraceScope::~TimeTraceScope() {
+    if (!active_) {
+        return;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (!s.enabled.load(std::memory_order_relaxed)) {
+        return;  // Trace was written while this scope was open
+    }
+
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    TraceEvent ev;
+    ev.name = name_;
+    ev.detail = std::move(detail_);
+    ev.start_us = duration_cast<microseconds>(start_ - s.origin).count();
+    ev.dur_us = duration_cast<microseconds>(end - start_).count();
+    ev.tid = s.thread_ids.try_emplace(std::this_thread::get_id(), s.thread_ids.size()).first->second;
+    s.events.push_back(std::move(ev));
+}
+
+} // namespace slang_autos
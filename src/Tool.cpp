@@ -1,8 +1,11 @@
 #include "slang-autos/Tool.h"
 #include "slang-autos/AutosAnalyzer.h"
 #include "slang-autos/Constants.h"
+#include "slang-autos/TimeTrace.h"
 #include "slang-autos/Writer.h"
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <sstream>
 
@@ -12,6 +15,29 @@
 
 namespace slang_autos {
 
+namespace {
+
+/// Adds the wall time of its scope to an ExpansionStats field
+class StatTimer {
+public:
+    explicit StatTimer(uint64_t& field)
+        : field_(field), start_(std::chrono::steady_clock::now()) {}
+    ~StatTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        field_ += static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    }
+
+    StatTimer(const StatTimer&) = delete;
+    StatTimer& operator=(const StatTimer&) = delete;
+
+private:
+    uint64_t& field_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // anonymous namespace
+
 AutosTool::AutosTool()
     : options_{} {
 }
@@ -26,40 +52,18 @@ AutosTool::AutosTool(AutosTool&&) noexcept = default;
 AutosTool& AutosTool::operator=(AutosTool&&) noexcept = default;
 
 bool ExpansionResult::hasNonWhitespaceChanges() const {
+    if (streamed) {
+        return streamed->non_whitespace;
+    }
     // Compare original and modified content ignoring whitespace differences.
     // This allows formatters (e.g. verible-verilog-format) to reindent
     // AUTO-generated code without --check reporting false positives.
-    auto skipWs = [](const std::string& s, size_t pos) {
-        while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\t'))
-            ++pos;
-        return pos;
-    };
-
-    size_t i = 0, j = 0;
-    while (i < original_content.size() && j < modified_content.size()) {
-        // At start of line or after newline, skip whitespace in both
-        if (original_content[i] == ' ' || original_content[i] == '\t') {
-            i = skipWs(original_content, i);
-            j = skipWs(modified_content, j);
-            continue;
-        }
-        if (modified_content[j] == ' ' || modified_content[j] == '\t') {
-            i = skipWs(original_content, i);
-            j = skipWs(modified_content, j);
-            continue;
-        }
-        if (original_content[i] != modified_content[j])
-            return true;
-        ++i;
-        ++j;
-    }
-    // Skip any trailing whitespace
-    i = skipWs(original_content, i);
-    j = skipWs(modified_content, j);
-    return i != original_content.size() || j != modified_content.size();
+    return differsIgnoringWhitespace(original_content, modified_content);
 }
 
 bool AutosTool::loadWithArgs(const std::vector<std::string>& args) {
+    load_args_ = args;
+
     // Create driver
     driver_ = std::make_unique<slang::driver::Driver>();
 
@@ -86,17 +90,60 @@ bool AutosTool::loadWithArgs(const std::vector<std::string>& args) {
     }
 
     // Parse all sources (including library files on demand)
+    if (!reportProgress(ExpansionPhase::Parse)) {
+        diagnostics_.addError("Loading cancelled");
+        return false;
+    }
     if (!driver_->parseAllSources()) {
         diagnostics_.addError("Failed to parse sources");
         return false;
     }
 
     // Create compilation using driver (properly handles library resolution)
+    if (!reportProgress(ExpansionPhase::Elaborate)) {
+        diagnostics_.addError("Loading cancelled");
+        return false;
+    }
     compilation_ = driver_->createCompilation();
+    port_cache_.clear();
 
     return true;
 }
 
+bool AutosTool::reload(const std::vector<std::filesystem::path>& changed_files) {
+    if (load_args_.empty()) {
+        diagnostics_.addError("No design loaded - call loadWithArgs first");
+        return false;
+    }
+
+    // loadWithArgs() clears the cache for a new design; keep what is still valid
+    PortCache kept = std::move(port_cache_);
+    auto args = load_args_;
+    diagnostics_.clear();
+    bool loaded = loadWithArgs(args);
+    if (loaded) {
+        for (const auto& file : changed_files) {
+            kept.eraseSource(file);
+        }
+    } else {
+        kept.clear();
+    }
+    port_cache_ = std::move(kept);  // Snapshots are kept either way
+    return loaded;
+}
+
+std::vector<std::filesystem::path> AutosTool::sourceFiles() const {
+    std::vector<std::filesystem::path> files;
+    if (!driver_) return files;
+    for (auto buffer : driver_->sourceManager.getAllBuffers()) {
+        const auto& full_path = driver_->sourceManager.getFullPath(buffer);
+        if (!full_path.empty()) {
+            files.push_back(full_path);
+        }
+    }
+    return files;
+}
+
 void AutosTool::setCompilation(std::unique_ptr<slang::ast::Compilation> compilation) {
     compilation_ = std::move(compilation);
     port_cache_.clear();
@@ -106,33 +153,180 @@ ExpansionResult AutosTool::expandFile(
     const std::filesystem::path& file,
     bool dry_run) {
 
-    ExpansionResult result;
-
     // ─────────────────────────────────────────────────────────────────────────
     // Read source file
     // ─────────────────────────────────────────────────────────────────────────
     std::ifstream ifs(file);
     if (!ifs) {
         diagnostics_.addError("Failed to open file: " + file.string());
+        ExpansionResult result;
         result.success = false;
         return result;
     }
 
     std::stringstream buffer;
     buffer << ifs.rdbuf();
-    result.original_content = buffer.str();
+
+    ExpansionResult result = expandContent(file, buffer.str());
+    result.stats.bytes_read = result.original_content.size();
+
+    // ─────────────────────────────────────────────────────────────────────────
+    // Write output
+    // ─────────────────────────────────────────────────────────────────────────
+    if (!dry_run && result.success && result.hasChanges()) {
+        StatTimer timer(result.stats.write_us);
+        SourceWriter writer(false);
+        if (writer.writeFile(file, result.modified_content)) {
+            result.stats.bytes_written = result.modified_content.size();
+        }
+    }
+
+    result.stats.peak_rss_bytes = peakRssBytes();
+    return result;
+}
+
+ExpansionResult AutosTool::expandFileStreaming(
+    const std::filesystem::path& file,
+    bool dry_run) {
+
+    ExpansionResult result;
+    result.original_view = MappedFile::open(file);
+    if (!result.original_view) {
+        diagnostics_.addError("Failed to open file: " + file.string());
+        result.success = false;
+        return result;
+    }
+
+    std::string_view content = result.original_view->view();
+    result.stats.bytes_read = content.size();
+    analyzeContent(file, content, {}, result);
+
+    // Cancellation and failures leave the file untouched
+    ExpansionResult::StreamedChanges changes;
+    if (result.success) {
+        changes.any = replacementsChangeContent(content, result.replacements);
+        changes.non_whitespace = changes.any &&
+            replacementsChangeContent(content, result.replacements, /*ignore_whitespace=*/true);
+    }
+    result.streamed = changes;
+
+    // ─────────────────────────────────────────────────────────────────────────
+    // Stream output: unchanged gaps from the mapping, new text in between
+    // ─────────────────────────────────────────────────────────────────────────
+    if (!dry_run && result.success && changes.any) {
+        StatTimer timer(result.stats.write_us);
+        SourceWriter writer(false);
+        if (writer.writeReplacements(file, content, result.replacements)) {
+            std::error_code ec;
+            auto size = std::filesystem::file_size(file, ec);
+            result.stats.bytes_written = ec ? 0 : static_cast<size_t>(size);
+        } else {
+            diagnostics_.addError("Failed to write file: " + file.string());
+            result.success = false;
+        }
+    }
+
+    result.stats.peak_rss_bytes = peakRssBytes();
+    return result;
+}
+
+ExpansionResult AutosTool::checkFile(const std::filesystem::path& file) {
+    ExpansionResult result;
+    result.original_view = MappedFile::open(file);
+    if (!result.original_view) {
+        diagnostics_.addError("Failed to open file: " + file.string());
+        result.success = false;
+        return result;
+    }
+
+    std::string_view content = result.original_view->view();
+    result.stats.bytes_read = content.size();
+    analyzeContent(file, content, {}, result, /*stop_at_first_change=*/true);
+
+    // Only the verdict is needed: stop at the first replacement that differs
+    ExpansionResult::StreamedChanges changes;
+    if (result.success) {
+        changes.non_whitespace =
+            replacementsChangeContent(content, result.replacements, /*ignore_whitespace=*/true);
+        changes.any = changes.non_whitespace;
+    }
+    result.streamed = changes;
+
+    result.stats.peak_rss_bytes = peakRssBytes();
+    return result;
+}
+
+ExpansionResult AutosTool::expandContent(
+    const std::filesystem::path& file,
+    std::string content,
+    ModuleFilter filter) {
+
+    ExpansionResult result;
+    result.original_content = std::move(content);
+
+    analyzeContent(file, result.original_content, std::move(filter), result);
+
+    // Cancellation leaves the content untouched; completed modules' replacements
+    // are still in result.replacements
+    if (result.cancelled) {
+        result.modified_content = result.original_content;
+        return result;
+    }
+    if (!result.success) {
+        return result;
+    }
+
+    // ─────────────────────────────────────────────────────────────────────────
+    // Apply replacements to original source
+    // ─────────────────────────────────────────────────────────────────────────
+    {
+        StatTimer timer(result.stats.write_us);
+        if (result.replacements.empty()) {
+            result.modified_content = result.original_content;
+        } else {
+            SourceWriter writer(false);
+            result.modified_content = writer.applyReplacements(result.original_content,
+                                                               result.replacements);
+        }
+    }
+
+    result.stats.peak_rss_bytes = peakRssBytes();
+    return result;
+}
+
+void AutosTool::analyzeContent(
+    const std::filesystem::path& file,
+    std::string_view content,
+    ModuleFilter filter,
+    ExpansionResult& result,
+    bool stop_at_first_change) {
 
     if (!compilation_) {
         diagnostics_.addError("No compilation available - call loadWithArgs first");
         result.success = false;
-        return result;
+        return;
     }
 
+    auto cancel = [&result]() {
+        result.cancelled = true;
+        result.success = false;
+    };
+
     // ─────────────────────────────────────────────────────────────────────────
     // Parse AUTO templates from comments
     // ─────────────────────────────────────────────────────────────────────────
+    std::string file_str = file.string();
+    if (!reportProgress(ExpansionPhase::Parse, file_str)) {
+        cancel();
+        return;
+    }
+
     AutoParser parser(&diagnostics_);
-    parser.parseText(result.original_content, file.string());
+    {
+        TimeTraceScope trace("Parse templates", file_str);
+        StatTimer timer(result.stats.parse_us);
+        parser.parseText(content, file_str);
+    }
 
     // ─────────────────────────────────────────────────────────────────────────
     // Get configuration
@@ -142,11 +336,16 @@ ExpansionResult AutosTool::expandFile(
     // ─────────────────────────────────────────────────────────────────────────
     // Parse source to AST (read-only, for analysis)
     // ─────────────────────────────────────────────────────────────────────────
-    auto tree = slang::syntax::SyntaxTree::fromText(result.original_content);
+    std::shared_ptr<slang::syntax::SyntaxTree> tree;
+    {
+        TimeTraceScope trace("Parse syntax tree", file_str);
+        StatTimer timer(result.stats.parse_us);
+        tree = slang::syntax::SyntaxTree::fromText(content);
+    }
     if (!tree) {
         diagnostics_.addError("Failed to parse file as SystemVerilog");
         result.success = false;
-        return result;
+        return;
     }
 
     // ─────────────────────────────────────────────────────────────────────────
@@ -177,24 +376,64 @@ ExpansionResult AutosTool::expandFile(
     }
     opts.net_type = inline_config.net_type.value_or(options_.net_type);
     opts.diagnostics = &diagnostics_;
+    opts.progress = progress_;
+    opts.port_cache = &port_cache_;
+    opts.jobs = options_.module_jobs;
+    opts.module_filter = std::move(filter);
+    opts.stop_at_first_change = stop_at_first_change;
+
+    // ─────────────────────────────────────────────────────────────────────────
+    // Elaborate up front so the cost is attributed to its own phase rather
+    // than to whichever module first looks up submodule ports
+    // ─────────────────────────────────────────────────────────────────────────
+    if (!reportProgress(ExpansionPhase::Elaborate, file_str)) {
+        cancel();
+        return;
+    }
+    {
+        TimeTraceScope trace("Elaborate", file_str);
+        StatTimer timer(result.stats.elaborate_us);
+        compilation_->getRoot();
+    }
 
     // ─────────────────────────────────────────────────────────────────────────
     // Analyze and collect replacements
     // ─────────────────────────────────────────────────────────────────────────
+    size_t cache_hits = port_cache_.hits();
+    size_t cache_misses = port_cache_.misses();
+
     AutosAnalyzer analyzer(*compilation_, parser.templates(), opts);
-    analyzer.analyze(tree, result.original_content);
+    {
+        TimeTraceScope trace("Analyze", file_str);
+        StatTimer timer(result.stats.analyze_us);
+        analyzer.analyze(tree, content);
+    }
+
+    result.stats.port_cache_hits = port_cache_.hits() - cache_hits;
+    result.stats.port_cache_misses = port_cache_.misses() - cache_misses;
+    result.stats.rule_evaluations = analyzer.matcherStats().rule_evaluations;
+    result.stats.regex_compilations = analyzer.matcherStats().regex_compilations;
+    if (analyzer.cancelled()) {
+        // Modules admitted before the cancel ran to completion; keep their
+        // replacements so callers can offer them
+        result.replacements = std::move(analyzer.getReplacements());
+        result.stats.replacements = result.replacements.size();
+        result.autoinst_count = analyzer.autoinstCount();
+        result.autologic_count = analyzer.autologicCount();
+        result.autoports_count = analyzer.autoportsCount();
+        cancel();
+        return;
+    }
 
     // ─────────────────────────────────────────────────────────────────────────
-    // Apply replacements to original source
+    // Hand over replacements; the caller applies or streams them
     // ─────────────────────────────────────────────────────────────────────────
-    auto& replacements = analyzer.getReplacements();
-
-    if (replacements.empty()) {
-        result.modified_content = result.original_content;
-    } else {
-        SourceWriter writer(false);
-        result.modified_content = writer.applyReplacements(result.original_content, replacements);
+    if (!reportProgress(ExpansionPhase::Generate, file_str)) {
+        cancel();
+        return;
     }
+    result.replacements = std::move(analyzer.getReplacements());
+    result.stats.replacements = result.replacements.size();
 
     // ─────────────────────────────────────────────────────────────────────────
     // Update statistics
@@ -202,36 +441,31 @@ ExpansionResult AutosTool::expandFile(
     result.autoinst_count = analyzer.autoinstCount();
     result.autologic_count = analyzer.autologicCount();
     result.autoports_count = analyzer.autoportsCount();
-
-    // ─────────────────────────────────────────────────────────────────────────
-    // Write output
-    // ─────────────────────────────────────────────────────────────────────────
-    if (!dry_run && result.hasChanges()) {
-        SourceWriter writer(false);
-        writer.writeFile(file, result.modified_content);
+    result.arena_stats = analyzer.arenaStats();
+    result.submodules = analyzer.submoduleTypes();
+    for (const auto& module : result.submodules) {
+        if (auto* entry = port_cache_.find(module); entry && !entry->source_file.empty()) {
+            result.port_sources.push_back(entry->source_file);
+        }
     }
-
-    return result;
+    std::sort(result.port_sources.begin(), result.port_sources.end());
+    result.port_sources.erase(std::unique(result.port_sources.begin(), result.port_sources.end()),
+                              result.port_sources.end());
 }
 
 std::vector<PortInfo> AutosTool::getModulePorts(const std::string& module_name) {
-    // Check cache first
-    auto cache_it = port_cache_.find(module_name);
-    if (cache_it != port_cache_.end()) {
-        return cache_it->second;
-    }
-
     if (!compilation_) {
         return {};
     }
+    return port_cache_.get(*compilation_, module_name, &diagnostics_, options_.strictness,
+                           options_.resolved_ranges);
+}
 
-    // Use shared implementation
-    auto ports = getModulePortsFromCompilation(
-        *compilation_, module_name, &diagnostics_, options_.strictness);
-
-    // Cache result (including empty results to avoid repeated failed lookups)
-    port_cache_[module_name] = ports;
-    return ports;
+bool AutosTool::reportProgress(ExpansionPhase phase, std::string_view detail) {
+    if (!progress_) {
+        return true;
+    }
+    return progress_(ProgressEvent{phase, detail});
 }
 
 void AutosTool::setInlineConfig(const std::filesystem::path& file, const InlineConfig& config) {
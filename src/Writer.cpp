@@ -1,4 +1,5 @@
 #include "slang-autos/Writer.h"
+#include "slang-autos/TimeTrace.h"
 
 #include <algorithm>
 #include <fstream>
@@ -6,6 +7,53 @@
 
 namespace slang_autos {
 
+// ============================================================================
+// Replacement comparison
+// ============================================================================
+
+bool differsIgnoringWhitespace(std::string_view a, std::string_view b) {
+    auto skipWs = [](std::string_view s, size_t pos) {
+        while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\t'))
+            ++pos;
+        return pos;
+    };
+
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        // At start of line or after newline, skip whitespace in both
+        if (a[i] == ' ' || a[i] == '\t' || b[j] == ' ' || b[j] == '\t') {
+            i = skipWs(a, i);
+            j = skipWs(b, j);
+            continue;
+        }
+        if (a[i] != b[j])
+            return true;
+        ++i;
+        ++j;
+    }
+    // Skip any trailing whitespace
+    i = skipWs(a, i);
+    j = skipWs(b, j);
+    return i != a.size() || j != b.size();
+}
+
+bool replacementsChangeContent(std::string_view content,
+                               const std::vector<Replacement>& replacements,
+                               bool ignore_whitespace) {
+    for (const auto& repl : replacements) {
+        if (repl.start > repl.end || repl.end > content.size()) {
+            continue;  // Skipped by the writer as well
+        }
+        auto old_text = content.substr(repl.start, repl.end - repl.start);
+        bool differs = ignore_whitespace ? differsIgnoringWhitespace(old_text, repl.new_text)
+                                         : old_text != repl.new_text;
+        if (differs) {
+            return true;
+        }
+    }
+    return false;
+}
+
 // ============================================================================
 // SourceWriter Implementation
 // ============================================================================
@@ -18,6 +66,8 @@ std::string SourceWriter::applyReplacements(
     const std::string& content,
     std::vector<Replacement>& replacements) {
 
+    TimeTraceScope trace("Apply replacements");
+
     // Sort by start offset, descending (apply from bottom up)
     std::sort(replacements.begin(), replacements.end(),
         [](const Replacement& a, const Replacement& b) {
@@ -38,11 +88,77 @@ std::string SourceWriter::applyReplacements(
     return result;
 }
 
+bool SourceWriter::writeReplacements(
+    const std::filesystem::path& file,
+    std::string_view content,
+    std::vector<Replacement>& replacements) {
+
+    if (dry_run_) {
+        return false;
+    }
+
+    TimeTraceScope trace("Write output", file.string());
+
+    // Sort by start offset, ascending (stream front to back)
+    std::sort(replacements.begin(), replacements.end(),
+        [](const Replacement& a, const Replacement& b) {
+            return a.start < b.start;
+        });
+
+    // Replace the file a symlink points at, not the link itself, so linked
+    // sources stay linked and the edit lands where the link resolves
+    std::error_code ec;
+    auto target = std::filesystem::canonical(file, ec);
+    if (ec) {
+        target = file;
+    }
+
+    auto tmp = target;
+    tmp += ".slang-autos.tmp";
+    {
+        std::ofstream ofs(tmp, std::ios::binary);
+        if (!ofs) {
+            return false;
+        }
+
+        size_t pos = 0;
+        for (const auto& repl : replacements) {
+            if (repl.start > repl.end || repl.end > content.size() || repl.start < pos) {
+                continue;  // Skip invalid or overlapping ranges to prevent corruption
+            }
+            ofs.write(content.data() + pos, static_cast<std::streamsize>(repl.start - pos));
+            ofs.write(repl.new_text.data(), static_cast<std::streamsize>(repl.new_text.size()));
+            pos = repl.end;
+        }
+        ofs.write(content.data() + pos, static_cast<std::streamsize>(content.size() - pos));
+
+        ofs.close();
+        if (!ofs) {
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+    }
+
+    // Keep the original file's mode
+    auto status = std::filesystem::status(target, ec);
+    if (!ec) {
+        std::filesystem::permissions(tmp, status.permissions(), ec);
+    }
+    std::filesystem::rename(tmp, target, ec);
+    if (ec) {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
 bool SourceWriter::writeFile(const std::filesystem::path& file, const std::string& content) {
     if (dry_run_) {
         return false;
     }
 
+    TimeTraceScope trace("Write output", file.string());
+
     std::ofstream ofs(file);
     if (!ofs) {
         return false;
@@ -166,4 +282,36 @@ std::string SourceWriter::generateDiff(
     return diff.str();
 }
 
+// ============================================================================
+// Depfile output
+// ============================================================================
+
+namespace {
+
+std::string escapeDepfilePath(std::string_view path) {
+    std::string out;
+    out.reserve(path.size());
+    for (char c : path) {
+        if (c == ' ' || c == '#') {
+            out += '\\';
+        } else if (c == '$') {
+            out += '$';
+        }
+        out += c;
+    }
+    return out;
+}
+
+} // anonymous namespace
+
+std::string formatDepfileRule(const std::string& target, const std::vector<std::string>& deps) {
+    std::string rule = escapeDepfilePath(target) + ":";
+    for (const auto& dep : deps) {
+        rule += " \\\n  ";
+        rule += escapeDepfilePath(dep);
+    }
+    rule += "\n";
+    return rule;
+}
+
 } // namespace slang_autos
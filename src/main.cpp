@@ -1,7 +1,15 @@
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <filesystem>
 #include <fstream>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <set>
 #include <sstream>
+#include <thread>
+#include <unordered_set>
 
 #include "slang/driver/Driver.h"
 #include "slang/ast/Compilation.h"
@@ -10,11 +18,19 @@
 #include "slang/diagnostics/DiagnosticEngine.h"
 #include "slang/util/VersionInfo.h"
 
+#include "slang-autos/AutoStripper.h"
+#include "slang-autos/CompilationUtils.h"
+#include "slang-autos/Daemon.h"
+#include "slang-autos/DependencyIndex.h"
+#include "slang-autos/FileWatcher.h"
+#include "slang-autos/PortSnapshot.h"
 #include "slang-autos/Tool.h"
 #include "slang-autos/Writer.h"
 #include "slang-autos/Config.h"
 #include "slang-autos/Parser.h"
 #include "slang-autos/Diagnostics.h"
+#include "slang-autos/Shard.h"
+#include "slang-autos/TimeTrace.h"
 
 using namespace slang;
 using namespace slang::driver;
@@ -28,163 +44,196 @@ static bool isValidExtension(const fs::path& path) {
     return ext == ".v" || ext == ".sv" || ext == ".vh" || ext == ".svh";
 }
 
-/// Strip all AUTO expansion blocks from source text, leaving only markers.
-/// This is used by --clean mode to remove stale expansions before re-running.
-///
-/// Handles:
-/// - AUTOLOGIC: removes from "// Beginning of automatic logic" to "// End of automatics"
-/// - AUTOPORTS: removes everything between /*AUTOPORTS*/ and the closing )
-/// - AUTOINST: removes everything between /*AUTOINST*/ and the closing )
-///
-/// Returns the cleaned source text.
-static std::string stripAutoExpansions(const std::string& source) {
-    std::string result;
-    result.reserve(source.size());
-
-    size_t pos = 0;
-    while (pos < source.size()) {
-        // Look for markers
-        size_t autoinst_pos = source.find("/*AUTOINST*/", pos);
-        size_t autoports_pos = source.find("/*AUTOPORTS*/", pos);
-        size_t begin_auto_pos = source.find("// Beginning of automatic", pos);
-
-        // Find the nearest marker
-        size_t next_marker = std::min({autoinst_pos, autoports_pos, begin_auto_pos});
-
-        if (next_marker == std::string::npos) {
-            // No more markers, copy rest of file
-            result.append(source, pos, source.size() - pos);
-            break;
-        }
-
-        // Copy everything up to the marker
-        result.append(source, pos, next_marker - pos);
-
-        if (next_marker == autoinst_pos) {
-            // Handle AUTOINST: keep the marker, remove content until )
-            result.append("/*AUTOINST*/");
-            pos = autoinst_pos + 12;  // strlen("/*AUTOINST*/")
-
-            // Find the closing ) - need to handle nested parens
-            int paren_depth = 0;
-            bool in_string = false;
-            bool in_line_comment = false;
-            bool in_block_comment = false;
-            size_t close_pos = pos;
-
-            while (close_pos < source.size()) {
-                char c = source[close_pos];
-                char next = (close_pos + 1 < source.size()) ? source[close_pos + 1] : '\0';
-
-                if (in_line_comment) {
-                    if (c == '\n') in_line_comment = false;
-                } else if (in_block_comment) {
-                    if (c == '*' && next == '/') {
-                        in_block_comment = false;
-                        close_pos++;
-                    }
-                } else if (in_string) {
-                    if (c == '"' && (close_pos == 0 || source[close_pos-1] != '\\')) {
-                        in_string = false;
-                    }
-                } else {
-                    if (c == '/' && next == '/') {
-                        in_line_comment = true;
-                        close_pos++;
-                    } else if (c == '/' && next == '*') {
-                        in_block_comment = true;
-                        close_pos++;
-                    } else if (c == '"') {
-                        in_string = true;
-                    } else if (c == '(') {
-                        paren_depth++;
-                    } else if (c == ')') {
-                        if (paren_depth == 0) {
-                            // Found the closing paren
-                            break;
-                        }
-                        paren_depth--;
-                    }
-                }
-                close_pos++;
-            }
+// Absolute, normalized form of a path, used to key per-file state
+static std::string pathKey(const fs::path& path) {
+    std::error_code ec;
+    return fs::absolute(path, ec).lexically_normal().string();
+}
 
-            // Skip to the closing paren (but don't include it - it's part of the instance)
-            pos = close_pos;
-
-        } else if (next_marker == autoports_pos) {
-            // Handle AUTOPORTS: keep the marker, remove content until )
-            // AUTOPORTS is in module header: module foo ( ... /*AUTOPORTS*/ ... );
-            result.append("/*AUTOPORTS*/");
-            pos = autoports_pos + 13;  // strlen("/*AUTOPORTS*/")
-
-            // Find the closing ) of the port list
-            int paren_depth = 0;
-            bool in_string = false;
-            bool in_line_comment = false;
-            bool in_block_comment = false;
-            size_t close_pos = pos;
-
-            while (close_pos < source.size()) {
-                char c = source[close_pos];
-                char next = (close_pos + 1 < source.size()) ? source[close_pos + 1] : '\0';
-
-                if (in_line_comment) {
-                    if (c == '\n') in_line_comment = false;
-                } else if (in_block_comment) {
-                    if (c == '*' && next == '/') {
-                        in_block_comment = false;
-                        close_pos++;
-                    }
-                } else if (in_string) {
-                    if (c == '"' && (close_pos == 0 || source[close_pos-1] != '\\')) {
-                        in_string = false;
-                    }
-                } else {
-                    if (c == '/' && next == '/') {
-                        in_line_comment = true;
-                        close_pos++;
-                    } else if (c == '/' && next == '*') {
-                        in_block_comment = true;
-                        close_pos++;
-                    } else if (c == '"') {
-                        in_string = true;
-                    } else if (c == '(') {
-                        paren_depth++;
-                    } else if (c == ')') {
-                        if (paren_depth == 0) {
-                            // Found the closing paren of the port list
-                            break;
-                        }
-                        paren_depth--;
-                    }
-                }
-                close_pos++;
-            }
+namespace {
 
-            // Skip to the closing paren (but don't include it)
-            pos = close_pos;
+/// One slang-autos command line: the slang driver with its bound options and
+/// parsed sources, plus per-file elaboration state.
+///
+/// A plain CLI invocation runs a session once. The daemon (--daemon) keeps
+/// loaded sessions and runs them again for identical command lines, so the
+/// sources are parsed once and each file's compilation and port cache stay
+/// warm until one of the session's inputs changes on disk.
+class CliSession {
+public:
+    /// @param keep_warm Keep per-file compilations between runs and record
+    ///                  input stamps (daemon); otherwise each file's state is
+    ///                  dropped as soon as it has been expanded
+    explicit CliSession(bool keep_warm = false) : keep_warm_(keep_warm) {}
+
+    CliSession(const CliSession&) = delete;
+    CliSession& operator=(const CliSession&) = delete;
+
+    /// Run the command line and return the process exit code. `args` is only
+    /// read by the first run; later runs reuse the parsed state.
+    int run(const std::vector<std::string>& args);
+
+    /// Sources are parsed and the session can run again
+    [[nodiscard]] bool loaded() const { return loaded_; }
+
+    /// Check whether a source, include or config file changed since loading
+    [[nodiscard]] bool stale() { return inputs_.changed(); }
+
+    /// --watch was given (main() runs the watch loop after the first run)
+    [[nodiscard]] bool watchMode() const { return flags_.watch.value_or(false); }
+
+    /// Only expand those files to expand whose pathKey() is in `files`.
+    /// Must be called before the first run.
+    void restrictTo(std::unordered_set<std::string> files) { restrict_to_ = std::move(files); }
+
+    [[nodiscard]] const std::vector<fs::path>& filesToExpand() const { return filesToExpand_; }
+
+    /// Module types each successfully expanded file depends on, by pathKey()
+    [[nodiscard]] const std::unordered_map<std::string, std::vector<std::string>>& submodules() const {
+        return submodules_;
+    }
 
+    /// Every file slang loaded: sources, library files and includes
+    [[nodiscard]] std::vector<fs::path> sourceFiles() const;
+
+    /// Directories whose contents can change an expansion: those of the files
+    /// to expand and of every loaded file, library directories (-y, config
+    /// and inline libdirs) and the config file's directory
+    [[nodiscard]] std::vector<fs::path> watchDirectories() const;
+
+    /// The .slang-autos.toml in effect, if any (absolute)
+    [[nodiscard]] const std::optional<fs::path>& configPath() const { return config_path_; }
+
+private:
+    /// Elaboration outcome for one file to expand
+    struct FileState {
+        bool elaborated = false;
+        uint64_t elaborate_us = 0;        ///< Compilation and elaboration time (--stats)
+        std::unique_ptr<AutosTool> tool;  ///< Owns the compilation and port cache
+        std::string slang_report;         ///< slang diagnostics printed on every run
+        std::string blocked_message;      ///< Why the file cannot be expanded (if it can't)
+    };
+
+    /// Register options and parse argv. Returns an exit code if the run ends here.
+    std::optional<int> configure(const std::vector<std::string>& args);
+
+    /// Apply options and config files and parse all sources. Returns an exit
+    /// code if the run ends here (errors, --clean).
+    std::optional<int> load();
+
+    /// Expand every file and print the results
+    int expand();
+
+    /// One file's expansion, ready to be reported
+    struct FileOutcome {
+        bool ran = false;             ///< false if --fail-fast ended the run first
+        std::string slang_report;     ///< As FileState
+        std::string blocked_message;  ///< As FileState; nothing was expanded if set
+        ExpansionResult result;
+        DiagnosticCollector diagnostics;  ///< The tool's diagnostics for this file
+    };
+
+    /// Elaborate `path` if needed, then expand it (or, with `check`, only
+    /// decide whether it needs changes). Safe to call from several threads
+    /// for different files.
+    FileOutcome expandOne(const fs::path& path, FileState& state, bool no_write,
+                          bool streaming, bool check = false);
+
+    /// --check: check every file to expand on up to --check-jobs threads.
+    /// With --fail-fast, files not yet started when one needs changes (or
+    /// fails) are left with `ran` unset.
+    std::vector<FileOutcome> checkAll();
+
+    /// Create the compilation for `path` and check its slang diagnostics
+    void elaborate(const fs::path& path, FileState& state);
+
+    /// Run --clean over the files to expand
+    int clean();
+
+    /// Print the files to expand made stale by the --affected-by files
+    int affected();
+
+    /// Keep only this shard's files to expand (--shard)
+    std::optional<int> selectShardFiles();
+
+    /// Write --shard-result, if requested
+    void writeShardResult(const ShardResult& result);
+
+    /// Combine --merge-shards results into one summary and exit code
+    int mergeShards();
+
+    /// Files included (directly or not) by any of `files` (pathKey() form)
+    [[nodiscard]] std::vector<std::string> includedBy(const std::unordered_set<std::string>& files) const;
+
+    /// Print progress and summary text for people. It goes to stderr when
+    /// --stats=json is requested, so that stdout holds only the JSON.
+    void report(const std::string& text) const {
+        if (flags_.statsFormat) {
+            OS::printE(text);
         } else {
-            // Handle AUTOLOGIC block: remove from "// Beginning" to "// End of automatics"
-            size_t end_pos = source.find("// End of automatics", next_marker);
-            if (end_pos != std::string::npos) {
-                // Skip past the end marker
-                pos = end_pos + 20;  // strlen("// End of automatics")
-            } else {
-                // No end marker found - just copy the beginning marker and continue
-                result.append(source, next_marker, 25);  // "// Beginning of automatic"
-                pos = next_marker + 25;
-            }
+            OS::print(text);
         }
     }
 
-    return result;
-}
-
-int main(int argc, char* argv[]) {
-    Driver driver;
-    driver.addStandardArgs();
+    Driver driver_;
+    std::mutex driver_mutex_;  ///< Guards the driver's options while compilations are created
+    uint64_t parse_sources_us_ = 0;  ///< Shared source parsing in load() (--stats run total)
+    bool keep_warm_ = false;
+    bool configured_ = false;
+    bool loaded_ = false;
+
+    /// Values bound to the command line options
+    struct Flags {
+        std::optional<bool> showHelp;
+        std::optional<bool> showVersion;
+        std::optional<bool> dryRun;
+        std::optional<bool> diffMode;
+        std::optional<bool> checkMode;
+        std::optional<bool> cleanMode;
+        std::optional<bool> strictMode;
+        std::optional<bool> noAlignment;
+        std::optional<bool> verbose;
+        std::optional<bool> quiet;
+        std::optional<bool> noSingleUnit;
+        std::optional<bool> resolvedRanges;
+        std::optional<bool> lowMemory;
+        std::optional<std::string> statsFormat;
+        std::optional<std::string> timeTracePath;
+        std::optional<std::string> depfilePath;
+        std::vector<std::string> affectedBy;
+        std::optional<std::string> portSignaturesPath;
+        std::vector<std::string> portSnapshots;
+        std::optional<std::string> shard;
+        std::optional<std::string> shardWeightsPath;
+        std::optional<std::string> shardResultPath;
+        std::vector<std::string> mergeShards;
+        std::optional<uint32_t> moduleJobs;
+        std::optional<uint32_t> checkJobs;
+        std::optional<bool> failFast;
+        std::optional<bool> watch;
+        std::optional<bool> daemon;
+        std::optional<bool> client;
+        std::optional<bool> daemonStop;
+        std::optional<std::string> daemonSocket;
+    } flags_;
+
+    std::vector<fs::path> filesToExpand_;
+    std::unordered_map<std::string, InlineConfig> inline_configs_;
+    AutosTool::Options options_;
+    int verbosity_ = 1;
+
+    std::optional<std::unordered_set<std::string>> restrict_to_;
+    std::unordered_map<std::string, std::vector<std::string>> submodules_;
+    std::vector<fs::path> library_dirs_;  ///< Absolute -y, config and inline libdirs
+    std::optional<fs::path> config_path_;
+    std::vector<std::shared_ptr<const PortSnapshot>> port_snapshots_;  ///< --port-snapshot
+
+    FileStamps inputs_;                                 ///< What the parsed state was built from
+    std::unordered_map<std::string, FileState> files_;  ///< Warm per-file state (keep_warm_ only)
+};
+
+std::optional<int> CliSession::configure(const std::vector<std::string>& args) {
+    driver_.addStandardArgs();
 
     // ========================================================================
     // Identify positional files for expansion (before slang parses argv)
@@ -199,10 +248,15 @@ int main(int argc, char* argv[]) {
     // of the positional arguments are files we should expand.
     // ========================================================================
 
-    std::vector<fs::path> filesToExpand;
+    for (size_t i = 1; i < args.size(); ++i) {
+        std::string_view arg(args[i]);
 
-    for (int i = 1; i < argc; ++i) {
-        std::string_view arg(argv[i]);
+        // --affected-by takes exactly one value (repeat it or comma-separate);
+        // that value is not a file to expand, but later positionals are
+        if (arg == "--affected-by") {
+            ++i;
+            continue;
+        }
 
         // Skip options (start with '-' or '+')
         if (arg.starts_with('-') || arg.starts_with('+')) {
@@ -215,85 +269,309 @@ int main(int argc, char* argv[]) {
         // Must exist and have valid extension to be expanded
         // (other positional args like module names for --top are left for slang)
         if (fs::exists(path) && isValidExtension(path)) {
-            filesToExpand.push_back(path);
+            filesToExpand_.push_back(path);
         }
     }
 
+    // --watch re-runs only the files affected by a change
+    if (restrict_to_) {
+        std::erase_if(filesToExpand_, [&](const fs::path& path) {
+            return !restrict_to_->contains(pathKey(path));
+        });
+    }
+
     // ========================================================================
     // slang-autos specific options (added to slang's command line parser)
     // ========================================================================
 
-    std::optional<bool> showHelp;
-    std::optional<bool> showVersion;
-    driver.cmdLine.add("-h,--help", showHelp, "Display available options");
-    driver.cmdLine.add("--version", showVersion, "Display version information and exit");
+    auto& cmdLine = driver_.cmdLine;
+    cmdLine.add("-h,--help", flags_.showHelp, "Display available options");
+    cmdLine.add("--version", flags_.showVersion, "Display version information and exit");
 
     // Output modes
-    std::optional<bool> dryRun;
-    std::optional<bool> diffMode;
-    std::optional<bool> checkMode;
-    std::optional<bool> cleanMode;
-    driver.cmdLine.add("--dry-run", dryRun, "Show changes without modifying files");
-    driver.cmdLine.add("--diff", diffMode, "Output unified diff instead of modifying");
-    driver.cmdLine.add("--check", checkMode, "Check if files need changes (exit 1 if changes needed, for CI)");
-    driver.cmdLine.add("--clean", cleanMode, "Remove all AUTO expansion blocks, leaving only markers");
+    cmdLine.add("--dry-run", flags_.dryRun, "Show changes without modifying files");
+    cmdLine.add("--diff", flags_.diffMode, "Output unified diff instead of modifying");
+    cmdLine.add("--check", flags_.checkMode, "Check if files need changes (exit 1 if changes needed, for CI)");
+    cmdLine.add("--fail-fast", flags_.failFast,
+                "With --check, stop at the first file that needs changes or fails");
+    cmdLine.add("--clean", flags_.cleanMode, "Remove all AUTO expansion blocks, leaving only markers");
 
     // Strictness
-    std::optional<bool> strictMode;
-    driver.cmdLine.add("--strict", strictMode,
-                       "Error on missing modules (default: warn and continue)");
+    cmdLine.add("--strict", flags_.strictMode,
+                "Error on missing modules (default: warn and continue)");
 
     // Formatting options
-    std::optional<bool> noAlignment;
-    driver.cmdLine.add("--no-alignment", noAlignment, "Don't align port names");
+    cmdLine.add("--no-alignment", flags_.noAlignment, "Don't align port names");
 
     // Verbosity (note: -v is used by slang for library files, so we only use long form)
-    std::optional<bool> verbose;
-    std::optional<bool> quiet;
-    driver.cmdLine.add("--verbose", verbose, "Increase verbosity");
-    driver.cmdLine.add("-q,--quiet", quiet, "Suppress non-error output");
+    cmdLine.add("--verbose", flags_.verbose, "Increase verbosity");
+    cmdLine.add("-q,--quiet", flags_.quiet, "Suppress non-error output");
 
     // Compilation unit mode (default: single unit for better macro handling)
-    std::optional<bool> noSingleUnit;
-    driver.cmdLine.add("--no-single-unit", noSingleUnit,
-                       "Treat files as separate compilation units (disables default --single-unit)");
+    cmdLine.add("--no-single-unit", flags_.noSingleUnit,
+                "Treat files as separate compilation units (disables default --single-unit)");
 
     // Output format options
-    std::optional<bool> resolvedRanges;
-    driver.cmdLine.add("--resolved-ranges", resolvedRanges,
-                       "Use resolved integer widths instead of original parameter/expression syntax");
+    cmdLine.add("--resolved-ranges", flags_.resolvedRanges,
+                "Use resolved integer widths instead of original parameter/expression syntax");
+
+    // Memory
+    cmdLine.add("--low-memory", flags_.lowMemory,
+                "Map input files and stream output instead of holding whole files in memory "
+                "(for very large files; ignored with --diff)");
+
+    // Profiling
+    cmdLine.add("--stats", flags_.statsFormat,
+                "Print per-file and total run statistics (timings, cache and template "
+                "counters, bytes, peak RSS) in the given format: json. Stdout then holds "
+                "only the statistics; the summary goes to stderr",
+                "<format>");
+    cmdLine.add("--time-trace", flags_.timeTracePath,
+                "Write per-phase, per-file and per-module timings as Chrome trace JSON",
+                "<file>");
+
+    // Build system integration
+    cmdLine.add("--depfile", flags_.depfilePath,
+                "Write a Make/Ninja depfile listing, per expanded file, the files its "
+                "submodule ports, includes and config came from",
+                "<file>");
+
+    cmdLine.add("--affected-by", flags_.affectedBy,
+                "Instead of expanding, print the files to expand that changes to this "
+                "file make stale (one file per flag; repeat or comma-separate for more)",
+                "<file>");
+    cmdLine.add("--port-signatures", flags_.portSignaturesPath,
+                "Port signature store for --affected-by: modules whose stored signature "
+                "matches are unchanged; updated with the current signatures",
+                "<file>");
+
+    cmdLine.add("--port-snapshot", flags_.portSnapshots,
+                "Precompiled library port signatures (from slang-port-snapshot) used "
+                "instead of elaborating those submodules (repeatable)",
+                "<file>");
+
+    // Distributed CI
+    cmdLine.add("--shard", flags_.shard,
+                "Expand only shard K of N (1-based), partitioning the files by estimated cost",
+                "<K/N>");
+    cmdLine.add("--shard-weights", flags_.shardWeightsPath,
+                "Previous --stats=json output to weight --shard partitioning by measured time",
+                "<file>");
+    cmdLine.add("--shard-result", flags_.shardResultPath,
+                "Write this run's exit code and summary as JSON for --merge-shards", "<file>");
+    cmdLine.add("--merge-shards", flags_.mergeShards,
+                "Combine the --shard-result files of all shards into one summary and exit "
+                "code (repeat or comma-separate)",
+                "<file>");
+
+    // Parallelism
+    cmdLine.add("--module-jobs", flags_.moduleJobs,
+                "Analyze up to N modules of a file concurrently (0 = one per CPU)", "<N>");
+    cmdLine.add("--check-jobs", flags_.checkJobs,
+                "With --check, check up to N files concurrently (0 = one per CPU, the default)",
+                "<N>");
+
+    // Watch
+    cmdLine.add("--watch", flags_.watch,
+                "Keep running and re-expand files when they or the modules they "
+                "instantiate change on disk");
+
+    // Daemon (handled in main() before argv reaches the driver; listed for --help)
+    cmdLine.add("--daemon", flags_.daemon,
+                "Run as a daemon serving --client requests, keeping parsed sources and "
+                "port caches warm between them");
+    cmdLine.add("--client", flags_.client,
+                "Forward this command line to a running daemon (runs locally if none)");
+    cmdLine.add("--daemon-stop", flags_.daemonStop, "Stop the running daemon");
+    cmdLine.add("--daemon-socket", flags_.daemonSocket,
+                "Daemon socket path (default: $XDG_RUNTIME_DIR/slang-autos.sock)", "<path>");
 
     // ========================================================================
     // Parse command line
     // ========================================================================
 
-    if (!driver.parseCommandLine(argc, argv))
+    std::vector<const char*> argv;
+    argv.reserve(args.size());
+    for (const auto& arg : args) {
+        argv.push_back(arg.c_str());
+    }
+    if (!driver_.parseCommandLine(static_cast<int>(argv.size()), argv.data()))
         return 1;
 
-    if (showHelp == true) {
-        OS::print(driver.cmdLine.getHelpText("slang-autos - SystemVerilog AUTO macro expander"));
+    if (flags_.showHelp == true) {
+        OS::print(cmdLine.getHelpText("slang-autos - SystemVerilog AUTO macro expander"));
         return 0;
     }
 
-    if (showVersion == true) {
+    if (flags_.statsFormat && *flags_.statsFormat != "json") {
+        OS::printE(fmt::format("error: unsupported --stats format '{}' (expected 'json')\n",
+                               *flags_.statsFormat));
+        return 1;
+    }
+    if (flags_.statsFormat && flags_.diffMode.value_or(false)) {
+        OS::printE("error: --stats and --diff both write to stdout; use them in separate runs\n");
+        return 1;
+    }
+
+    if (flags_.showVersion == true) {
         OS::print(fmt::format("slang-autos version 0.1.0 (slang {}.{}.{}+{})\n",
                               VersionInfo::getMajor(), VersionInfo::getMinor(),
                               VersionInfo::getPatch(), std::string(VersionInfo::getHash())));
         return 0;
     }
 
-    if (!driver.processOptions())
-        return 2;
+    if (flags_.shard) {
+        return selectShardFiles();
+    }
+
+    return std::nullopt;
+}
+
+std::optional<int> CliSession::selectShardFiles() {
+    auto spec = parseShardSpec(*flags_.shard);
+    if (!spec) {
+        OS::printE(fmt::format("error: invalid --shard '{}' (expected K/N with 1 <= K <= N)\n",
+                               *flags_.shard));
+        return 1;
+    }
+
+    std::optional<std::unordered_map<std::string, uint64_t>> measured;
+    if (flags_.shardWeightsPath) {
+        measured = loadStatsCosts(*flags_.shardWeightsPath);
+        if (!measured) {
+            OS::printE(fmt::format("error: cannot read --shard-weights '{}' (expected --stats=json output)\n",
+                                   *flags_.shardWeightsPath));
+            return 1;
+        }
+    }
+
+    // Measured times where known; files without one cost the mean measured
+    // time, or (with no measurements at all) are estimated from their text
+    uint64_t mean = 0;
+    if (measured && !measured->empty()) {
+        uint64_t total = 0;
+        for (const auto& [path, cost] : *measured) total += cost;
+        mean = total / measured->size();
+    }
+
+    std::vector<uint64_t> costs;
+    costs.reserve(filesToExpand_.size());
+    for (const auto& path : filesToExpand_) {
+        if (measured) {
+            auto it = measured->find(path.string());
+            costs.push_back(it != measured->end() ? it->second : mean);
+            continue;
+        }
+        std::ifstream ifs(path, std::ios::binary);
+        std::stringstream buffer;
+        buffer << ifs.rdbuf();
+        costs.push_back(estimateExpansionCost(buffer.str()));
+    }
+
+    std::vector<fs::path> selected;
+    for (size_t index : selectShard(costs, *spec)) {
+        selected.push_back(filesToExpand_[index]);
+    }
+    if (flags_.verbose.value_or(false)) {  // verbosity_ is not merged with the config yet
+        report(fmt::format("shard {}/{}: {} of {} file(s)\n", spec->index, spec->count,
+                           selected.size(), filesToExpand_.size()));
+    }
+    bool had_files = !filesToExpand_.empty();
+    filesToExpand_ = std::move(selected);
+
+    // More shards than files: an empty shard succeeds with nothing to do
+    if (filesToExpand_.empty() && had_files) {
+        writeShardResult(ShardResult{});
+        return 0;
+    }
+    return std::nullopt;
+}
+
+void CliSession::writeShardResult(const ShardResult& result) {
+    if (!flags_.shardResultPath) return;
+
+    ShardResult shard_result = result;
+    if (auto spec = flags_.shard ? parseShardSpec(*flags_.shard) : std::nullopt) {
+        shard_result.shard = spec->index;
+        shard_result.shards = spec->count;
+    }
+
+    std::ofstream ofs(*flags_.shardResultPath, std::ios::binary);
+    if (!(ofs << toJson(shard_result))) {
+        OS::printE(fmt::format("error: Failed to write shard result: {}\n", *flags_.shardResultPath));
+    }
+}
+
+int CliSession::mergeShards() {
+    std::vector<ShardResult> results;
+    DiagnosticCollector diagnostics;
+    for (const auto& path : flags_.mergeShards) {
+        std::ifstream ifs(path, std::ios::binary);
+        std::stringstream buffer;
+        buffer << ifs.rdbuf();
+        if (auto result = ifs ? parseShardResult(buffer.str()) : std::nullopt) {
+            results.push_back(std::move(*result));
+        } else {
+            diagnostics.addError("Cannot read shard result", path);
+        }
+    }
+
+    ShardResult merged = mergeShardResults(results, diagnostics);
+    if (diagnostics.hasErrors()) {
+        OS::printE(diagnostics.format());
+        merged.exit_code = std::max(merged.exit_code, 1);
+    }
+
+    bool quiet = flags_.quiet.value_or(false);
+    if (!quiet) {
+        for (const auto& path : merged.changed) {
+            OS::print(fmt::format("{}\n", path));
+        }
+        if (merged.partial) {
+            OS::print(fmt::format("\nSummary: {} shard(s), {} file(s), {} changed\n",
+                                  merged.shards, merged.files, merged.files_changed));
+        } else {
+            OS::print(fmt::format("\nSummary: {} shard(s), {} file(s), {} changed, {} AUTOINST, "
+                                  "{} AUTOLOGIC, {} AUTOPORTS\n",
+                                  merged.shards, merged.files, merged.files_changed,
+                                  merged.autoinst, merged.autologic, merged.autoports));
+        }
+    }
+    return merged.exit_code;
+}
+
+std::optional<int> CliSession::load() {
+    {
+        TimeTraceScope trace("Process options");
+        if (!driver_.processOptions())
+            return 2;
+    }
 
     // Always ignore unknown modules - we don't need leaf cells elaborated
-    driver.options.compilationFlags[ast::CompilationFlags::IgnoreUnknownModules] = true;
+    driver_.options.compilationFlags[ast::CompilationFlags::IgnoreUnknownModules] = true;
+
+    for (const auto& dir : driver_.options.libDirs) {
+        library_dirs_.push_back(pathKey(dir));
+    }
+
+    for (const auto& file : flags_.portSnapshots) {
+        DiagnosticCollector snapshot_diagnostics;
+        auto snapshot = PortSnapshot::open(file, &snapshot_diagnostics);
+        if (!snapshot) {
+            for (const auto& diag : snapshot_diagnostics.diagnostics()) {
+                OS::printE(fmt::format("error: {} [{}]\n", diag.message, diag.file_path));
+            }
+            return 1;
+        }
+        port_snapshots_.push_back(std::move(snapshot));
+    }
 
     // Suppress include file errors at the slang level.
     // We only care about include errors in the top module and direct children.
     // Grandchildren with missing includes should not block expansion.
     // We'll check for critical include errors per-file in the expansion loop.
-    driver.diagEngine.setSeverity(slang::diag::CouldNotOpenIncludeFile,
-                                  slang::DiagnosticSeverity::Warning);
+    driver_.diagEngine.setSeverity(slang::diag::CouldNotOpenIncludeFile,
+                                   slang::DiagnosticSeverity::Warning);
 
     // ========================================================================
     // Load configuration file (.slang-autos.toml)
@@ -304,6 +582,7 @@ int main(int argc, char* argv[]) {
     DiagnosticCollector config_diagnostics;
     if (auto config_path = ConfigLoader::findConfigFile()) {
         found_config_path = config_path;
+        config_path_ = pathKey(*config_path);
         file_config = ConfigLoader::loadFile(*config_path, &config_diagnostics);
 
         // Report config file diagnostics
@@ -321,40 +600,41 @@ int main(int argc, char* argv[]) {
 
     // Track which CLI options were explicitly specified
     CliFlags cli_flags;
-    cli_flags.has_strictness = strictMode.has_value();
-    cli_flags.has_alignment = noAlignment.has_value();
+    cli_flags.has_strictness = flags_.strictMode.has_value();
+    cli_flags.has_alignment = flags_.noAlignment.has_value();
     cli_flags.has_indent = false;  // No CLI --indent option anymore
-    cli_flags.has_verbosity = verbose.has_value() || quiet.has_value();
-    cli_flags.has_single_unit = noSingleUnit.has_value();
-    cli_flags.has_resolved_ranges = resolvedRanges.has_value();
+    cli_flags.has_verbosity = flags_.verbose.has_value() || flags_.quiet.has_value();
+    cli_flags.has_single_unit = flags_.noSingleUnit.has_value();
+    cli_flags.has_resolved_ranges = flags_.resolvedRanges.has_value();
 
     // Build CLI options (these are the "raw" CLI values)
     AutosTool::Options cli_options;
-    cli_options.strictness = strictMode.value_or(false) ? StrictnessMode::Strict
-                                                        : StrictnessMode::Lenient;
-    cli_options.alignment = !noAlignment.value_or(false);
+    cli_options.strictness = flags_.strictMode.value_or(false) ? StrictnessMode::Strict
+                                                               : StrictnessMode::Lenient;
+    cli_options.alignment = !flags_.noAlignment.value_or(false);
     cli_options.indent = "  ";  // Default 2 spaces (can be overridden by file config or inline)
-    cli_options.verbosity = quiet.value_or(false) ? 0 : (verbose.value_or(false) ? 2 : 1);
-    cli_options.single_unit = !noSingleUnit.value_or(false);
-    cli_options.resolved_ranges = resolvedRanges.value_or(false);
+    cli_options.verbosity = flags_.quiet.value_or(false) ? 0 : (flags_.verbose.value_or(false) ? 2 : 1);
+    cli_options.single_unit = !flags_.noSingleUnit.value_or(false);
+    cli_options.resolved_ranges = flags_.resolvedRanges.value_or(false);
 
     // Merge: CLI > config file > defaults
     // Note: Inline config is handled per-file in the expansion loop
     InlineConfig empty_inline;  // Will be merged per-file
     MergedConfig merged = ConfigLoader::merge(file_config, empty_inline, cli_options, cli_flags);
-    AutosTool::Options options = merged.toToolOptions();
-    int verbosity = options.verbosity;
+    options_ = merged.toToolOptions();
+    options_.module_jobs = flags_.moduleJobs.value_or(1);
+    verbosity_ = options_.verbosity;
 
     // Apply single_unit setting to slang driver (must be before parseAllSources)
     // This makes macros from includes visible across all files
-    driver.options.singleUnit = merged.single_unit;
+    driver_.options.singleUnit = merged.single_unit;
 
     // Verbose: report config file discovery
-    if (verbosity >= 2) {
+    if (verbosity_ >= 2) {
         if (found_config_path) {
-            OS::print(fmt::format("config: loaded {}\n", found_config_path->string()));
+            report(fmt::format("config: loaded {}\n", found_config_path->string()));
         } else {
-            OS::print("config: no config file found\n");
+            report("config: no config file found\n");
         }
     }
 
@@ -366,21 +646,22 @@ int main(int argc, char* argv[]) {
 
     for (const auto& dir : merged.libdirs) {
         fs::path resolved = (config_base_dir / dir).lexically_normal();
-        driver.sourceLoader.addSearchDirectories(resolved.string());
+        driver_.sourceLoader.addSearchDirectories(resolved.string());
+        library_dirs_.push_back(resolved);
     }
     for (const auto& ext : merged.libext) {
-        driver.sourceLoader.addSearchExtension(ext);
+        driver_.sourceLoader.addSearchExtension(ext);
     }
     for (const auto& dir : merged.incdirs) {
         fs::path resolved = (config_base_dir / dir).lexically_normal();
-        driver.sourceManager.addUserDirectories(resolved.string());
+        driver_.sourceManager.addUserDirectories(resolved.string());
     }
 
     // ========================================================================
     // Check for files to expand
     // ========================================================================
 
-    if (filesToExpand.empty()) {
+    if (filesToExpand_.empty()) {
         OS::printE("error: no input files specified\n");
         OS::printE("Run with --help for usage information\n");
         return 1;
@@ -394,10 +675,9 @@ int main(int argc, char* argv[]) {
     // We also store the full inline config per-file to avoid re-parsing later.
 
     DiagnosticCollector prescan_diagnostics;
-    std::unordered_map<std::string, InlineConfig> inline_configs;
 
     // Scan files to expand for inline configs
-    for (const auto& path : filesToExpand) {
+    for (const auto& path : filesToExpand_) {
         std::ifstream file(path);
         if (!file) continue;
 
@@ -408,7 +688,7 @@ int main(int argc, char* argv[]) {
         InlineConfig inline_cfg = parseInlineConfig(content, path.string(), &prescan_diagnostics);
 
         // Store for later use (avoids re-parsing in Tool::expandFile)
-        inline_configs[path.string()] = inline_cfg;
+        inline_configs_[path.string()] = inline_cfg;
 
         // Resolve paths relative to the source file's directory
         fs::path file_dir = fs::absolute(path).parent_path();
@@ -416,16 +696,17 @@ int main(int argc, char* argv[]) {
         // Add library search directories (-y equivalent)
         for (const auto& dir : inline_cfg.libdirs) {
             fs::path resolved = (file_dir / dir).lexically_normal();
-            driver.sourceLoader.addSearchDirectories(resolved.string());
+            driver_.sourceLoader.addSearchDirectories(resolved.string());
+            library_dirs_.push_back(resolved);
         }
         // Add library file extensions (+libext+ equivalent)
         for (const auto& ext : inline_cfg.libext) {
-            driver.sourceLoader.addSearchExtension(ext);
+            driver_.sourceLoader.addSearchExtension(ext);
         }
         // Add include directories (+incdir+ equivalent)
         for (const auto& dir : inline_cfg.incdirs) {
             fs::path resolved = (file_dir / dir).lexically_normal();
-            driver.sourceManager.addUserDirectories(resolved.string());
+            driver_.sourceManager.addUserDirectories(resolved.string());
         }
     }
 
@@ -441,244 +722,1050 @@ int main(int argc, char* argv[]) {
     // Clean mode: strip AUTO expansions and exit (no slang compilation needed)
     // ========================================================================
 
-    if (cleanMode.value_or(false)) {
-        int files_cleaned = 0;
+    if (flags_.cleanMode.value_or(false)) {
+        return clean();
+    }
 
-        for (const auto& path : filesToExpand) {
-            std::ifstream ifs(path);
-            if (!ifs) {
-                OS::printE(fmt::format("error: Failed to open file: {}\n", path.string()));
-                continue;
-            }
+    // ========================================================================
+    // Parse all sources (syntax trees are reused across compilations)
+    // ========================================================================
+
+    {
+        TimeTraceScope trace("Parse sources");
+        auto start = std::chrono::steady_clock::now();
+        bool parsed = driver_.parseAllSources();
+        parse_sources_us_ = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count());
+        if (!parsed)
+            return 3;
+    }
 
-            std::stringstream buffer;
-            buffer << ifs.rdbuf();
-            std::string original = buffer.str();
-            ifs.close();
-
-            std::string cleaned = stripAutoExpansions(original);
-
-            if (cleaned != original) {
-                if (dryRun.value_or(false) || diffMode.value_or(false)) {
-                    if (diffMode.value_or(false)) {
-                        // Generate diff output
-                        OS::print(fmt::format("--- {}\n+++ {}\n", path.string(), path.string()));
-                        // Simple diff: show that content changed
-                        OS::print("@@ cleaned AUTO expansion blocks @@\n");
-                    }
-                    OS::print(fmt::format("Would clean: {}\n", path.string()));
-                } else {
-                    std::ofstream ofs(path);
-                    if (!ofs) {
-                        OS::printE(fmt::format("error: Failed to write file: {}\n", path.string()));
-                        continue;
-                    }
-                    ofs << cleaned;
-                    ofs.close();
-                    ++files_cleaned;
-                    if (verbosity >= 1) {
-                        OS::print(fmt::format("Cleaned: {}\n", path.string()));
-                    }
+    // ========================================================================
+    // Record inputs so a warm session notices edits
+    // ========================================================================
+    // Every loaded buffer (sources, library files, includes) and its
+    // directory, so that files added to a library directory are noticed too.
+
+    if (keep_warm_) {
+        for (auto buffer : driver_.sourceManager.getAllBuffers()) {
+            const fs::path& full_path = driver_.sourceManager.getFullPath(buffer);
+            if (full_path.empty()) continue;
+            inputs_.add(full_path);
+            inputs_.add(full_path.parent_path());
+        }
+        for (const auto& path : filesToExpand_) {
+            inputs_.add(fs::absolute(path));
+        }
+        if (found_config_path) {
+            inputs_.add(fs::absolute(*found_config_path));
+        }
+    }
+
+    return std::nullopt;
+}
+
+int CliSession::clean() {
+    bool dry_run = flags_.dryRun.value_or(false);
+    bool diff_mode = flags_.diffMode.value_or(false);
+    int files_cleaned = 0;
+
+    for (const auto& path : filesToExpand_) {
+        std::ifstream ifs(path);
+        if (!ifs) {
+            OS::printE(fmt::format("error: Failed to open file: {}\n", path.string()));
+            continue;
+        }
+
+        std::stringstream buffer;
+        buffer << ifs.rdbuf();
+        std::string original = buffer.str();
+        ifs.close();
+
+        std::string cleaned = stripAutos(original);
+
+        if (cleaned != original) {
+            if (dry_run || diff_mode) {
+                if (diff_mode) {
+                    SourceWriter writer(true);
+                    OS::print(writer.generateDiff(path, original, cleaned));
                 }
+                OS::print(fmt::format("Would clean: {}\n", path.string()));
             } else {
-                if (verbosity >= 2) {
-                    OS::print(fmt::format("No expansions to clean: {}\n", path.string()));
+                std::ofstream ofs(path);
+                if (!ofs) {
+                    OS::printE(fmt::format("error: Failed to write file: {}\n", path.string()));
+                    continue;
+                }
+                ofs << cleaned;
+                ofs.close();
+                ++files_cleaned;
+                if (verbosity_ >= 1) {
+                    OS::print(fmt::format("Cleaned: {}\n", path.string()));
                 }
             }
+        } else {
+            if (verbosity_ >= 2) {
+                OS::print(fmt::format("No expansions to clean: {}\n", path.string()));
+            }
         }
+    }
+
+    if (verbosity_ >= 1 && !dry_run) {
+        OS::print(fmt::format("Cleaned {} file(s)\n", files_cleaned));
+    }
+
+    return 0;
+}
 
-        if (verbosity >= 1 && !dryRun.value_or(false)) {
-            OS::print(fmt::format("Cleaned {} file(s)\n", files_cleaned));
+int CliSession::affected() {
+    // ========================================================================
+    // Index the files to expand (module headers and instantiations only)
+    // ========================================================================
+
+    if (filesToExpand_.empty()) {
+        OS::printE("error: no input files specified\n");
+        return 1;
+    }
+
+    auto read_text = [](const fs::path& path) -> std::optional<std::string> {
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs) return std::nullopt;
+        std::stringstream buffer;
+        buffer << ifs.rdbuf();
+        return buffer.str();
+    };
+
+    DependencyIndex index;
+    for (const auto& path : filesToExpand_) {
+        if (auto text = read_text(path)) {
+            index.addFile(pathKey(path), *text);
         }
+    }
 
-        return 0;
+    PortSignatures signatures;
+    bool have_signatures = false;
+    if (flags_.portSignaturesPath) {
+        if (auto stored = loadPortSignatures(*flags_.portSignaturesPath)) {
+            signatures = std::move(*stored);
+            have_signatures = true;
+        }
     }
 
     // ========================================================================
-    // Parse all sources (syntax trees are reused across compilations)
+    // Changed modules: those whose port signature differs from the stored one
     // ========================================================================
 
-    if (!driver.parseAllSources())
-        return 3;
+    std::set<std::string> stale;
+    std::set<std::string> changed_modules;
+    bool everything = false;
+
+    for (const auto& changed : flags_.affectedBy) {
+        std::string key = pathKey(changed);
+        if (index.contains(key)) {
+            stale.insert(key);  // A file to expand was edited itself
+        }
+
+        auto text = read_text(changed);
+        if (!text) {
+            // Removed: whatever it declared is gone, and we can't tell what
+            everything = true;
+            if (verbosity_ >= 2) {
+                OS::printE(fmt::format("affected: {} is missing, all files are stale\n", changed));
+            }
+            continue;
+        }
+
+        auto interfaces = moduleInterfaces(*text);
+        if (interfaces.empty() && !index.contains(key)) {
+            // A package or include: any file may depend on it, as in --watch
+            everything = true;
+            if (verbosity_ >= 2) {
+                OS::printE(fmt::format("affected: {} declares no modules, all files are stale\n",
+                                       changed));
+            }
+            continue;
+        }
+
+        for (auto& module : interfaces) {
+            auto it = signatures.find(module.name);
+            bool same = have_signatures && it != signatures.end() && it->second == module.hash;
+            if (!same) {
+                changed_modules.insert(module.name);
+                if (verbosity_ >= 2) {
+                    OS::printE(fmt::format("affected: ports of '{}' changed\n", module.name));
+                }
+            }
+            signatures[module.name] = module.hash;
+        }
+    }
+
+    auto dependents = index.affectedBy(changed_modules);
+    stale.insert(dependents.begin(), dependents.end());
 
     // ========================================================================
-    // Run AUTO expansion (per-file compilation with --top set to filename)
+    // Report in command line order, and store the current signatures
     // ========================================================================
 
-    bool dry_run = dryRun.value_or(false);
-    bool diff_mode = diffMode.value_or(false);
-    bool check_mode = checkMode.value_or(false);
+    for (const auto& path : filesToExpand_) {
+        if (everything || stale.contains(pathKey(path))) {
+            OS::print(fmt::format("{}\n", path.string()));
+        }
+    }
 
-    int total_autoinst = 0;
-    int total_autologic = 0;
-    int total_autoports = 0;
-    int files_changed = 0;
-    bool any_errors = false;
+    if (flags_.portSignaturesPath && !savePortSignatures(*flags_.portSignaturesPath, signatures)) {
+        OS::printE(fmt::format("error: Failed to write port signatures: {}\n",
+                               *flags_.portSignaturesPath));
+        return 1;
+    }
+    return 0;
+}
 
-    for (const auto& path : filesToExpand) {
-        if (verbosity >= 2) {
-            OS::print(fmt::format("Processing: {}\n", path.string()));
-        }
+void CliSession::elaborate(const fs::path& path, FileState& state) {
+    state.elaborated = true;
+
+    // Create compilation with this top module (reuses parsed syntax trees).
+    // --check elaborates files concurrently; only this step touches the driver.
+    std::unique_ptr<ast::Compilation> compilation;
+    std::chrono::steady_clock::time_point start;
+    {
+        TimeTraceScope trace("Create compilation", path.string());
+        std::lock_guard<std::mutex> lock(driver_mutex_);
+        start = std::chrono::steady_clock::now();  // Not counting the wait for the driver
 
         // Set --top to the filename (e.g., "foo.sv" -> "foo")
         // This limits elaboration scope to just this module
-        driver.options.topModules = {path.stem().string()};
-
-        // Create compilation with this top module (reuses parsed syntax trees)
-        auto compilation = driver.createCompilation();
-
-        // Process slang diagnostics
-        // Critical errors that prevent correct expansion:
-        // - InvalidTopModule: module name doesn't match filename
-        // - CouldNotOpenIncludeFile: missing include file (macros won't be defined)
-        // - UnknownDirective: undefined macro (will cause garbage output)
-        //
-        // Since we only add top + direct children to slang (not grandchildren),
-        // these errors will only occur in files we care about.
-        {
-            auto& diags = compilation->getAllDiagnostics();
-            bool hasInvalidTop = false;
-            bool hasCriticalError = false;
-            std::vector<std::string> criticalMessages;
-
-            // Get canonical path for comparison
-            fs::path canonical_top = fs::canonical(path);
-
-            for (const auto& d : diags) {
-                if (d.code == slang::diag::InvalidTopModule) {
-                    hasInvalidTop = true;
-                    hasCriticalError = true;
-                }
-                // Check for missing include files - only critical if in top file
-                // Grandchildren with missing includes should not block expansion
-                else if (d.code == slang::diag::CouldNotOpenIncludeFile) {
-                    auto error_file = driver.sourceManager.getFileName(d.location);
-                    bool in_top = false;
-                    if (!error_file.empty()) {
-                        try {
-                            in_top = (fs::canonical(std::string(error_file)) == canonical_top);
-                        } catch (...) {}
-                    }
-                    if (in_top) {
-                        hasCriticalError = true;
-                        criticalMessages.push_back("Missing include file - macros may be undefined");
-                    }
-                }
-                // Check for unknown directives (undefined macros) - only critical if in top file
-                else if (d.code == slang::diag::UnknownDirective) {
-                    auto error_file = driver.sourceManager.getFileName(d.location);
-                    bool in_top = false;
-                    if (!error_file.empty()) {
-                        try {
-                            in_top = (fs::canonical(std::string(error_file)) == canonical_top);
-                        } catch (...) {}
-                    }
-                    if (in_top) {
-                        hasCriticalError = true;
-                        criticalMessages.push_back("Undefined macro or directive");
-                    }
-                }
-            }
+        driver_.options.topModules = {path.stem().string()};
+        compilation = driver_.createCompilation();
+    }
 
-            // Always show critical slang diagnostics, verbose mode shows all
-            if (hasCriticalError || (verbosity >= 2 && !diags.empty())) {
-                OS::printE(slang::DiagnosticEngine::reportAll(
-                    driver.sourceManager, diags));
+    // Process slang diagnostics
+    // Critical errors that prevent correct expansion:
+    // - InvalidTopModule: module name doesn't match filename
+    // - CouldNotOpenIncludeFile: missing include file (macros won't be defined)
+    // - UnknownDirective: undefined macro (will cause garbage output)
+    //
+    // Since we only add top + direct children to slang (not grandchildren),
+    // these errors will only occur in files we care about.
+    TimeTraceScope trace("Diagnostics", path.string());
+    auto& diags = compilation->getAllDiagnostics();  // Elaborates the design
+    state.elaborate_us = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    bool hasInvalidTop = false;
+    bool hasCriticalError = false;
+    std::vector<std::string> criticalMessages;
+
+    // Get canonical path for comparison
+    fs::path canonical_top = fs::canonical(path);
+
+    for (const auto& d : diags) {
+        if (d.code == slang::diag::InvalidTopModule) {
+            hasInvalidTop = true;
+            hasCriticalError = true;
+        }
+        // Check for missing include files - only critical if in top file
+        // Grandchildren with missing includes should not block expansion
+        else if (d.code == slang::diag::CouldNotOpenIncludeFile) {
+            auto error_file = driver_.sourceManager.getFileName(d.location);
+            bool in_top = false;
+            if (!error_file.empty()) {
+                try {
+                    in_top = (fs::canonical(std::string(error_file)) == canonical_top);
+                } catch (...) {}
+            }
+            if (in_top) {
+                hasCriticalError = true;
+                criticalMessages.push_back("Missing include file - macros may be undefined");
             }
+        }
+        // Check for unknown directives (undefined macros) - only critical if in top file
+        else if (d.code == slang::diag::UnknownDirective) {
+            auto error_file = driver_.sourceManager.getFileName(d.location);
+            bool in_top = false;
+            if (!error_file.empty()) {
+                try {
+                    in_top = (fs::canonical(std::string(error_file)) == canonical_top);
+                } catch (...) {}
+            }
+            if (in_top) {
+                hasCriticalError = true;
+                criticalMessages.push_back("Undefined macro or directive");
+            }
+        }
+    }
 
-            // Special handling for InvalidTopModule
-            if (hasInvalidTop) {
-                any_errors = true;
-                OS::printE(fmt::format(
-                    "note: slang-autos requires the module name to match the filename.\n"
-                    "      Expected module '{}' in file '{}'.\n",
-                    path.stem().string(), path.string()));
-                continue;
+    // Always show critical slang diagnostics, verbose mode shows all
+    if (hasCriticalError || (verbosity_ >= 2 && !diags.empty())) {
+        state.slang_report = slang::DiagnosticEngine::reportAll(driver_.sourceManager, diags);
+    }
+
+    // Special handling for InvalidTopModule
+    if (hasInvalidTop) {
+        state.blocked_message = fmt::format(
+            "note: slang-autos requires the module name to match the filename.\n"
+            "      Expected module '{}' in file '{}'.\n",
+            path.stem().string(), path.string());
+        return;
+    }
+
+    // Block expansion on critical preprocessing errors
+    // These will cause garbage output if we proceed
+    if (hasCriticalError) {
+        state.blocked_message = fmt::format(
+            "error: Cannot expand '{}' due to preprocessing errors.\n"
+            "       Check that all include directories are specified with -I or +incdir+\n"
+            "       and that all required macros are defined with +define+.\n",
+            path.string());
+        return;
+    }
+
+    // For other slang errors (timescale, elaboration, etc.): proceed with expansion
+    // These typically don't affect port parsing
+
+    state.tool = std::make_unique<AutosTool>(options_);
+    state.tool->setCompilation(std::move(compilation));
+    for (const auto& snapshot : port_snapshots_) {
+        state.tool->addPortSnapshot(snapshot);
+    }
+
+    // Pass pre-parsed inline config (avoids re-parsing)
+    auto it = inline_configs_.find(path.string());
+    if (it != inline_configs_.end()) {
+        state.tool->setInlineConfig(path, it->second);
+    }
+}
+
+CliSession::FileOutcome CliSession::expandOne(const fs::path& path, FileState& state,
+                                              bool no_write, bool streaming, bool check) {
+    TimeTraceScope file_trace("File", path.string());
+
+    // Elaboration is charged to the run that performed it, not to warm reruns
+    bool elaborated_now = !state.elaborated;
+    if (elaborated_now) {
+        elaborate(path, state);
+    }
+
+    FileOutcome outcome;
+    outcome.ran = true;
+    outcome.slang_report = state.slang_report;
+    outcome.blocked_message = state.blocked_message;
+    if (!outcome.blocked_message.empty()) {
+        return outcome;
+    }
+
+    // Expand autos in this file
+    AutosTool& tool = *state.tool;
+    tool.diagnostics().clear();
+    {
+        TimeTraceScope trace(check ? "Check" : "Expand", path.string());
+        if (check) {
+            outcome.result = tool.checkFile(path);
+        } else {
+            outcome.result = streaming ? tool.expandFileStreaming(path, no_write)
+                                       : tool.expandFile(path, no_write);
+        }
+    }
+    if (elaborated_now) {
+        outcome.result.stats.elaborate_us += state.elaborate_us;
+    }
+    outcome.diagnostics = std::move(tool.diagnostics());
+    tool.diagnostics().clear();
+    return outcome;
+}
+
+std::vector<CliSession::FileOutcome> CliSession::checkAll() {
+    const size_t count = filesToExpand_.size();
+    std::vector<FileOutcome> outcomes(count);
+
+    // Resolve per-file state up front: files_ must not be modified concurrently
+    std::vector<FileState*> states(count, nullptr);
+    std::vector<FileState> local_states(keep_warm_ ? 0 : count);
+    for (size_t i = 0; i < count; ++i) {
+        states[i] = keep_warm_ ? &files_[filesToExpand_[i].string()] : &local_states[i];
+    }
+
+    unsigned jobs = flags_.checkJobs.value_or(0);
+    if (jobs == 0) {
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    jobs = static_cast<unsigned>(std::min<size_t>(jobs, std::max<size_t>(count, 1)));
+    bool fail_fast = flags_.failFast.value_or(false);
+
+    // Files are claimed in order, so a fail-fast run checks a prefix of them
+    // (plus whatever other workers had already started)
+    std::atomic<size_t> next{0};
+    std::atomic<bool> stop{false};
+
+    auto work = [&]() {
+        while (!stop) {
+            size_t index = next++;
+            if (index >= count) break;
+
+            auto& outcome = outcomes[index];
+            outcome = expandOne(filesToExpand_[index], *states[index], /*no_write=*/true,
+                                /*streaming=*/true, /*check=*/true);
+            if (!keep_warm_) {
+                local_states[index] = FileState();  // Release the compilation now
             }
 
-            // Block expansion on critical preprocessing errors
-            // These will cause garbage output if we proceed
-            if (hasCriticalError) {
-                any_errors = true;
-                OS::printE(fmt::format(
-                    "error: Cannot expand '{}' due to preprocessing errors.\n"
-                    "       Check that all include directories are specified with -I or +incdir+\n"
-                    "       and that all required macros are defined with +define+.\n",
-                    path.string()));
-                continue;
+            bool failed = !outcome.blocked_message.empty() || !outcome.result.success ||
+                          outcome.diagnostics.hasErrors();
+            if (fail_fast && (failed || outcome.result.hasNonWhitespaceChanges())) {
+                stop = true;
             }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(jobs - 1);
+    for (unsigned w = 1; w < jobs; ++w) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& t : threads) {
+        t.join();
+    }
+    return outcomes;
+}
 
-            // For other slang errors (timescale, elaboration, etc.): proceed with expansion
-            // These typically don't affect port parsing
+int CliSession::expand() {
+    // ========================================================================
+    // Run AUTO expansion (per-file compilation with --top set to filename)
+    // ========================================================================
+
+    bool dry_run = flags_.dryRun.value_or(false);
+    bool diff_mode = flags_.diffMode.value_or(false);
+    bool check_mode = flags_.checkMode.value_or(false);
+    // --diff needs the full modified text
+    bool streaming = flags_.lowMemory.value_or(false) && !diff_mode;
+    const auto& statsFormat = flags_.statsFormat;
+
+    int total_autoinst = 0;
+    int total_autologic = 0;
+    int total_autoports = 0;
+    ArenaStats arena_stats;
+    ExpansionStats run_stats;
+    run_stats.parse_us = parse_sources_us_;  // Shared by all files, so only in the total
+    std::vector<std::string> file_stats_json;  // One JSON object per file (--stats=json)
+    std::string depfile;                       // One rule per expanded file (--depfile)
+    int files_changed = 0;
+    size_t files_skipped = 0;
+    std::vector<std::string> changed_files;
+    bool any_errors = false;
+
+    // --check decides every file up front, concurrently; the loop below
+    // reports the outcomes in file order
+    std::vector<FileOutcome> checked;
+    if (check_mode && !diff_mode) {
+        checked = checkAll();
+    }
+    // checkFile() stops analyzing a file after the first module that needs
+    // expansion, so its AUTO counts are lower bounds and are not reported
+    bool partial_counts = check_mode && !diff_mode;
+
+    for (size_t index = 0; index < filesToExpand_.size(); ++index) {
+        const auto& path = filesToExpand_[index];
+        if (verbosity_ >= 2) {
+            report(fmt::format("Processing: {}\n", path.string()));
         }
 
-        // Expand autos in this file
-        AutosTool tool(options);
-        tool.setCompilation(std::move(compilation));
+        FileOutcome outcome;
+        if (!checked.empty()) {
+            outcome = std::move(checked[index]);
+        } else {
+            // Warm sessions keep each file's compilation and port cache
+            FileState local_state;
+            FileState& state = keep_warm_ ? files_[path.string()] : local_state;
+            outcome = expandOne(path, state, dry_run || diff_mode || check_mode, streaming);
+        }
 
-        // Pass pre-parsed inline config (avoids re-parsing)
-        auto it = inline_configs.find(path.string());
-        if (it != inline_configs.end()) {
-            tool.setInlineConfig(path, it->second);
+        if (!outcome.ran) {
+            ++files_skipped;
+            continue;
+        }
+        if (!outcome.slang_report.empty()) {
+            OS::printE(outcome.slang_report);
+        }
+        if (!outcome.blocked_message.empty()) {
+            any_errors = true;
+            OS::printE(outcome.blocked_message);
+            continue;
         }
 
-        auto result = tool.expandFile(path, dry_run || diff_mode || check_mode);
+        ExpansionResult& result = outcome.result;
+        const DiagnosticCollector& diagnostics = outcome.diagnostics;
+
+        auto record_stats = [&](bool changed) {
+            run_stats += result.stats;
+            if (statsFormat && partial_counts) {
+                file_stats_json.push_back(fmt::format(
+                    "{{\"path\":{},\"success\":{},\"changed\":{},\"partial\":true,\"stats\":{}}}",
+                    jsonQuote(path.string()), result.success, changed, toJson(result.stats)));
+            } else if (statsFormat) {
+                file_stats_json.push_back(fmt::format(
+                    "{{\"path\":{},\"success\":{},\"changed\":{},\"autoinst\":{},"
+                    "\"autologic\":{},\"autoports\":{},\"stats\":{}}}",
+                    jsonQuote(path.string()), result.success, changed, result.autoinst_count,
+                    result.autologic_count, result.autoports_count, toJson(result.stats)));
+            }
+        };
 
         if (!result.success) {
+            record_stats(false);
             any_errors = true;
             // Print diagnostics for this file (always show - these are config/tool issues)
-            if (tool.diagnostics().hasErrors() || tool.diagnostics().warningCount() > 0) {
-                OS::printE(tool.diagnostics().format());
+            if (diagnostics.hasErrors() || diagnostics.warningCount() > 0) {
+                OS::printE(diagnostics.format());
             }
             continue;
         }
 
+        if (flags_.depfilePath) {
+            std::unordered_set<std::string> roots{pathKey(path)};
+            std::vector<std::string> deps;
+            for (const auto& source : result.port_sources) {
+                if (roots.insert(pathKey(source)).second) {
+                    deps.push_back(pathKey(source));
+                }
+            }
+            for (auto& include : includedBy(roots)) {
+                deps.push_back(std::move(include));
+            }
+            if (config_path_) {
+                deps.push_back(config_path_->string());
+            }
+            depfile += formatDepfileRule(path.string(), deps);
+        }
+
+        submodules_[pathKey(path)] = std::move(result.submodules);
+
         total_autoinst += result.autoinst_count;
         total_autologic += result.autologic_count;
         total_autoports += result.autoports_count;
+        arena_stats += result.arena_stats;
 
         // In check mode, ignore whitespace-only differences (e.g. from formatters)
         bool changed = check_mode ? result.hasNonWhitespaceChanges()
                                   : result.hasChanges();
+        record_stats(changed);
 
         if (changed) {
             ++files_changed;
+            changed_files.push_back(path.string());
 
             if (diff_mode) {
                 SourceWriter writer(true);
                 OS::print(writer.generateDiff(path, result.original_content,
                                               result.modified_content));
-            } else if (verbosity >= 1) {
-                OS::print(fmt::format("{}: {} AUTOINST, {} AUTOLOGIC, {} AUTOPORTS\n",
-                                      path.string(), result.autoinst_count,
-                                      result.autologic_count, result.autoports_count));
+            } else if (verbosity_ >= 1 && partial_counts) {
+                report(fmt::format("{}: needs AUTO expansion\n", path.string()));
+            } else if (verbosity_ >= 1) {
+                report(fmt::format("{}: {} AUTOINST, {} AUTOLOGIC, {} AUTOPORTS\n",
+                                   path.string(), result.autoinst_count,
+                                   result.autologic_count, result.autoports_count));
             }
         }
 
         // Print diagnostics for this file (always show - these are config/tool issues)
-        if (tool.diagnostics().hasErrors()) {
+        if (diagnostics.hasErrors()) {
             any_errors = true;
-            OS::printE(tool.diagnostics().format());
-        } else if (tool.diagnostics().warningCount() > 0) {
-            OS::printE(tool.diagnostics().format());
+            OS::printE(diagnostics.format());
+        } else if (diagnostics.warningCount() > 0) {
+            OS::printE(diagnostics.format());
         }
     }
 
     // Print summary
-    if (verbosity >= 1 && !diff_mode) {
+    if (verbosity_ >= 1 && !diff_mode) {
         std::string change_verb = (dry_run || check_mode) ? "would be " : "";
-        OS::print(fmt::format("\nSummary: {} file(s) {}changed, {} AUTOINST, {} AUTOLOGIC, {} AUTOPORTS\n",
-                              files_changed, change_verb,
-                              total_autoinst, total_autologic, total_autoports));
+        if (partial_counts) {
+            report(fmt::format("\nSummary: {} file(s) {}changed\n", files_changed, change_verb));
+        } else {
+            report(fmt::format("\nSummary: {} file(s) {}changed, {} AUTOINST, {} AUTOLOGIC, {} AUTOPORTS\n",
+                               files_changed, change_verb,
+                               total_autoinst, total_autologic, total_autoports));
+        }
+        if (files_skipped > 0) {
+            report(fmt::format("{} file(s) not checked (--fail-fast)\n", files_skipped));
+        }
+    }
+    if (verbosity_ >= 2 && !diff_mode) {
+        report(fmt::format("Arena: {} module(s), {} allocation(s), {} bytes, "
+                           "{} heap block(s), peak {} bytes/module\n",
+                           arena_stats.modules, arena_stats.allocations,
+                           arena_stats.bytes, arena_stats.heap_allocations,
+                           arena_stats.peak_module_bytes));
+    }
+
+    if (statsFormat) {
+        std::string json = "{\"files\":[";
+        for (size_t i = 0; i < file_stats_json.size(); ++i) {
+            json += i ? ",\n" : "\n";
+            json += file_stats_json[i];
+        }
+        if (partial_counts) {
+            json += fmt::format("\n],\"total\":{{\"files\":{},\"files_changed\":{},"
+                                "\"partial\":true,\"stats\":{}}}}}\n",
+                                file_stats_json.size(), files_changed, toJson(run_stats));
+        } else {
+            json += fmt::format("\n],\"total\":{{\"files\":{},\"files_changed\":{},\"autoinst\":{},"
+                                "\"autologic\":{},\"autoports\":{},\"stats\":{}}}}}\n",
+                                file_stats_json.size(), files_changed, total_autoinst,
+                                total_autologic, total_autoports, toJson(run_stats));
+        }
+        OS::print(json);
+    }
+
+    if (flags_.depfilePath) {
+        std::ofstream ofs(*flags_.depfilePath, std::ios::binary);
+        if (!(ofs << depfile)) {
+            OS::printE(fmt::format("error: Failed to write depfile: {}\n", *flags_.depfilePath));
+            any_errors = true;
+        }
     }
 
     // In check mode, exit 1 if any files would be changed (for CI)
+    int exit_code = any_errors ? 1 : 0;
     if (check_mode && files_changed > 0) {
-        if (verbosity >= 1) {
+        if (verbosity_ >= 1) {
             OS::printE("error: files need AUTO expansion (run without --check to apply)\n");
         }
+        exit_code = 1;
+    }
+
+    if (flags_.shardResultPath) {
+        ShardResult shard_result;
+        shard_result.exit_code = exit_code;
+        shard_result.files = filesToExpand_.size();
+        shard_result.files_changed = static_cast<size_t>(files_changed);
+        shard_result.autoinst = total_autoinst;
+        shard_result.autologic = total_autologic;
+        shard_result.autoports = total_autoports;
+        shard_result.partial = partial_counts;
+        shard_result.changed = std::move(changed_files);
+        writeShardResult(shard_result);
+    }
+
+    return exit_code;
+}
+
+int CliSession::run(const std::vector<std::string>& args) {
+    if (!configured_) {
+        if (auto code = configure(args)) {
+            return *code;
+        }
+        configured_ = true;
+    }
+
+    if (!flags_.affectedBy.empty()) {
+        return affected();
+    }
+    if (!flags_.mergeShards.empty()) {
+        return mergeShards();
+    }
+
+    // Write the trace on every exit path; declared before any span so that
+    // all spans have closed by the time it is written
+    struct TimeTraceGuard {
+        std::optional<std::string> path;
+        ~TimeTraceGuard() {
+            if (path && !timeTraceWrite(*path)) {
+                OS::printE(fmt::format("warning: failed to write time trace '{}'\n", *path));
+            }
+        }
+    } time_trace_guard;
+    if (flags_.timeTracePath) {
+        timeTraceBegin();
+        time_trace_guard.path = flags_.timeTracePath;
+    }
+    TimeTraceScope total_trace("slang-autos");
+
+    if (!loaded_) {
+        if (auto code = load()) {
+            return *code;
+        }
+        loaded_ = true;
+    }
+
+    return expand();
+}
+
+std::vector<std::string> CliSession::includedBy(const std::unordered_set<std::string>& files) const {
+    const auto& sm = driver_.sourceManager;
+    std::vector<std::string> includes;
+    for (auto buffer : sm.getAllBuffers()) {
+        auto included_from = sm.getIncludedFrom(buffer);
+        if (!included_from.valid()) continue;  // Not an include
+
+        // Follow nested includes up to the file that started the chain
+        auto root = included_from.buffer();
+        while (sm.getIncludedFrom(root).valid()) {
+            root = sm.getIncludedFrom(root).buffer();
+        }
+        if (files.contains(pathKey(sm.getFullPath(root)))) {
+            includes.push_back(pathKey(sm.getFullPath(buffer)));
+        }
+    }
+    std::sort(includes.begin(), includes.end());
+    includes.erase(std::unique(includes.begin(), includes.end()), includes.end());
+    return includes;
+}
+
+std::vector<fs::path> CliSession::sourceFiles() const {
+    std::vector<fs::path> files;
+    for (auto buffer : driver_.sourceManager.getAllBuffers()) {
+        const fs::path& full_path = driver_.sourceManager.getFullPath(buffer);
+        if (!full_path.empty()) {
+            files.push_back(pathKey(full_path));
+        }
+    }
+    return files;
+}
+
+std::vector<fs::path> CliSession::watchDirectories() const {
+    std::set<fs::path> dirs(library_dirs_.begin(), library_dirs_.end());
+    for (const auto& path : filesToExpand_) {
+        dirs.insert(fs::path(pathKey(path)).parent_path());
+    }
+    for (const auto& path : sourceFiles()) {
+        dirs.insert(path.parent_path());
+    }
+    if (config_path_) {
+        dirs.insert(config_path_->parent_path());
+    }
+    return {dirs.begin(), dirs.end()};
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// Watch
+// ════════════════════════════════════════════════════════════════════════════
+
+/// State carried between --watch runs: what each expanded file depends on,
+/// the interface of every loaded module, and what we last wrote.
+class WatchState {
+public:
+    /// Take in the results of a (possibly restricted) run
+    void absorb(const CliSession& session, FileWatcher& watcher) {
+        for (const auto& path : session.filesToExpand()) {
+            std::string key = pathKey(path);
+            expanded_.insert(key);
+            if (auto content = readText(key)) {
+                written_[key] = std::hash<std::string>{}(*content);
+            }
+        }
+        for (const auto& [file, submodules] : session.submodules()) {
+            setSubmodules(file, submodules);
+        }
+
+        // Interfaces of files already known are only updated from change
+        // events, so that our own AUTOPORTS rewrite of a file still reaches
+        // that file's parents.
+        for (const auto& path : session.sourceFiles()) {
+            if (interfaces_.contains(path.string())) continue;
+            if (auto content = readText(path)) {
+                interfaces_[path.string()] = moduleInterfaces(*content);
+            }
+        }
+
+        for (const auto& dir : session.watchDirectories()) {
+            watcher.addDirectory(dir);
+        }
+        if (session.configPath()) {
+            config_path_ = session.configPath()->string();
+        }
+    }
+
+    /// Files to expand affected by a batch of changed paths
+    std::unordered_set<std::string> affected(const std::vector<fs::path>& changed,
+                                             std::vector<std::string>& reasons) {
+        std::unordered_set<std::string> result;
+        bool everything = false;
+
+        for (const auto& path : changed) {
+            std::string key = path.string();
+            if (key == config_path_) {
+                everything = true;
+                reasons.push_back(path.filename().string());
+                continue;
+            }
+            if (!isValidExtension(path)) continue;
+
+            auto content = readText(path);
+
+            // An expanded file edited by someone other than us
+            if (expanded_.contains(key) && content &&
+                std::hash<std::string>{}(*content) != written_[key]) {
+                result.insert(key);
+                reasons.push_back(path.filename().string());
+            }
+
+            // Which modules' interfaces changed
+            auto& old_interfaces = interfaces_[key];
+            std::vector<ModuleInterface> new_interfaces;
+            if (content) {
+                new_interfaces = moduleInterfaces(*content);
+            }
+            if (content && new_interfaces.empty() && !expanded_.contains(key)) {
+                // A package or include: anything may depend on it
+                everything = true;
+                reasons.push_back(path.filename().string());
+            }
+            for (const auto& module : changedModules(old_interfaces, new_interfaces)) {
+                reasons.push_back(module);
+                auto it = parents_.find(module);
+                if (it != parents_.end()) {
+                    result.insert(it->second.begin(), it->second.end());
+                }
+            }
+            if (content) {
+                old_interfaces = std::move(new_interfaces);
+            } else {
+                interfaces_.erase(key);
+            }
+        }
+
+        if (everything) {
+            result.insert(expanded_.begin(), expanded_.end());
+        }
+        return result;
+    }
+
+private:
+    /// Replace a file's entries in the reverse dependency map
+    void setSubmodules(const std::string& file, const std::vector<std::string>& submodules) {
+        for (const auto& module : submodules_[file]) {
+            parents_[module].erase(file);
+        }
+        for (const auto& module : submodules) {
+            parents_[module].insert(file);
+        }
+        submodules_[file] = submodules;
+    }
+
+    /// Names of modules added, removed or with a different interface hash
+    static std::set<std::string> changedModules(const std::vector<ModuleInterface>& before,
+                                                const std::vector<ModuleInterface>& after) {
+        std::set<std::string> changed;
+        for (const auto& module : before) {
+            auto it = std::find_if(after.begin(), after.end(),
+                                   [&](const ModuleInterface& m) { return m.name == module.name; });
+            if (it == after.end() || it->hash != module.hash) {
+                changed.insert(module.name);
+            }
+        }
+        for (const auto& module : after) {
+            auto it = std::find_if(before.begin(), before.end(),
+                                   [&](const ModuleInterface& m) { return m.name == module.name; });
+            if (it == before.end()) {
+                changed.insert(module.name);
+            }
+        }
+        return changed;
+    }
+
+    static std::optional<std::string> readText(const fs::path& path) {
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs) return std::nullopt;
+        std::stringstream buffer;
+        buffer << ifs.rdbuf();
+        return buffer.str();
+    }
+
+    std::unordered_set<std::string> expanded_;                  ///< Every file to expand
+    std::unordered_map<std::string, size_t> written_;           ///< Content hash after our last run
+    std::unordered_map<std::string, std::vector<ModuleInterface>> interfaces_;  ///< By loaded file
+    std::unordered_map<std::string, std::vector<std::string>> submodules_;      ///< File → modules
+    std::unordered_map<std::string, std::set<std::string>> parents_;            ///< Module → files
+    std::string config_path_;
+};
+
+/// Watch the inputs of an initial run and re-expand affected files on change.
+/// A change to a module's ports re-expands only the files instantiating it;
+/// body-only edits to a submodule cause no work at all.
+int runWatch(const std::vector<std::string>& args, CliSession& initial) {
+    FileWatcher watcher;
+    if (!watcher.valid()) {
+        OS::printE("error: --watch is not supported on this platform\n");
         return 1;
     }
 
-    return any_errors ? 1 : 0;
+    WatchState state;
+    state.absorb(initial, watcher);
+    OS::print("watch: waiting for changes (Ctrl-C to stop)\n");
+
+    while (true) {
+        auto changed = watcher.wait(std::chrono::milliseconds(50));
+        if (changed.empty()) continue;
+
+        std::vector<std::string> reasons;
+        auto affected = state.affected(changed, reasons);
+        if (affected.empty()) continue;
+
+        std::sort(reasons.begin(), reasons.end());
+        reasons.erase(std::unique(reasons.begin(), reasons.end()), reasons.end());
+        std::string because;
+        for (const auto& reason : reasons) {
+            because += because.empty() ? reason : ", " + reason;
+        }
+        OS::print(fmt::format("watch: re-expanding {} file(s) ({} changed)\n",
+                              affected.size(), because));
+
+        // slang has no incremental reparse, so a fresh session parses the
+        // sources again but elaborates and expands only the affected files
+        auto start = std::chrono::steady_clock::now();
+        CliSession session;
+        session.restrictTo(std::move(affected));
+        session.run(args);
+        if (session.loaded()) {
+            state.absorb(session, watcher);
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        OS::print(fmt::format("watch: done in {} ms\n", elapsed.count()));
+    }
+}
+
+// ════════════════════════════════════════════════════════════════════════════
+// Daemon
+// ════════════════════════════════════════════════════════════════════════════
+
+/// Daemon-related flags, taken out of argv before the rest is run or forwarded
+struct DaemonArgs {
+    bool daemon = false;
+    bool client = false;
+    bool stop = false;
+    fs::path socket;
+};
+
+DaemonArgs extractDaemonArgs(std::vector<std::string>& args) {
+    DaemonArgs result;
+    std::vector<std::string> rest;
+    rest.reserve(args.size());
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        std::string_view arg(args[i]);
+        if (i > 0 && arg == "--daemon") {
+            result.daemon = true;
+        } else if (i > 0 && arg == "--client") {
+            result.client = true;
+        } else if (i > 0 && arg == "--daemon-stop") {
+            result.stop = true;
+        } else if (i > 0 && arg.starts_with("--daemon-socket=")) {
+            result.socket = std::string(arg.substr(arg.find('=') + 1));
+        } else if (i > 0 && arg == "--daemon-socket" && i + 1 < args.size()) {
+            result.socket = args[++i];
+        } else {
+            rest.push_back(std::move(args[i]));
+        }
+    }
+
+    if (result.socket.empty()) {
+        result.socket = defaultDaemonSocketPath();
+    }
+    args = std::move(rest);
+    return result;
+}
+
+/// Warm sessions kept by the daemon, keyed by working directory and argv.
+/// Identical command lines (the common case for hooks and build rules) reuse
+/// a session until one of its inputs changes.
+class SessionCache {
+public:
+    int run(const DaemonRequest& request) {
+        std::string key = request.cwd;
+        for (const auto& arg : request.args) {
+            key += '\0';
+            key += arg;
+        }
+
+        auto it = std::find_if(sessions_.begin(), sessions_.end(),
+                               [&](const Entry& entry) { return entry.key == key; });
+        if (it != sessions_.end() && it->session->stale()) {
+            sessions_.erase(it);
+            it = sessions_.end();
+        }
+        if (it == sessions_.end()) {
+            sessions_.push_front(Entry{key, std::make_unique<CliSession>(/*keep_warm=*/true)});
+        } else {
+            sessions_.splice(sessions_.begin(), sessions_, it);  // Most recently used first
+        }
+
+        auto& session = *sessions_.front().session;
+        int code = session.run(request.args);
+
+        // Only sessions that got as far as parsing sources are worth keeping
+        if (!session.loaded()) {
+            sessions_.pop_front();
+        }
+        while (sessions_.size() > kMaxSessions) {
+            sessions_.pop_back();
+        }
+        return code;
+    }
+
+private:
+    static constexpr size_t kMaxSessions = 8;
+
+    struct Entry {
+        std::string key;
+        std::unique_ptr<CliSession> session;
+    };
+    std::list<Entry> sessions_;
+};
+
+int runDaemon(const fs::path& socket) {
+    DaemonServer server;
+    DiagnosticCollector diagnostics;
+    if (!server.listen(socket, diagnostics)) {
+        OS::printE(diagnostics.format());
+        return 1;
+    }
+    OS::print(fmt::format("slang-autos daemon listening on {}\n", socket.string()));
+
+    SessionCache sessions;
+    server.serve([&](const DaemonRequest& request) { return sessions.run(request); });
+    return 0;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv, argv + argc);
+    DaemonArgs daemon = extractDaemonArgs(args);
+
+    if (daemon.stop) {
+        if (!stopDaemon(daemon.socket)) {
+            OS::printE(fmt::format("error: no daemon listening on {}\n", daemon.socket.string()));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (daemon.daemon) {
+        return runDaemon(daemon.socket);
+    }
+
+    // Thin client: the daemon runs the command with our stdout/stderr.
+    // Without a daemon, fall through and run locally.
+    if (daemon.client) {
+        DaemonRequest request;
+        std::error_code ec;
+        request.cwd = fs::current_path(ec).string();
+        request.args = args;
+        DiagnosticCollector diagnostics;
+        if (auto code = runDaemonClient(daemon.socket, request, diagnostics)) {
+            if (diagnostics.hasErrors()) {
+                OS::printE(diagnostics.format());
+            }
+            return *code;
+        }
+    }
+
+    CliSession session;
+    int code = session.run(args);
+    if (!session.watchMode() || !session.loaded()) {
+        return code;
+    }
+    return runWatch(args, session);
 }
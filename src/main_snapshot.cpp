@@ -0,0 +1,140 @@
+#include <iostream>
+#include <filesystem>
+#include <set>
+
+#include "slang/driver/Driver.h"
+#include "slang/ast/Compilation.h"
+#include "slang/syntax/AllSyntax.h"
+#include "slang/syntax/SyntaxTree.h"
+#include "slang/util/VersionInfo.h"
+
+#include "slang-autos/CompilationUtils.h"
+#include "slang-autos/Diagnostics.h"
+#include "slang-autos/PortSnapshot.h"
+
+using namespace slang;
+using namespace slang::driver;
+using namespace slang_autos;
+
+namespace fs = std::filesystem;
+
+static bool isValidExtension(const fs::path& path) {
+    auto ext = path.extension().string();
+    return ext == ".v" || ext == ".sv";
+}
+
+int main(int argc, char* argv[]) {
+    Driver driver;
+    driver.addStandardArgs();
+
+    // CLI options
+    std::optional<bool> showHelp;
+    std::optional<bool> showVersion;
+    driver.cmdLine.add("-h,--help", showHelp, "Display available options");
+    driver.cmdLine.add("--version", showVersion, "Display version information and exit");
+
+    std::optional<std::string> output;
+    driver.cmdLine.add("-o,--output", output, "Snapshot file to write", "<file>");
+
+    std::vector<std::string> libraryDirs;
+    driver.cmdLine.add("--library", libraryDirs,
+                       "Directory whose .v/.sv files are all captured (repeatable)", "<dir>");
+
+    std::optional<bool> verbose;
+    driver.cmdLine.add("--verbose", verbose, "List captured modules");
+
+    // Parse command line
+    if (!driver.parseCommandLine(argc, argv))
+        return 1;
+
+    if (showHelp == true) {
+        OS::print(driver.cmdLine.getHelpText(
+            "slang-port-snapshot - Precompile library port signatures for slang-autos"));
+        return 0;
+    }
+
+    if (showVersion == true) {
+        OS::print(fmt::format("slang-port-snapshot version 0.1.0 (slang {}.{}.{}+{})\n",
+                              VersionInfo::getMajor(), VersionInfo::getMinor(),
+                              VersionInfo::getPatch(), std::string(VersionInfo::getHash())));
+        return 0;
+    }
+
+    if (!output) {
+        OS::printE("error: no output file specified (use -o <file>)\n");
+        return 1;
+    }
+
+    // Library directories contribute every source file in them
+    for (const auto& dir : libraryDirs) {
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(dir, ec)) {
+            if (entry.is_regular_file() && isValidExtension(entry.path())) {
+                driver.sourceLoader.addFiles(entry.path().string());
+            }
+        }
+        if (ec) {
+            OS::printE(fmt::format("error: cannot read library directory '{}': {}\n",
+                                   dir, ec.message()));
+            return 1;
+        }
+    }
+
+    if (!driver.processOptions())
+        return 2;
+
+    if (!driver.parseAllSources())
+        return 3;
+
+    // Every module defined in the sources becomes a top, so each is
+    // elaborated once with its default parameters
+    std::set<std::string> modules;
+    for (const auto& tree : driver.syntaxTrees) {
+        auto& root = tree->root();
+        if (root.kind == syntax::SyntaxKind::CompilationUnit) {
+            for (auto* member : root.as<syntax::CompilationUnitSyntax>().members) {
+                if (member->kind == syntax::SyntaxKind::ModuleDeclaration) {
+                    modules.emplace(member->as<syntax::ModuleDeclarationSyntax>().header->name.valueText());
+                }
+            }
+        } else if (root.kind == syntax::SyntaxKind::ModuleDeclaration) {
+            modules.emplace(root.as<syntax::ModuleDeclarationSyntax>().header->name.valueText());
+        }
+    }
+
+    if (modules.empty()) {
+        OS::printE("error: no modules found in the input files\n");
+        return 1;
+    }
+
+    driver.options.topModules.clear();
+    for (const auto& name : modules) {
+        driver.options.topModules.push_back(name);
+    }
+    driver.options.compilationFlags[ast::CompilationFlags::IgnoreUnknownModules] = true;
+
+    auto compilation = driver.createCompilation();
+
+    DiagnosticCollector diagnostics;
+    auto signatures = topModuleSignatures(*compilation, &diagnostics);
+
+    if (verbose == true) {
+        for (const auto& signature : signatures) {
+            OS::print(fmt::format("{}: {} port(s), {} parameter(s){}\n", signature.name,
+                                  signature.ports.size(), signature.parameters.size(),
+                                  signature.parameterized_ports ? " (parameterized ports)" : ""));
+        }
+    }
+
+    auto written = PortSnapshot::write(*output, std::move(signatures), &diagnostics);
+
+    if (diagnostics.hasErrors() || diagnostics.warningCount() > 0) {
+        OS::printE(diagnostics.format());
+    }
+    if (!written) {
+        return 1;
+    }
+
+    OS::print(fmt::format("Wrote {} module(s) to {}\n", *written, *output));
+    return diagnostics.hasErrors() ? 1 : 0;
+}
@@ -0,0 +1,9 @@
+module top;
+    /* fifo AUTO_TEMPLATE
+       din  => data_@_in,
+       dout => data_@_out,
+    */
+    fifo u_fifo_0 (/*AUTOINST*/),
+         u_fifo_1 (/*AUTOINST*/),
+         u_fifo_2 (.clk(clk), .rst_n(rst_n), .din(tap_in), .dout(tap_out), .empty(), .full());
+endmodule
@@ -0,0 +1,109 @@
+// Several modules with AUTOs in one file, for parallel module analysis.
+// Each wrapper also instantiates a missing cell so analysis emits warnings.
+
+module leaf_src (
+    input  logic       clk,
+    input  logic       rst_n,
+    output logic [7:0] data,
+    output logic       valid
+);
+endmodule
+
+module leaf_dst (
+    input  logic       clk,
+    input  logic       rst_n,
+    input  logic [7:0] data,
+    input  logic       valid,
+    output logic       ready
+);
+endmodule
+
+module wrap0 (
+    input logic clk
+    /*AUTOPORTS*/
+);
+
+    /*AUTOLOGIC*/
+
+    leaf_src u_src (/*AUTOINST*/);
+
+    leaf_dst u_dst (/*AUTOINST*/);
+
+    missing_cell0 u_missing (/*AUTOINST*/);
+
+endmodule
+
+module wrap1 (
+    input logic clk
+    /*AUTOPORTS*/
+);
+
+    /*AUTOLOGIC*/
+
+    leaf_src u_src (/*AUTOINST*/);
+
+    leaf_dst u_dst (/*AUTOINST*/);
+
+    missing_cell1 u_missing (/*AUTOINST*/);
+
+endmodule
+
+module wrap2 (
+    input logic clk
+    /*AUTOPORTS*/
+);
+
+    /*AUTOLOGIC*/
+
+    leaf_src u_src (/*AUTOINST*/);
+
+    leaf_dst u_dst (/*AUTOINST*/);
+
+    missing_cell2 u_missing (/*AUTOINST*/);
+
+endmodule
+
+module wrap3 (
+    input logic clk
+    /*AUTOPORTS*/
+);
+
+    /*AUTOLOGIC*/
+
+    leaf_src u_src (/*AUTOINST*/);
+
+    leaf_dst u_dst (/*AUTOINST*/);
+
+    missing_cell3 u_missing (/*AUTOINST*/);
+
+endmodule
+
+module wrap4 (
+    input logic clk
+    /*AUTOPORTS*/
+);
+
+    /*AUTOLOGIC*/
+
+    leaf_src u_src (/*AUTOINST*/);
+
+    leaf_dst u_dst (/*AUTOINST*/);
+
+    missing_cell4 u_missing (/*AUTOINST*/);
+
+endmodule
+
+module wrap5 (
+    input logic clk
+    /*AUTOPORTS*/
+);
+
+    /*AUTOLOGIC*/
+
+    leaf_src u_src (/*AUTOINST*/);
+
+    leaf_dst u_dst (/*AUTOINST*/);
+
+    missing_cell5 u_missing (/*AUTOINST*/);
+
+endmodule
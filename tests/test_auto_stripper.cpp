@@ -0,0 +1,186 @@
+// Tests for AutoStripper - removal of AUTO-generated text
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "slang-autos/AutoStripper.h"
+#include "slang-autos/Tool.h"
+
+#include "slang/syntax/SyntaxTree.h"
+
+namespace fs = std::filesystem;
+using namespace slang_autos;
+
+// Helper to get path to test fixtures
+static fs::path getFixturePath(const std::string& relative) {
+    fs::path candidates[] = {
+        fs::path(__FILE__).parent_path() / "fixtures" / relative,
+        fs::current_path() / "tests" / "fixtures" / relative,
+        fs::current_path() / "fixtures" / relative,
+    };
+
+    for (const auto& path : candidates) {
+        if (fs::exists(path)) {
+            return path;
+        }
+    }
+    return candidates[0];
+}
+
+static std::string readFile(const fs::path& path) {
+    std::ifstream ifs(path);
+    std::stringstream buffer;
+    buffer << ifs.rdbuf();
+    return buffer.str();
+}
+
+TEST_CASE("AutoStripper - AUTOINST", "[stripper]") {
+    SECTION("Strips generated connections, keeps marker and manual ports") {
+        std::string source =
+            "module top;\n"
+            "    sub u_sub (\n"
+            "        .clk (clk),\n"
+            "        /*AUTOINST*/\n"
+            "        .data_in  (data_in),\n"
+            "        .data_out (data_out)\n"
+            "    );\n"
+            "endmodule\n";
+
+        std::string expected =
+            "module top;\n"
+            "    sub u_sub (\n"
+            "        .clk (clk),\n"
+            "        /*AUTOINST*/);\n"
+            "endmodule\n";
+
+        CHECK(stripAutos(source) == expected);
+    }
+
+    SECTION("Nested parens in connections do not end the list early") {
+        std::string source =
+            "module top;\n"
+            "    sub u_sub (/*AUTOINST*/\n"
+            "        .data ({a, (b & c)}),\n"
+            "        .sel  (f(x))\n"
+            "    );\n"
+            "endmodule\n";
+
+        CHECK(stripAutos(source) ==
+              "module top;\n"
+              "    sub u_sub (/*AUTOINST*/);\n"
+              "endmodule\n");
+    }
+
+    SECTION("Unexpanded marker produces no replacements") {
+        std::string source = "module top;\n    sub u_sub (/*AUTOINST*/);\nendmodule\n";
+        auto tree = slang::syntax::SyntaxTree::fromText(source);
+
+        AutoStripper stripper;
+        stripper.analyze(tree, source);
+
+        CHECK(stripper.getReplacements().empty());
+        CHECK(stripAutos(source) == source);
+    }
+
+    SECTION("Marker in a string literal is ignored") {
+        std::string source =
+            "module top;\n"
+            "    initial $display(\"/*AUTOINST*/ (x)\");\n"
+            "endmodule\n";
+
+        CHECK(stripAutos(source) == source);
+    }
+}
+
+TEST_CASE("AutoStripper - AUTOPORTS", "[stripper]") {
+    std::string source =
+        "module top (\n"
+        "    input logic clk,\n"
+        "    /*AUTOPORTS*/\n"
+        "    input  logic [7:0] data_in,\n"
+        "    output logic [7:0] data_out\n"
+        ");\n"
+        "endmodule\n";
+
+    CHECK(stripAutos(source) ==
+          "module top (\n"
+          "    input logic clk,\n"
+          "    /*AUTOPORTS*/);\n"
+          "endmodule\n");
+}
+
+TEST_CASE("AutoStripper - AUTOLOGIC", "[stripper]") {
+    SECTION("Block directly after marker is removed with its separator") {
+        std::string source =
+            "module top;\n"
+            "    /*AUTOLOGIC*/\n"
+            "    // Beginning of automatic logic\n"
+            "    logic [7:0] data;\n"
+            "    // End of automatics\n"
+            "\n"
+            "    assign x = data;\n"
+            "endmodule\n";
+
+        CHECK(stripAutos(source) ==
+              "module top;\n"
+              "    /*AUTOLOGIC*/\n"
+              "\n"
+              "    assign x = data;\n"
+              "endmodule\n");
+    }
+
+    SECTION("Block away from marker is removed on its own") {
+        std::string source =
+            "module top;\n"
+            "    /*AUTOLOGIC*/\n"
+            "    logic user;\n"
+            "    // Beginning of automatic logic\n"
+            "    logic [7:0] data;\n"
+            "    // End of automatics\n"
+            "endmodule\n";
+
+        CHECK(stripAutos(source) ==
+              "module top;\n"
+              "    /*AUTOLOGIC*/\n"
+              "    logic user;\n"
+              "    \n"
+              "endmodule\n");
+    }
+
+    SECTION("Unterminated block is left alone with a warning") {
+        std::string source =
+            "module top;\n"
+            "    // Beginning of automatic logic\n"
+            "    logic [7:0] data;\n"
+            "endmodule\n";
+        auto tree = slang::syntax::SyntaxTree::fromText(source);
+
+        AutoStripper stripper;
+        stripper.analyze(tree, source);
+
+        CHECK(stripper.getReplacements().empty());
+        CHECK(stripper.diagnostics().warningCount() == 1);
+    }
+}
+
+TEST_CASE("AutoStripper - strip restores unexpanded source", "[stripper][integration]") {
+    auto check_round_trip = [](const std::string& fixture) {
+        auto top_sv = getFixturePath(fixture + "/top.sv");
+        auto lib_dir = getFixturePath(fixture + "/lib");
+        REQUIRE(fs::exists(top_sv));
+
+        AutosTool tool;
+        REQUIRE(tool.loadWithArgs({top_sv.string(), "-y", lib_dir.string(), "+libext+.sv"}));
+
+        auto result = tool.expandFile(top_sv, /*dry_run=*/true);
+        REQUIRE(result.success);
+        REQUIRE(result.hasChanges());
+
+        CHECK(stripAutos(result.modified_content) == readFile(top_sv));
+    };
+
+    SECTION("AUTOINST") { check_round_trip("simple"); }
+    SECTION("AUTOLOGIC") { check_round_trip("autologic"); }
+}
@@ -0,0 +1,172 @@
+// Unit tests for the daemon protocol, input stamps and socket round trip
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include "slang-autos/Daemon.h"
+
+using namespace slang_autos;
+namespace fs = std::filesystem;
+
+static void writeText(const fs::path& path, const std::string& text) {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << text;
+}
+
+/// Fresh scratch directory per test
+static fs::path scratchDir(const std::string& name) {
+    auto dir = fs::temp_directory_path() / ("slang_autos_daemon_" + name);
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    return dir;
+}
+
+TEST_CASE("Daemon - request encoding round trip", "[daemon]") {
+    DaemonRequest request;
+    request.cwd = "/work/design";
+    request.args = {"slang-autos", "--check", "top.sv", "-y", "lib", std::string("a\0b", 3)};
+
+    auto decoded = decodeDaemonRequest(encodeDaemonRequest(request));
+    REQUIRE(decoded);
+    CHECK_FALSE(decoded->stop);
+    CHECK(decoded->cwd == request.cwd);
+    CHECK(decoded->args == request.args);
+
+    DaemonRequest stop;
+    stop.stop = true;
+    auto decoded_stop = decodeDaemonRequest(encodeDaemonRequest(stop));
+    REQUIRE(decoded_stop);
+    CHECK(decoded_stop->stop);
+    CHECK(decoded_stop->args.empty());
+}
+
+TEST_CASE("Daemon - malformed requests are rejected", "[daemon]") {
+    DaemonRequest request;
+    request.cwd = "/work";
+    request.args = {"slang-autos", "top.sv"};
+    std::string body = encodeDaemonRequest(request);
+
+    CHECK_FALSE(decodeDaemonRequest(""));
+    CHECK_FALSE(decodeDaemonRequest("X"));
+    CHECK_FALSE(decodeDaemonRequest(std::string_view(body).substr(0, body.size() - 1)));
+    CHECK_FALSE(decodeDaemonRequest(body + "extra"));
+}
+
+TEST_CASE("FileStamps - detects edits, additions and removals", "[daemon]") {
+    auto dir = scratchDir("stamps");
+    auto file = dir / "a.sv";
+    writeText(file, "module a; endmodule\n");
+
+    FileStamps stamps;
+    stamps.add(file);
+    stamps.add(dir);
+    stamps.add(file);  // Duplicates are ignored
+    CHECK(stamps.size() == 2);
+    CHECK_FALSE(stamps.changed());
+
+    SECTION("touch without a content change is not a change") {
+        fs::last_write_time(file, fs::last_write_time(file) + std::chrono::seconds(5));
+        CHECK_FALSE(stamps.changed());
+        CHECK_FALSE(stamps.changed());
+    }
+
+    SECTION("same-size edit is a change") {
+        writeText(file, "module b; endmodule\n");
+        fs::last_write_time(file, fs::last_write_time(file) + std::chrono::seconds(5));
+        CHECK(stamps.changed());
+    }
+
+    SECTION("size change is a change") {
+        writeText(file, "module a; wire w; endmodule\n");
+        CHECK(stamps.changed());
+    }
+
+    SECTION("removal is a change") {
+        fs::remove(file);
+        CHECK(stamps.changed());
+    }
+
+    SECTION("new file in a recorded directory is a change") {
+        writeText(dir / "b.sv", "module b; endmodule\n");
+        fs::last_write_time(dir, fs::last_write_time(dir) + std::chrono::seconds(5));
+        CHECK(stamps.changed());
+    }
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("Daemon - client requests run in the client's directory", "[daemon]") {
+    auto dir = scratchDir("server");
+    auto socket = dir / "d.sock";
+
+    DaemonServer server;
+    DiagnosticCollector diagnostics;
+    REQUIRE(server.listen(socket, diagnostics));
+
+    // A second daemon on the same socket is refused
+    {
+        DaemonServer second;
+        DiagnosticCollector second_diagnostics;
+        CHECK_FALSE(second.listen(socket, second_diagnostics));
+        CHECK(second_diagnostics.hasErrors());
+    }
+
+    std::vector<DaemonRequest> seen;
+    std::vector<fs::path> seen_cwd;
+    std::thread serving([&] {
+        server.serve([&](const DaemonRequest& request) {
+            seen.push_back(request);
+            seen_cwd.push_back(fs::current_path());
+            return static_cast<int>(request.args.size());
+        });
+    });
+
+    DaemonRequest request;
+    request.cwd = dir.string();
+    request.args = {"slang-autos", "--check", "top.sv"};
+    DiagnosticCollector client_diagnostics;
+    auto code = runDaemonClient(socket, request, client_diagnostics);
+
+    CHECK(stopDaemon(socket));
+    serving.join();
+
+    REQUIRE(code);
+    CHECK(*code == 3);
+    CHECK_FALSE(client_diagnostics.hasErrors());
+    REQUIRE(seen.size() == 1);
+    CHECK(seen[0].args == request.args);
+    CHECK(fs::equivalent(seen_cwd[0], dir));
+
+    // The stopped daemon removed its socket; the client falls back to running locally
+    CHECK_FALSE(fs::exists(socket));
+    CHECK_FALSE(runDaemonClient(socket, request, client_diagnostics));
+    CHECK_FALSE(stopDaemon(socket));
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("Daemon - socket directory must be private", "[daemon]") {
+    // A missing directory is created for the owner only
+    auto dir = scratchDir("private");
+    auto socket = dir / "sub" / "d.sock";
+    {
+        DaemonServer server;
+        DiagnosticCollector diagnostics;
+        REQUIRE(server.listen(socket, diagnostics));
+        auto perms = fs::status(dir / "sub").permissions();
+        CHECK((perms & (fs::perms::group_all | fs::perms::others_all)) == fs::perms::none);
+    }
+
+    // Another user could swap the socket in a world-writable, non-sticky directory
+    fs::permissions(dir / "sub", fs::perms::all);
+    DaemonServer server;
+    DiagnosticCollector diagnostics;
+    CHECK_FALSE(server.listen(socket, diagnostics));
+    CHECK(diagnostics.hasErrors());
+
+    fs::remove_all(dir);
+}
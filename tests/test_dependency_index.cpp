@@ -0,0 +1,66 @@
+// Unit tests for the syntax-only dependency index and port signature store
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+#include "slang-autos/DependencyIndex.h"
+
+using namespace slang_autos;
+namespace fs = std::filesystem;
+
+TEST_CASE("DependencyIndex - parents of changed modules, transitively", "[affected]") {
+    DependencyIndex index;
+    index.addFile("top.sv", R"(
+module top;
+    mid u_mid (/*AUTOINST*/);
+    if (1) begin : g_leaf
+        leaf u_leaf (.clk(clk));
+    end
+endmodule
+)");
+    index.addFile("mid.sv", R"(
+module mid (/*AUTOPORTS*/);
+    core u_core (/*AUTOINST*/);
+endmodule
+)");
+    index.addFile("other.sv", R"(
+module other;
+    unrelated u_x ();
+endmodule
+)");
+
+    CHECK(index.contains("mid.sv"));
+    CHECK_FALSE(index.contains("core.sv"));
+
+    // core → mid (its parent) → top (mid's parent)
+    CHECK(index.affectedBy({"core"}) == std::vector<std::string>{"mid.sv", "top.sv"});
+    // Instances inside generate blocks count
+    CHECK(index.affectedBy({"leaf"}) == std::vector<std::string>{"top.sv"});
+    CHECK(index.affectedBy({"nothing"}).empty());
+
+    // Re-indexing a file replaces its instantiations
+    index.addFile("top.sv", "module top; leaf u_leaf (); endmodule\n");
+    CHECK(index.affectedBy({"core"}) == std::vector<std::string>{"mid.sv"});
+}
+
+TEST_CASE("PortSignatures - save and load round trip", "[affected]") {
+    auto file = fs::temp_directory_path() / "slang_autos_signatures.txt";
+    PortSignatures signatures{{"fifo", 0x0123456789abcdefULL}, {"leaf", 0}};
+
+    REQUIRE(savePortSignatures(file, signatures));
+    auto loaded = loadPortSignatures(file);
+    REQUIRE(loaded);
+    CHECK(*loaded == signatures);
+
+    // Not a signature file
+    {
+        std::ofstream ofs(file);
+        ofs << "fifo 12\n";
+    }
+    CHECK_FALSE(loadPortSignatures(file));
+
+    fs::remove(file);
+    CHECK_FALSE(loadPortSignatures(file));
+}
@@ -0,0 +1,60 @@
+// Unit tests for FileWatcher (directory change notification for --watch)
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#include "slang-autos/FileWatcher.h"
+
+using namespace slang_autos;
+namespace fs = std::filesystem;
+using std::chrono::milliseconds;
+
+static void writeText(const fs::path& path, const std::string& text) {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << text;
+}
+
+TEST_CASE("FileWatcher - reports written, renamed and removed files", "[watch]") {
+    FileWatcher watcher;
+    if (!watcher.valid()) {
+        SKIP("file change notification is not available on this platform");
+    }
+
+    auto dir = fs::temp_directory_path() / "slang_autos_watch";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    writeText(dir / "old.sv", "module old; endmodule\n");
+
+    REQUIRE(watcher.addDirectory(dir));
+    CHECK(watcher.addDirectory(dir));  // Twice is harmless
+    CHECK_FALSE(watcher.addDirectory(dir / "missing"));
+
+    // Nothing happened yet
+    CHECK(watcher.wait(milliseconds(10), milliseconds(50)).empty());
+
+    // One batch for a burst of changes, as absolute paths
+    writeText(dir / "a.sv", "module a; endmodule\n");
+    writeText(dir / "a.sv", "module a(input x); endmodule\n");
+    writeText(dir / "b.sv.tmp", "module b; endmodule\n");
+    fs::rename(dir / "b.sv.tmp", dir / "b.sv");
+    fs::remove(dir / "old.sv");
+
+    auto changed = watcher.wait(milliseconds(50), milliseconds(2000));
+    auto canonical_dir = fs::absolute(dir).lexically_normal();
+    CHECK(changed == std::vector<fs::path>{
+        canonical_dir / "a.sv",
+        canonical_dir / "b.sv",
+        canonical_dir / "b.sv.tmp",
+        canonical_dir / "old.sv",
+    });
+
+    // Subdirectories are not followed
+    fs::create_directories(dir / "sub");
+    writeText(dir / "sub" / "c.sv", "module c; endmodule\n");
+    CHECK(watcher.wait(milliseconds(10), milliseconds(100)).empty());
+
+    fs::remove_all(dir);
+}
@@ -2,11 +2,13 @@
 // These tests exercise the full slang driver flow with real SystemVerilog files
 
 #include <catch2/catch_test_macros.hpp>
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 
+#include "slang-autos/CompilationUtils.h"
 #include "slang-autos/Tool.h"
 
 namespace fs = std::filesystem;
@@ -548,6 +550,378 @@ TEST_CASE("Integration - dry run does not modify content", "[integration]") {
     CHECK(original == after);
 }
 
+// =============================================================================
+// Progress Reporting Tests
+// =============================================================================
+
+TEST_CASE("Integration - streaming expansion writes the same output", "[integration]") {
+    auto top_sv = getFixturePath("simple/top.sv");
+    auto lib_dir = getFixturePath("simple/lib");
+
+    REQUIRE(fs::exists(top_sv));
+
+    auto temp_dir = fs::temp_directory_path() / "slang_autos_stream_test";
+    fs::create_directories(temp_dir);
+    auto copy_sv = temp_dir / "top.sv";
+    fs::copy_file(top_sv, copy_sv, fs::copy_options::overwrite_existing);
+
+    AutosTool tool;
+    REQUIRE(tool.loadWithArgs({
+        copy_sv.string(),
+        "-y", lib_dir.string(),
+        "+libext+.sv"
+    }));
+
+    auto expected = tool.expandFile(copy_sv, /*dry_run=*/true);
+    REQUIRE(expected.success);
+    REQUIRE(expected.hasChanges());
+
+    // Dry run: flags from the replacements, no content strings
+    auto dry = tool.expandFileStreaming(copy_sv, /*dry_run=*/true);
+    REQUIRE(dry.success);
+    CHECK(dry.original_content.empty());
+    CHECK(dry.modified_content.empty());
+    CHECK(dry.originalText() == expected.original_content);
+    CHECK(dry.hasChanges());
+    CHECK(dry.hasNonWhitespaceChanges() == expected.hasNonWhitespaceChanges());
+    CHECK(dry.autoinst_count == expected.autoinst_count);
+
+    auto written = tool.expandFileStreaming(copy_sv);
+    REQUIRE(written.success);
+
+    std::ifstream ifs(copy_sv);
+    std::string on_disk((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    CHECK(on_disk == expected.modified_content);
+
+    fs::remove_all(temp_dir);
+}
+
+TEST_CASE("Integration - check decides staleness without writing", "[integration][check]") {
+    auto top_sv = getFixturePath("simple/top.sv");
+    auto lib_dir = getFixturePath("simple/lib");
+
+    REQUIRE(fs::exists(top_sv));
+
+    auto temp_dir = fs::temp_directory_path() / "slang_autos_check_test";
+    fs::create_directories(temp_dir);
+    auto copy_sv = temp_dir / "top.sv";
+    fs::copy_file(top_sv, copy_sv, fs::copy_options::overwrite_existing);
+    std::string before = readFile(copy_sv);
+
+    AutosTool tool;
+    REQUIRE(tool.loadWithArgs({
+        copy_sv.string(),
+        "-y", lib_dir.string(),
+        "+libext+.sv"
+    }));
+
+    auto stale = tool.checkFile(copy_sv);
+    REQUIRE(stale.success);
+    CHECK(stale.modified_content.empty());
+    CHECK(stale.hasNonWhitespaceChanges());
+    CHECK(readFile(copy_sv) == before);
+
+    // Once expanded, the same file checks clean
+    auto expanded = tool.expandFile(copy_sv);
+    REQUIRE(expanded.success);
+    auto clean = tool.checkFile(copy_sv);
+    REQUIRE(clean.success);
+    CHECK_FALSE(clean.hasChanges());
+    CHECK_FALSE(clean.hasNonWhitespaceChanges());
+
+    fs::remove_all(temp_dir);
+}
+
+TEST_CASE("Integration - progress callback reports each phase", "[integration][progress]") {
+    auto top_sv = getFixturePath("simple/top.sv");
+    auto lib_dir = getFixturePath("simple/lib");
+
+    REQUIRE(fs::exists(top_sv));
+
+    std::vector<ExpansionPhase> phases;
+    std::vector<std::string> modules;
+
+    AutosTool tool;
+    tool.setProgressCallback([&](const ProgressEvent& event) {
+        phases.push_back(event.phase);
+        if (event.phase == ExpansionPhase::Analyze) {
+            modules.emplace_back(event.detail);
+        }
+        return true;
+    });
+    REQUIRE(tool.loadWithArgs({
+        top_sv.string(),
+        "-y", lib_dir.string(),
+        "+libext+.sv"
+    }));
+
+    auto result = tool.expandFile(top_sv, /*dry_run=*/true);
+
+    CHECK(result.success);
+    CHECK_FALSE(result.cancelled);
+    REQUIRE(phases.size() >= 5);
+    CHECK(phases.front() == ExpansionPhase::Parse);
+    CHECK(phases.back() == ExpansionPhase::Generate);
+    CHECK(modules == std::vector<std::string>{"top"});
+}
+
+TEST_CASE("Integration - progress callback can cancel expansion", "[integration][progress]") {
+    auto top_sv = getFixturePath("simple/top.sv");
+    auto lib_dir = getFixturePath("simple/lib");
+
+    REQUIRE(fs::exists(top_sv));
+
+    AutosTool tool;
+    REQUIRE(tool.loadWithArgs({
+        top_sv.string(),
+        "-y", lib_dir.string(),
+        "+libext+.sv"
+    }));
+
+    tool.setProgressCallback([](const ProgressEvent& event) {
+        return event.phase != ExpansionPhase::Analyze;
+    });
+
+    auto result = tool.expandFile(top_sv, /*dry_run=*/true);
+
+    CHECK(result.cancelled);
+    CHECK_FALSE(result.success);
+    CHECK_FALSE(result.hasChanges());
+}
+
+TEST_CASE("Integration - expandContent reuses cached submodule ports", "[integration]") {
+    auto top_sv = getFixturePath("simple/top.sv");
+    auto lib_dir = getFixturePath("simple/lib");
+
+    REQUIRE(fs::exists(top_sv));
+
+    AutosTool tool;
+    REQUIRE(tool.loadWithArgs({
+        top_sv.string(),
+        "-y", lib_dir.string(),
+        "+libext+.sv"
+    }));
+
+    std::ifstream ifs(top_sv);
+    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+    auto first = tool.expandContent(top_sv, content);
+    REQUIRE(first.success);
+    size_t misses = tool.portCache().misses();
+    CHECK(misses > 0);
+
+    // Same buffer again: identical output, no new port lookups
+    auto second = tool.expandContent(top_sv, content);
+    CHECK(second.modified_content == first.modified_content);
+    CHECK(tool.portCache().misses() == misses);
+    CHECK(tool.portCache().hits() > 0);
+
+    // Expanding the expanded buffer is a no-op
+    auto third = tool.expandContent(top_sv, first.modified_content);
+    CHECK_FALSE(third.hasChanges());
+}
+
+TEST_CASE("Integration - reload keeps ports of unchanged files", "[integration]") {
+    auto top_sv = getFixturePath("simple/top.sv");
+    auto lib_dir = getFixturePath("simple/lib");
+    auto submod_sv = lib_dir / "submod.sv";
+
+    REQUIRE(fs::exists(top_sv));
+
+    AutosTool tool;
+    REQUIRE(tool.loadWithArgs({
+        top_sv.string(),
+        "-y", lib_dir.string(),
+        "+libext+.sv"
+    }));
+
+    auto files = tool.sourceFiles();
+    CHECK(std::any_of(files.begin(), files.end(),
+                      [&](const fs::path& f) { return fs::equivalent(f, submod_sv); }));
+
+    std::string content = readFile(top_sv);
+    auto first = tool.expandContent(top_sv, content);
+    REQUIRE(first.success);
+    size_t misses = tool.portCache().misses();
+
+    // submod is declared in the library, so saving top.sv keeps its ports
+    REQUIRE(tool.reload({top_sv}));
+    auto second = tool.expandContent(top_sv, content);
+    CHECK(second.modified_content == first.modified_content);
+    CHECK(tool.portCache().misses() == misses);
+
+    // Saving the library file drops them
+    REQUIRE(tool.reload({submod_sv}));
+    auto third = tool.expandContent(top_sv, content);
+    CHECK(third.modified_content == first.modified_content);
+    CHECK(tool.portCache().misses() > misses);
+}
+
+TEST_CASE("Integration - expansion statistics are collected", "[integration][stats]") {
+    auto top_sv = getFixturePath("templates/top.sv");
+    auto lib_dir = getFixturePath("templates/lib");
+
+    REQUIRE(fs::exists(top_sv));
+
+    AutosTool tool;
+    REQUIRE(tool.loadWithArgs({
+        top_sv.string(),
+        "-y", lib_dir.string(),
+        "+libext+.sv"
+    }));
+
+    auto result = tool.expandFile(top_sv, /*dry_run=*/true);
+    REQUIRE(result.success);
+
+    const auto& stats = result.stats;
+    CHECK(stats.bytes_read == result.original_content.size());
+    CHECK(stats.bytes_written == 0);  // Dry run
+    CHECK(stats.replacements == result.replacements.size());
+    CHECK(stats.port_cache_misses == 1);  // fifo, looked up once
+    CHECK(stats.regex_compilations > 0);
+    CHECK(stats.rule_evaluations > 0);
+    CHECK(stats.peak_rss_bytes > 0);
+
+    // Second run: ports come from the cache
+    auto again = tool.expandFile(top_sv, /*dry_run=*/true);
+    CHECK(again.stats.port_cache_misses == 0);
+    CHECK(again.stats.port_cache_hits > 0);
+}
+
+TEST_CASE("Integration - expansion records instantiated module types", "[integration][watch]") {
+    auto top_sv = getFixturePath("templates/top.sv");
+    auto lib_dir = getFixturePath("templates/lib");
+
+    REQUIRE(fs::exists(top_sv));
+
+    AutosTool tool;
+    REQUIRE(tool.loadWithArgs({
+        top_sv.string(),
+        "-y", lib_dir.string(),
+        "+libext+.sv"
+    }));
+
+    auto result = tool.expandFile(top_sv, /*dry_run=*/true);
+    REQUIRE(result.success);
+    CHECK(result.submodules == std::vector<std::string>{"fifo"});
+
+    // --depfile: where the ports came from
+    REQUIRE(result.port_sources.size() == 1);
+    CHECK(fs::equivalent(result.port_sources[0], lib_dir / "fifo.sv"));
+}
+
+TEST_CASE("moduleInterfaces - only port and parameter edits change the hash", "[integration][watch]") {
+    const std::string original = R"(
+module leaf #(parameter W = 8) (
+    input  logic         clk,
+    output logic [W-1:0] q
+);
+    assign q = '0;
+endmodule
+
+module other;
+endmodule
+)";
+
+    auto base = moduleInterfaces(original);
+    REQUIRE(base.size() == 2);
+    CHECK(base[0].name == "leaf");
+    CHECK(base[1].name == "other");
+    CHECK(base[0].instances.empty());
+
+    SECTION("body, comment and whitespace edits keep the hash") {
+        std::string edited = original;
+        edited.replace(edited.find("assign q = '0;"), 14, "// reset value\n    assign q = '1;");
+        edited.replace(edited.find("input  logic"), 12, "input logic");
+        auto after = moduleInterfaces(edited);
+        REQUIRE(after.size() == 2);
+        CHECK(after[0].hash == base[0].hash);
+    }
+
+    SECTION("a new port changes the hash") {
+        std::string edited = original;
+        edited.replace(edited.find("input  logic         clk,"), 25,
+                       "input  logic         clk,\n    input  logic         rst_n,");
+        auto after = moduleInterfaces(edited);
+        REQUIRE(after.size() == 2);
+        CHECK(after[0].hash != base[0].hash);
+        CHECK(after[1].hash == base[1].hash);
+    }
+
+    SECTION("a parameter default change changes the hash") {
+        std::string edited = original;
+        edited.replace(edited.find("W = 8"), 5, "W = 16");
+        auto after = moduleInterfaces(edited);
+        REQUIRE(after.size() == 2);
+        CHECK(after[0].hash != base[0].hash);
+    }
+}
+
+TEST_CASE("Integration - parallel module analysis matches sequential output", "[integration][parallel]") {
+    auto top_sv = getFixturePath("multi_module/all_in_one.sv");
+
+    REQUIRE(fs::exists(top_sv));
+
+    auto run = [&](unsigned jobs, std::string& diagnostics) {
+        AutosTool::Options opts;
+        opts.module_jobs = jobs;
+        AutosTool tool(opts);
+        REQUIRE(tool.loadWithArgs({top_sv.string()}));
+        auto result = tool.expandFile(top_sv, /*dry_run=*/true);
+        diagnostics = tool.diagnostics().format();
+        return result;
+    };
+
+    std::string seq_diags;
+    std::string par_diags;
+    auto sequential = run(1, seq_diags);
+    auto parallel = run(4, par_diags);
+
+    REQUIRE(sequential.success);
+    REQUIRE(parallel.success);
+    CHECK(sequential.autoinst_count > 0);
+    CHECK(parallel.modified_content == sequential.modified_content);
+    CHECK(parallel.autoinst_count == sequential.autoinst_count);
+    CHECK(parallel.autologic_count == sequential.autologic_count);
+    CHECK(parallel.autoports_count == sequential.autoports_count);
+
+    // Missing-cell warnings come out in module order regardless of scheduling
+    CHECK_FALSE(seq_diags.empty());
+    CHECK(par_diags == seq_diags);
+    CHECK(seq_diags.find("missing_cell0") < seq_diags.find("missing_cell5"));
+}
+
+TEST_CASE("Integration - module filter skips analysis", "[integration]") {
+    auto top_sv = getFixturePath("simple/top.sv");
+    auto lib_dir = getFixturePath("simple/lib");
+
+    REQUIRE(fs::exists(top_sv));
+
+    AutosTool tool;
+    REQUIRE(tool.loadWithArgs({
+        top_sv.string(),
+        "-y", lib_dir.string(),
+        "+libext+.sv"
+    }));
+
+    std::ifstream ifs(top_sv);
+    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+    std::vector<std::string> seen;
+    auto result = tool.expandContent(top_sv, content, [&](const ModuleSpan& span) {
+        seen.emplace_back(span.name);
+        CHECK(span.start < span.end);
+        CHECK(span.end <= content.size());
+        CHECK(content.compare(span.start, 6, "module") == 0);
+        return false;
+    });
+
+    CHECK(result.success);
+    CHECK(seen == std::vector<std::string>{"top"});
+    CHECK(result.replacements.empty());
+    CHECK_FALSE(result.hasChanges());
+}
+
 // =============================================================================
 // Multiple Instance Tests
 // =============================================================================
@@ -597,6 +971,45 @@ TEST_CASE("Integration - multiple instances of same module", "[integration]") {
     fs::remove_all(temp_dir);
 }
 
+// =============================================================================
+// Instance lists (`sub u_a (...), u_b (...);`)
+// =============================================================================
+
+TEST_CASE("Instance list - every AUTOINST in the list is expanded", "[integration][autoinst][templates]") {
+    auto top_sv = getFixturePath("instance_list/top.sv");
+    auto lib_dir = getFixturePath("instance_list/lib");
+
+    REQUIRE(fs::exists(top_sv));
+
+    AutosTool tool;
+    REQUIRE(tool.loadWithArgs({top_sv.string(), "-y", lib_dir.string(), "+libext+.sv"}));
+
+    auto result = tool.expandFile(top_sv, /*dry_run=*/true);
+    REQUIRE(result.success);
+    CHECK(result.autoinst_count == 2);
+
+    const auto& out = result.modified_content;
+
+    // Template is shared; instance captures differ per instance
+    auto inst1 = out.find("u_fifo_1");
+    auto inst2 = out.find("u_fifo_2");
+    REQUIRE(inst1 != std::string::npos);
+    REQUIRE(inst2 != std::string::npos);
+    auto data0 = out.find("(data_0_in)");
+    auto data1 = out.find("(data_1_in)");
+    CHECK(data0 < inst1);
+    CHECK(data1 > inst1);
+    CHECK(data1 < inst2);
+    CHECK(out.find("(data_1_out)") != std::string::npos);
+
+    // Manual instance in the same list is left alone
+    CHECK(out.find(".din(tap_in), .dout(tap_out)") != std::string::npos);
+
+    // Re-expanding is a no-op
+    auto again = tool.expandContent(top_sv, out);
+    CHECK_FALSE(again.hasChanges());
+}
+
 // =============================================================================
 // CLI Behavior Tests (run actual binary)
 // =============================================================================
@@ -2954,6 +3367,26 @@ TEST_CASE("Integration - AUTOINST preserves manual connections + skips already-c
     CHECK(result.modified_content.find(".data_in  (data_in)") != std::string::npos);
 }
 
+TEST_CASE("Integration - per-module collection state uses the arena", "[integration][arena]") {
+    // Manual ports and declaration names are collected into the analyzer's
+    // per-module arena; a small design should fit in the initial buffer.
+    auto top_sv = getFixturePath("width_adaptation/top_zero_pad.sv");
+    auto lib_dir = getFixturePath("width_adaptation/lib");
+
+    REQUIRE(fs::exists(top_sv));
+
+    AutosTool tool;
+    REQUIRE(tool.loadWithArgs({top_sv.string(), "-y", lib_dir.string(), "+libext+.sv"}));
+
+    auto result = tool.expandFile(top_sv, /*dry_run=*/true);
+    CHECK(result.success);
+
+    CHECK(result.arena_stats.modules >= 1);
+    CHECK(result.arena_stats.allocations > 0);
+    CHECK(result.arena_stats.bytes >= result.arena_stats.peak_module_bytes);
+    CHECK(result.arena_stats.heap_allocations == 0);
+}
+
 // =============================================================================
 // Error recovery on malformed input
 // =============================================================================
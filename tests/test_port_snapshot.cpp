@@ -0,0 +1,166 @@
+// Unit tests for port lookup: precompiled snapshots (--port-snapshot) and ModulePorts
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+#include "slang/ast/Compilation.h"
+#include "slang/syntax/SyntaxTree.h"
+
+#include "slang-autos/PortSnapshot.h"
+
+using namespace slang_autos;
+namespace fs = std::filesystem;
+
+namespace {
+
+ModuleSignature makeSignature(const std::string& name, int width) {
+    ModuleSignature signature;
+    signature.name = name;
+    signature.parameters.push_back({"WIDTH", std::to_string(width)});
+
+    PortInfo clk("clk", PortDirection::Input, 1);
+    PortInfo data("data", PortDirection::Output, width);
+    data.range_str = "[" + std::to_string(width - 1) + ":0]";
+    data.original_range_str = "[WIDTH-1:0]";
+    PortInfo mem("mem", PortDirection::Inout, 8);
+    mem.range_str = "[7:0]";
+    mem.is_array = true;
+    mem.array_dims = "[3:0]";
+    signature.ports = {clk, data, mem};
+    return signature;
+}
+
+} // anonymous namespace
+
+TEST_CASE("PortSnapshot - write and look up", "[port_snapshot]") {
+    auto file = fs::temp_directory_path() / "slang_autos_snapshot.bin";
+    std::vector<ModuleSignature> modules{makeSignature("zeta", 16), makeSignature("alpha", 8),
+                                         makeSignature("mid", 4)};
+    modules[2].parameterized_ports = true;
+    modules.push_back(makeSignature("alpha", 32));  // Duplicate: the first is kept
+    auto written = PortSnapshot::write(file, modules);
+    REQUIRE(written);
+    CHECK(*written == 3);
+
+    DiagnosticCollector diagnostics;
+    auto snapshot = PortSnapshot::open(file, &diagnostics);
+    REQUIRE(snapshot);
+    CHECK_FALSE(diagnostics.hasErrors());
+    CHECK(snapshot->size() == 3);
+    CHECK(snapshot->moduleNames() == std::vector<std::string>{"alpha", "mid", "zeta"});
+
+    auto alpha = snapshot->find("alpha");
+    REQUIRE(alpha);
+    CHECK(alpha->name == "alpha");
+    REQUIRE(alpha->parameters.size() == 1);
+    CHECK(alpha->parameters[0].name == "WIDTH");
+    CHECK(alpha->parameters[0].default_value == "8");
+    CHECK_FALSE(alpha->parameterized_ports);
+    REQUIRE(alpha->ports.size() == 3);
+    CHECK(alpha->ports[0].name == "clk");
+    CHECK(alpha->ports[0].direction == PortDirection::Input);
+    CHECK(alpha->ports[1].range_str == "[7:0]");
+    CHECK(alpha->ports[1].original_range_str == "[WIDTH-1:0]");
+    CHECK(alpha->ports[1].width == 8);
+    CHECK(alpha->ports[2].direction == PortDirection::Inout);
+    CHECK(alpha->ports[2].is_array);
+    CHECK(alpha->ports[2].array_dims == "[3:0]");
+
+    CHECK(snapshot->find("mid")->parameterized_ports);
+    CHECK(snapshot->find("zeta")->ports[1].width == 16);
+    CHECK_FALSE(snapshot->find("missing"));
+    CHECK_FALSE(snapshot->find(""));
+
+    fs::remove(file);
+}
+
+TEST_CASE("PortSnapshot - rejects missing and malformed files", "[port_snapshot]") {
+    DiagnosticCollector diagnostics;
+    CHECK_FALSE(PortSnapshot::open("/nonexistent/snapshot.bin", &diagnostics));
+    CHECK(diagnostics.hasErrors());
+
+    auto file = fs::temp_directory_path() / "slang_autos_snapshot_bad.bin";
+    {
+        std::ofstream ofs(file, std::ios::binary);
+        ofs << "module top; endmodule\n";
+    }
+    CHECK_FALSE(PortSnapshot::open(file));
+
+    // A valid snapshot cut short: the index no longer fits
+    REQUIRE(PortSnapshot::write(file, {makeSignature("a", 2), makeSignature("b", 2)}));
+    fs::resize_file(file, 20);
+    CHECK_FALSE(PortSnapshot::open(file));
+
+    // Index intact but records truncated: lookups fail instead of reading past the end
+    REQUIRE(PortSnapshot::write(file, {makeSignature("a", 2)}));
+    fs::resize_file(file, fs::file_size(file) - 4);
+    auto snapshot = PortSnapshot::open(file);
+    REQUIRE(snapshot);
+    CHECK_FALSE(snapshot->find("a"));
+
+    fs::remove(file);
+}
+
+TEST_CASE("ModulePorts - precomputed orders per grouping mode", "[port_cache]") {
+    ModulePorts mp({
+        PortInfo("rst_n", PortDirection::Input),
+        PortInfo("dout", PortDirection::Output, 8),
+        PortInfo("clk", PortDirection::Input),
+        PortInfo("bus", PortDirection::Inout),
+        PortInfo("arb", PortDirection::Output),
+    });
+
+    CHECK(mp.alphabetical == std::vector<uint32_t>{4, 3, 2, 1, 0});  // arb bus clk dout rst_n
+    CHECK(mp.by_direction == std::vector<uint32_t>{1, 4, 3, 0, 2});  // outputs, inouts, inputs
+}
+
+TEST_CASE("PortSnapshot - signatures from a compilation", "[port_snapshot]") {
+    auto tree = slang::syntax::SyntaxTree::fromText(R"(
+module fixed #(parameter int DEPTH = 4) (input logic clk, output logic [7:0] q);
+endmodule
+module sized #(parameter int WIDTH = 8) (input logic [WIDTH-1:0] d);
+endmodule
+)");
+    slang::ast::Compilation compilation;
+    compilation.addSyntaxTree(tree);
+
+    auto signatures = topModuleSignatures(compilation);
+    REQUIRE(signatures.size() == 2);
+
+    const auto& fixed = signatures[0].name == "fixed" ? signatures[0] : signatures[1];
+    const auto& sized = signatures[0].name == "fixed" ? signatures[1] : signatures[0];
+    REQUIRE(fixed.parameters.size() == 1);
+    CHECK(fixed.parameters[0].default_value == "4");
+    CHECK(fixed.ports.size() == 2);
+    CHECK_FALSE(fixed.parameterized_ports);
+    CHECK(sized.parameterized_ports);
+
+    // A cache with the snapshot answers without the module in its compilation
+    auto file = fs::temp_directory_path() / "slang_autos_snapshot_lib.bin";
+    REQUIRE(PortSnapshot::write(file, signatures));
+
+    slang::ast::Compilation empty;
+    PortCache cache;
+    cache.addSnapshot(PortSnapshot::open(file));
+    const auto& ports = cache.lookup(empty, "fixed");
+    REQUIRE(ports.ports.size() == 2);
+    CHECK(ports.ports[1].range_str == "[7:0]");
+    CHECK(ports.source_file == file.string());
+
+    // Parameterized ports are served when only their original syntax is used
+    const auto& original = cache.lookup(empty, "sized");
+    REQUIRE(original.ports.size() == 1);
+    CHECK(original.ports[0].original_range_str == "[WIDTH-1:0]");
+    CHECK(original.default_parameters);
+
+    // Resolved ranges need the compilation (absent here), and say so
+    DiagnosticCollector diagnostics;
+    CHECK(cache.lookup(empty, "sized", &diagnostics, StrictnessMode::Lenient,
+                       /*resolved_ranges=*/true).ports.empty());
+    REQUIRE(diagnostics.warningCount() == 1);
+    CHECK(diagnostics.diagnostics()[0].message.find("parameter-dependent") != std::string::npos);
+
+    fs::remove(file);
+}
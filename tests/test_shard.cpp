@@ -0,0 +1,188 @@
+// Unit tests for --shard partitioning and --merge-shards
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+#include "slang-autos/Shard.h"
+
+using namespace slang_autos;
+namespace fs = std::filesystem;
+
+TEST_CASE("Shard - spec parsing", "[shard]") {
+    auto spec = parseShardSpec("2/5");
+    REQUIRE(spec);
+    CHECK(spec->index == 2);
+    CHECK(spec->count == 5);
+
+    CHECK(parseShardSpec("1/1"));
+    CHECK_FALSE(parseShardSpec("0/4"));
+    CHECK_FALSE(parseShardSpec("5/4"));
+    CHECK_FALSE(parseShardSpec("1/0"));
+    CHECK(parseShardSpec("65536/65536"));
+    CHECK_FALSE(parseShardSpec("1/65537"));
+    CHECK_FALSE(parseShardSpec("a/2"));
+    CHECK_FALSE(parseShardSpec("1/2x"));
+    CHECK_FALSE(parseShardSpec("12"));
+    CHECK_FALSE(parseShardSpec(""));
+}
+
+TEST_CASE("Shard - partition is complete, disjoint and balanced", "[shard]") {
+    std::vector<uint64_t> costs{10, 1, 7, 3, 3, 8};
+
+    // Largest first onto the lightest shard: {10, 1}, {8, 3}, {7, 3}
+    CHECK(selectShard(costs, {1, 3}) == std::vector<size_t>{0, 1});
+    CHECK(selectShard(costs, {2, 3}) == std::vector<size_t>{4, 5});
+    CHECK(selectShard(costs, {3, 3}) == std::vector<size_t>{2, 3});
+
+    std::vector<size_t> all;
+    for (uint32_t k = 1; k <= 4; ++k) {
+        auto shard = selectShard(costs, {k, 4});
+        all.insert(all.end(), shard.begin(), shard.end());
+    }
+    std::sort(all.begin(), all.end());
+    CHECK(all == std::vector<size_t>{0, 1, 2, 3, 4, 5});
+
+    // More shards than files leaves some empty
+    CHECK(selectShard({5}, {2, 2}).empty());
+    CHECK(selectShard({5}, {1, 2}) == std::vector<size_t>{0});
+
+    // Files without a measured cost are spread by count, not piled on shard 1
+    std::vector<uint64_t> zeros(6, 0);
+    CHECK(selectShard(zeros, {1, 3}) == std::vector<size_t>{0, 3});
+    CHECK(selectShard(zeros, {2, 3}) == std::vector<size_t>{1, 4});
+    CHECK(selectShard(zeros, {3, 3}) == std::vector<size_t>{2, 5});
+}
+
+TEST_CASE("Shard - cost estimate counts instances", "[shard]") {
+    std::string one = "module top; sub u (/*AUTOINST*/); endmodule\n";
+    std::string two = "module top; sub u (/*AUTOINST*/); sub v (/*AUTOINST*/); endmodule\n";
+    CHECK(estimateExpansionCost("") == 0);
+    CHECK(estimateExpansionCost(two) - estimateExpansionCost(one) > two.size() - one.size());
+}
+
+TEST_CASE("Shard - costs from previous --stats=json output", "[shard]") {
+    auto file = fs::temp_directory_path() / "slang_autos_shard_stats.json";
+    {
+        std::ofstream ofs(file);
+        ofs << "{\"files\":[\n"
+               "{\"path\":\"a.sv\",\"success\":true,\"changed\":false,\"autoinst\":1,"
+               "\"autologic\":0,\"autoports\":0,\"stats\":{\"parse_us\":5,\"elaborate_us\":10,"
+               "\"analyze_us\":1,\"write_us\":0,\"peak_rss_bytes\":123}}\n"
+               "],\"total\":{\"files\":1,\"stats\":{}}}\n";
+    }
+    auto costs = loadStatsCosts(file);
+    REQUIRE(costs);
+    CHECK(costs->at("a.sv") == 16);
+
+    {
+        std::ofstream ofs(file);
+        ofs << "not json";
+    }
+    CHECK_FALSE(loadStatsCosts(file));
+    fs::remove(file);
+    CHECK_FALSE(loadStatsCosts(file));
+}
+
+TEST_CASE("Shard - results round trip and merge", "[shard]") {
+    ShardResult second;
+    second.shard = 2;
+    second.shards = 2;
+    second.exit_code = 1;
+    second.files = 3;
+    second.files_changed = 1;
+    second.autoinst = 4;
+    second.changed = {"rtl/\"quoted\".sv"};
+
+    auto parsed = parseShardResult(toJson(second));
+    REQUIRE(parsed);
+    CHECK(parsed->shard == 2);
+    CHECK(parsed->exit_code == 1);
+    CHECK(parsed->autoinst == 4);
+    CHECK_FALSE(parsed->partial);
+    CHECK(parsed->changed == second.changed);
+    CHECK_FALSE(parseShardResult("{\"shard\":1}"));
+    CHECK_FALSE(parseShardResult("{"));
+
+    ShardResult first = second;
+    first.shard = 1;
+    first.exit_code = 0;
+    first.changed = {"rtl/a.sv"};
+
+    SECTION("all shards present") {
+        DiagnosticCollector diagnostics;
+        auto merged = mergeShardResults({second, first}, diagnostics);
+        CHECK_FALSE(diagnostics.hasErrors());
+        CHECK(merged.exit_code == 1);
+        CHECK(merged.files == 6);
+        CHECK(merged.autoinst == 8);
+        CHECK(merged.changed == std::vector<std::string>{"rtl/\"quoted\".sv", "rtl/a.sv"});
+        CHECK_FALSE(merged.partial);
+    }
+
+    SECTION("partial counts from --check stay marked") {
+        first.partial = true;
+        auto reparsed = parseShardResult(toJson(first));
+        REQUIRE(reparsed);
+        CHECK(reparsed->partial);
+
+        DiagnosticCollector diagnostics;
+        auto merged = mergeShardResults({second, *reparsed}, diagnostics);
+        CHECK_FALSE(diagnostics.hasErrors());
+        CHECK(merged.partial);
+    }
+
+    SECTION("a missing shard fails the run") {
+        first.exit_code = 0;
+        DiagnosticCollector diagnostics;
+        auto merged = mergeShardResults({first}, diagnostics);
+        CHECK(diagnostics.hasErrors());
+        CHECK(merged.exit_code == 1);
+    }
+
+    SECTION("a duplicated shard fails the run") {
+        DiagnosticCollector diagnostics;
+        (void)mergeShardResults({first, first, second}, diagnostics);
+        CHECK(diagnostics.hasErrors());
+    }
+
+    SECTION("nothing to merge fails the run") {
+        DiagnosticCollector diagnostics;
+        CHECK(mergeShardResults({}, diagnostics).exit_code == 1);
+        CHECK(diagnostics.hasErrors());
+    }
+
+    SECTION("shard counts must agree and stay in range") {
+        ShardResult other = first;
+        other.shards = 3;
+        DiagnosticCollector mismatched;
+        CHECK(mergeShardResults({first, other, second}, mismatched).exit_code == 1);
+        CHECK(mismatched.hasErrors());
+
+        ShardResult huge = first;
+        huge.shards = 4000000000u;
+        DiagnosticCollector diagnostics;
+        auto merged = mergeShardResults({huge, second}, diagnostics);
+        CHECK(diagnostics.hasErrors());
+        CHECK(merged.exit_code == 1);
+    }
+}
+
+TEST_CASE("Shard - results with out-of-range fields are rejected", "[shard]") {
+    auto result = [](std::string_view shard, std::string_view shards, std::string_view autoinst) {
+        return "{\"shard\":" + std::string(shard) + ",\"shards\":" + std::string(shards) +
+               ",\"exit_code\":0,\"files\":1,\"files_changed\":0,\"autoinst\":" +
+               std::string(autoinst) + ",\"autologic\":0,\"autoports\":0,\"changed\":[]}";
+    };
+
+    CHECK(parseShardResult(result("1", "2", "3")));
+    CHECK_FALSE(parseShardResult(result("1", "2", "1.5")));         // Not an integer
+    CHECK_FALSE(parseShardResult(result("1", "2", "-1")));          // Negative
+    CHECK_FALSE(parseShardResult(result("1", "2", "2147483648")));  // Exceeds int
+    CHECK_FALSE(parseShardResult(result("1", "2", "1e400")));       // Not finite
+    CHECK_FALSE(parseShardResult(result("1", "4294967296", "0")));  // Exceeds uint32_t
+    CHECK_FALSE(parseShardResult(result("1", "65537", "0")));       // Too many shards
+    CHECK_FALSE(parseShardResult(result("3", "2", "0")));           // Shard out of range
+}
@@ -147,3 +147,200 @@ TEST_CASE("isConcatenation - complex cases", "[signal_aggregator]") {
     CHECK(isConcatenation("{{sig_a, sig_b}, sig_c}"));
     CHECK(isConcatenation("{sig_a[7:0], sig_b[3:0]}"));
 }
+
+// ============================================================================
+// analyzeExpression / ExpressionCache tests
+// ============================================================================
+
+TEST_CASE("analyzeExpression - identifiers, max bit and concatenation in one parse", "[signal_aggregator]") {
+    auto info = analyzeExpression("{sig_a[7:0], sig_b[15]}");
+    REQUIRE(info.identifiers.size() == 2);
+    CHECK(info.identifiers[0] == "sig_a");
+    CHECK(info.identifiers[1] == "sig_b");
+    CHECK(info.max_bit_index == 15);
+    CHECK(info.is_concatenation);
+
+    auto plain = analyzeExpression("data");
+    CHECK(plain.identifiers == std::vector<std::string>{"data"});
+    CHECK(plain.max_bit_index == -1);
+    CHECK_FALSE(plain.is_concatenation);
+
+    auto blank = analyzeExpression("  ");
+    CHECK(blank.identifiers.empty());
+    CHECK(blank.max_bit_index == -1);
+}
+
+TEST_CASE("analyzeSimpleExpression - lexical fast path forms", "[signal_aggregator]") {
+    auto plain = analyzeSimpleExpression(" clk ");
+    REQUIRE(plain);
+    CHECK(plain->identifiers == std::vector<std::string>{"clk"});
+    CHECK(plain->max_bit_index == -1);
+    CHECK_FALSE(plain->is_concatenation);
+
+    auto bit = analyzeSimpleExpression("data_o[7]");
+    REQUIRE(bit);
+    CHECK(bit->identifiers == std::vector<std::string>{"data_o"});
+    CHECK(bit->max_bit_index == 7);
+
+    auto range = analyzeSimpleExpression("mem[0:31][3]");
+    REQUIRE(range);
+    CHECK(range->max_bit_index == 31);
+
+    auto concat = analyzeSimpleExpression("{a, b[3], c[15:8]}");
+    REQUIRE(concat);
+    CHECK(concat->identifiers == std::vector<std::string>{"a", "b", "c"});
+    CHECK(concat->max_bit_index == 15);
+    CHECK(concat->is_concatenation);
+}
+
+TEST_CASE("analyzeSimpleExpression - other forms fall back to the parser", "[signal_aggregator]") {
+    for (const char* expr : {"8'hFF", "{1'b0, a}", "{2{a}}", "a + b", "s.field",
+                             "pkg::sig", "a[1_0]", "a[i]", "wire", "\\esc "}) {
+        INFO(expr);
+        CHECK_FALSE(analyzeSimpleExpression(expr));
+    }
+
+    // The parser still handles them
+    auto info = analyzeExpression("{1'b0, a[4]}");
+    CHECK(info.identifiers == std::vector<std::string>{"a"});
+    CHECK(info.max_bit_index == 4);
+    CHECK(info.is_concatenation);
+}
+
+TEST_CASE("ExpressionCache - parses each distinct expression once", "[signal_aggregator]") {
+    ExpressionCache cache;
+
+    const auto& first = cache.get("bus[3]");
+    CHECK(first.max_bit_index == 3);
+    for (int i = 0; i < 10; ++i) {
+        (void)cache.get("bus[3]");
+    }
+    (void)cache.get("clk");
+
+    CHECK(cache.size() == 2);
+    CHECK(cache.misses() == 2);
+    CHECK(cache.hits() == 10);
+    // Earlier results stay valid as the cache grows
+    CHECK(first.identifiers == std::vector<std::string>{"bus"});
+
+    cache.clear();
+    CHECK(cache.size() == 0);
+    CHECK(cache.hits() == 0);
+}
+
+// ============================================================================
+// SignalAggregator tests
+// ============================================================================
+
+using enum PortDirection;
+
+namespace {
+
+PortConnection makeConnection(const std::string& port, const std::string& signal,
+                              PortDirection dir) {
+    PortConnection conn(port, signal, dir);
+    auto expr = analyzeExpression(signal);
+    conn.signal_identifiers = std::move(expr.identifiers);
+    conn.max_bit_index = expr.max_bit_index;
+    conn.is_concatenation = expr.is_concatenation;
+    return conn;
+}
+
+} // namespace
+
+TEST_CASE("SignalAggregator - classifies nets by direction", "[signal_aggregator]") {
+    SignalAggregator agg;
+
+    std::vector<PortInfo> producer_ports = {{"clk", Input}, {"data", Output, 8}};
+    std::vector<PortInfo> consumer_ports = {{"clk", Input}, {"data", Input, 8}, {"result", Output}};
+
+    agg.addFromInstance("u_producer",
+                        {makeConnection("clk", "clk", Input), makeConnection("data", "data", Output)},
+                        producer_ports);
+    agg.addFromInstance("u_consumer",
+                        {makeConnection("clk", "clk", Input), makeConnection("data", "data", Input),
+                         makeConnection("result", "result", Output)},
+                        consumer_ports);
+
+    auto inputs = agg.getExternalInputNets();
+    auto outputs = agg.getExternalOutputNets();
+    auto internals = agg.getInternalNets();
+
+    REQUIRE(inputs.size() == 1);
+    CHECK(inputs[0].name == "clk");
+    REQUIRE(outputs.size() == 1);
+    CHECK(outputs[0].name == "result");
+    REQUIRE(internals.size() == 1);
+    CHECK(internals[0].name == "data");
+    CHECK(internals[0].width == 8);
+    CHECK(internals[0].getRangeStr() == "[7:0]");
+}
+
+TEST_CASE("SignalAggregator - nets are returned in first-seen order", "[signal_aggregator]") {
+    SignalAggregator agg;
+    std::vector<PortInfo> ports = {{"z", Input}, {"a", Input}, {"m", Input}};
+
+    agg.addFromInstance("u0",
+                        {makeConnection("z", "z", Input), makeConnection("a", "a", Input),
+                         makeConnection("m", "m", Input)},
+                        ports);
+
+    auto inputs = agg.getExternalInputNets();
+    REQUIRE(inputs.size() == 3);
+    CHECK(inputs[0].name == "z");
+    CHECK(inputs[1].name == "a");
+    CHECK(inputs[2].name == "m");
+    CHECK(inputs[0].first_seen_order < inputs[1].first_seen_order);
+}
+
+TEST_CASE("SignalAggregator - widest connection wins", "[signal_aggregator]") {
+    SignalAggregator agg;
+
+    PortInfo narrow("d", Input, 4);
+    narrow.original_range_str = "[N-1:0]";
+    PortInfo wide("d", Input, 16);
+    wide.original_range_str = "[W-1:0]";
+
+    agg.addFromInstance("u_narrow", {makeConnection("d", "bus", Input)}, {narrow});
+    agg.addFromInstance("u_wide", {makeConnection("d", "bus", Input)}, {wide});
+    agg.addFromInstance("u_narrow2", {makeConnection("d", "bus", Input)}, {narrow});
+
+    auto net = agg.getNetInfo("bus");
+    REQUIRE(net.has_value());
+    CHECK(net->width == 16);
+    CHECK(net->getRangeStr(true) == "[W-1:0]");
+    CHECK_FALSE(agg.getNetInfo("missing").has_value());
+}
+
+TEST_CASE("SignalAggregator - source instances are unique per net", "[signal_aggregator]") {
+    SignalAggregator agg;
+    std::vector<PortInfo> ports = {{"a", Input}, {"b", Input}};
+
+    // Same net on two ports of one instance, and a high-fanout net across many
+    agg.addFromInstance("u0", {makeConnection("a", "clk", Input), makeConnection("b", "clk", Input)},
+                        ports);
+    for (int i = 1; i < 100; ++i) {
+        agg.addFromInstance("u" + std::to_string(i), {makeConnection("a", "clk", Input)}, ports);
+    }
+    // Repeated instance name is still not listed twice
+    agg.addFromInstance("u0", {makeConnection("a", "clk", Input)}, ports);
+
+    auto sources = agg.getSourceInstances("clk");
+    REQUIRE(sources.size() == 100);
+    CHECK(sources.front() == "u0");
+    CHECK(sources.back() == "u99");
+}
+
+TEST_CASE("SignalAggregator - bit selects widen the net", "[signal_aggregator]") {
+    SignalAggregator agg;
+    std::vector<PortInfo> ports = {{"b0", Output}, {"b1", Output}};
+
+    // Template-style mapping of single-bit ports onto bits of one bus
+    agg.addFromInstance("u0", {makeConnection("b0", "bus[0]", Output),
+                               makeConnection("b1", "bus[5]", Output)}, ports);
+
+    auto net = agg.getNetInfo("bus");
+    REQUIRE(net.has_value());
+    CHECK(net->width == 6);
+    CHECK(net->getRangeStr() == "[5:0]");
+}
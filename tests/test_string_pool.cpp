@@ -0,0 +1,56 @@
+// Unit tests for StringPool
+
+#include <catch2/catch_test_macros.hpp>
+#include "slang-autos/StringPool.h"
+
+#include <string>
+
+using namespace slang_autos;
+
+TEST_CASE("StringPool - IDs are dense and stable", "[string_pool]") {
+    StringPool pool;
+
+    CHECK(pool.intern("clk") == 0);
+    CHECK(pool.intern("rst_n") == 1);
+    CHECK(pool.intern("clk") == 0);
+    CHECK(pool.size() == 2);
+
+    CHECK(pool.str(0) == "clk");
+    CHECK(pool.str(1) == "rst_n");
+}
+
+TEST_CASE("StringPool - find does not intern", "[string_pool]") {
+    StringPool pool;
+
+    CHECK(pool.find("data") == StringPool::npos);
+    CHECK(pool.empty());
+
+    pool.intern("data");
+    CHECK(pool.find("data") == 0);
+    CHECK(pool.find("dat") == StringPool::npos);
+}
+
+TEST_CASE("StringPool - survives growth", "[string_pool]") {
+    StringPool pool;
+    auto first = pool.str(pool.intern("net_0"));
+
+    for (int i = 0; i < 5000; ++i) {
+        CHECK(pool.intern("net_" + std::to_string(i)) == static_cast<SymbolId>(i));
+    }
+    for (int i = 0; i < 5000; ++i) {
+        CHECK(pool.find("net_" + std::to_string(i)) == static_cast<SymbolId>(i));
+    }
+
+    // Views remain valid after the table has been rebuilt
+    CHECK(first == "net_0");
+}
+
+TEST_CASE("StringPool - clear", "[string_pool]") {
+    StringPool pool;
+    pool.intern("a");
+    pool.clear();
+
+    CHECK(pool.empty());
+    CHECK(pool.find("a") == StringPool::npos);
+    CHECK(pool.intern("b") == 0);
+}
@@ -8,7 +8,7 @@ using namespace slang_autos;
 TEST_CASE("TemplateMatcher - no template", "[template]") {
     TemplateMatcher matcher;
 
-    PortInfo port("data_in", "input", 8);
+    PortInfo port("data_in", PortDirection::Input, 8);
     auto result = matcher.matchPort(port);
 
     CHECK(result.signal_name == "data_in");
@@ -25,13 +25,13 @@ TEST_CASE("TemplateMatcher - literal port match", "[template]") {
     matcher.setInstance("u_sub");
 
     SECTION("Matching port") {
-        PortInfo port("data_in", "input", 8);
+        PortInfo port("data_in", PortDirection::Input, 8);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "my_data_in");
     }
 
     SECTION("Non-matching port falls through") {
-        PortInfo port("clk", "input", 1);
+        PortInfo port("clk", PortDirection::Input, 1);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "clk");
     }
@@ -45,7 +45,7 @@ TEST_CASE("TemplateMatcher - port capture groups", "[template]") {
     TemplateMatcher matcher(&tmpl);
     matcher.setInstance("u_sub");
 
-    PortInfo port("data_in", "input", 8);
+    PortInfo port("data_in", PortDirection::Input, 8);
     auto result = matcher.matchPort(port);
 
     CHECK(result.signal_name == "sig_in");
@@ -60,7 +60,7 @@ TEST_CASE("TemplateMatcher - instance capture groups", "[template]") {
     TemplateMatcher matcher(&tmpl);
     matcher.setInstance("u_sub_0");
 
-    PortInfo port("data", "input", 8);
+    PortInfo port("data", PortDirection::Input, 8);
     auto result = matcher.matchPort(port);
 
     CHECK(result.signal_name == "data_0");
@@ -75,7 +75,7 @@ TEST_CASE("TemplateMatcher - builtin variables", "[template]") {
         TemplateMatcher matcher(&tmpl);
         matcher.setInstance("u_sub");
 
-        PortInfo port("data", "input", 8);
+        PortInfo port("data", PortDirection::Input, 8);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "sig_data");
     }
@@ -85,7 +85,7 @@ TEST_CASE("TemplateMatcher - builtin variables", "[template]") {
         TemplateMatcher matcher(&tmpl);
         matcher.setInstance("u_sub");
 
-        PortInfo port("data", "input", 8);
+        PortInfo port("data", PortDirection::Input, 8);
         port.width = 8;
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "sig_w_8");
@@ -96,7 +96,7 @@ TEST_CASE("TemplateMatcher - builtin variables", "[template]") {
         TemplateMatcher matcher(&tmpl);
         matcher.setInstance("u_sub_0");
 
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "u_sub_0_data");
     }
@@ -144,19 +144,19 @@ TEST_CASE("TemplateMatcher - port.input/output/inout variables", "[template]") {
     matcher.setInstance("u_sub");
 
     SECTION("input port") {
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "1_0_0");
     }
 
     SECTION("output port") {
-        PortInfo port("data", "output");
+        PortInfo port("data", PortDirection::Output);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "0_1_0");
     }
 
     SECTION("inout port") {
-        PortInfo port("data", "inout");
+        PortInfo port("data", PortDirection::Inout);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "0_0_1");
     }
@@ -172,12 +172,12 @@ TEST_CASE("TemplateMatcher - ternary expressions", "[template]") {
         matcher.setInstance("u_sub");
 
         // Input port should get '0
-        PortInfo input_port("data_in", "input");
+        PortInfo input_port("data_in", PortDirection::Input);
         auto result1 = matcher.matchPort(input_port);
         CHECK(result1.signal_name == "'0");
 
         // Output port should get _ (unconnected)
-        PortInfo output_port("data_out", "output");
+        PortInfo output_port("data_out", PortDirection::Output);
         auto result2 = matcher.matchPort(output_port);
         CHECK(result2.signal_name == "_");
     }
@@ -188,12 +188,12 @@ TEST_CASE("TemplateMatcher - ternary expressions", "[template]") {
         matcher.setInstance("u_sub");
 
         // Output port should get signal name
-        PortInfo output_port("valid", "output");
+        PortInfo output_port("valid", PortDirection::Output);
         auto result1 = matcher.matchPort(output_port);
         CHECK(result1.signal_name == "data_out_sig");
 
         // Input port should get _
-        PortInfo input_port("ready", "input");
+        PortInfo input_port("ready", PortDirection::Input);
         auto result2 = matcher.matchPort(input_port);
         CHECK(result2.signal_name == "_");
     }
@@ -203,11 +203,11 @@ TEST_CASE("TemplateMatcher - ternary expressions", "[template]") {
         TemplateMatcher matcher(&tmpl);
         matcher.setInstance("u_sub_3");
 
-        PortInfo input_port("data", "input");
+        PortInfo input_port("data", PortDirection::Input);
         auto result1 = matcher.matchPort(input_port);
         CHECK(result1.signal_name == "data_3_in");
 
-        PortInfo output_port("data", "output");
+        PortInfo output_port("data", PortDirection::Output);
         auto result2 = matcher.matchPort(output_port);
         CHECK(result2.signal_name == "data_3_out");
     }
@@ -217,7 +217,7 @@ TEST_CASE("TemplateMatcher - ternary expressions", "[template]") {
         TemplateMatcher matcher(&tmpl);
         matcher.setInstance("u_sub");
 
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "regular_signal");
     }
@@ -233,20 +233,20 @@ TEST_CASE("TemplateMatcher - warns on constant assigned to output", "[template]"
     matcher.setInstance("u_sub");
 
     SECTION("no warning for input port") {
-        PortInfo port("data_in", "input");
+        PortInfo port("data_in", PortDirection::Input);
         (void)matcher.matchPort(port);
         CHECK(diag.warningCount() == 0);
     }
 
     SECTION("warning for output port") {
-        PortInfo port("data_out", "output");
+        PortInfo port("data_out", PortDirection::Output);
         (void)matcher.matchPort(port);
         CHECK(diag.warningCount() == 1);
         CHECK(diag.format().find("Constant ''0' assigned to output port") != std::string::npos);
     }
 
     SECTION("no warning for inout port") {
-        PortInfo port("data_io", "inout");
+        PortInfo port("data_io", PortDirection::Inout);
         (void)matcher.matchPort(port);
         CHECK(diag.warningCount() == 0);
     }
@@ -261,7 +261,7 @@ TEST_CASE("TemplateMatcher - first matching rule wins", "[template]") {
     TemplateMatcher matcher(&tmpl);
     matcher.setInstance("u_sub");
 
-    PortInfo port("data_in", "input");
+    PortInfo port("data_in", PortDirection::Input);
     auto result = matcher.matchPort(port);
 
     CHECK(result.signal_name == "first_match");
@@ -276,7 +276,7 @@ TEST_CASE("TemplateMatcher - @ alias for %1", "[template]") {
     TemplateMatcher matcher(&tmpl);
     matcher.setInstance("u_sub_5");
 
-    PortInfo port("data", "input", 8);
+    PortInfo port("data", PortDirection::Input, 8);
     auto result = matcher.matchPort(port);
 
     CHECK(result.signal_name == "data_5");
@@ -292,21 +292,21 @@ TEST_CASE("TemplateMatcher - default pattern extracts first number", "[template]
 
     SECTION("Number at end") {
         matcher.setInstance("u_sub_42");
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "data_42");
     }
 
     SECTION("Number in middle") {
         matcher.setInstance("ms2m");
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "data_2");
     }
 
     SECTION("Multiple numbers - first one wins") {
         matcher.setInstance("u_inst123_abc456");
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "data_123");
     }
@@ -322,7 +322,7 @@ TEST_CASE("TemplateMatcher - math functions", "[template][math]") {
         TemplateMatcher matcher(&tmpl);
         matcher.setInstance("u_sub_0");
 
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "net_1");  // 0 + 1 = 1
     }
@@ -332,7 +332,7 @@ TEST_CASE("TemplateMatcher - math functions", "[template][math]") {
         TemplateMatcher matcher(&tmpl);
         matcher.setInstance("u_sub_5");
 
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "net_4");  // 5 - 1 = 4
     }
@@ -342,7 +342,7 @@ TEST_CASE("TemplateMatcher - math functions", "[template][math]") {
         TemplateMatcher matcher(&tmpl);
         matcher.setInstance("u_sub_3");
 
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "net_6");  // 3 * 2 = 6
     }
@@ -352,7 +352,7 @@ TEST_CASE("TemplateMatcher - math functions", "[template][math]") {
         TemplateMatcher matcher(&tmpl);
         matcher.setInstance("u_sub_7");
 
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "net_3");  // 7 / 2 = 3 (integer division)
     }
@@ -362,7 +362,7 @@ TEST_CASE("TemplateMatcher - math functions", "[template][math]") {
         TemplateMatcher matcher(&tmpl);
         matcher.setInstance("u_sub_5");
 
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "net_1");  // 5 % 2 = 1
     }
@@ -373,7 +373,7 @@ TEST_CASE("TemplateMatcher - math functions", "[template][math]") {
         TemplateMatcher matcher(&tmpl);
 
         matcher.setInstance("u_sub_0");
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result0 = matcher.matchPort(port);
         CHECK(result0.signal_name == "net_1");  // (0+1)%2 = 1
 
@@ -388,7 +388,7 @@ TEST_CASE("TemplateMatcher - math functions", "[template][math]") {
         TemplateMatcher matcher(&tmpl);
         matcher.setInstance("u_sub_0");
 
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "net_7");
     }
@@ -398,7 +398,7 @@ TEST_CASE("TemplateMatcher - math functions", "[template][math]") {
         TemplateMatcher matcher(&tmpl);
         matcher.setInstance("u_sub_3");
 
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "a_4_b_6");  // add(3,1)=4, mul(3,2)=6
     }
@@ -414,7 +414,7 @@ TEST_CASE("TemplateMatcher - math function edge cases", "[template][math]") {
         TemplateMatcher matcher(&tmpl, &diag);
         matcher.setInstance("u_sub_5");
 
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "net_0");  // Returns 0 on div by zero
         CHECK(diag.warningCount() == 1);
@@ -425,7 +425,7 @@ TEST_CASE("TemplateMatcher - math function edge cases", "[template][math]") {
         TemplateMatcher matcher(&tmpl, &diag);
         matcher.setInstance("u_sub_5");
 
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "net_0");  // Returns 0 on mod by zero
         CHECK(diag.warningCount() == 1);
@@ -436,7 +436,7 @@ TEST_CASE("TemplateMatcher - math function edge cases", "[template][math]") {
         TemplateMatcher matcher(&tmpl);
         matcher.setInstance("u_sub_3");
 
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "net_-7");  // 3 - 10 = -7
     }
@@ -446,7 +446,7 @@ TEST_CASE("TemplateMatcher - math function edge cases", "[template][math]") {
         TemplateMatcher matcher(&tmpl);
         matcher.setInstance("u_sub_0");
 
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result = matcher.matchPort(port);
         CHECK(result.signal_name == "regular_signal");
     }
@@ -464,7 +464,7 @@ TEST_CASE("TemplateMatcher - invalid regex warnings", "[template][errors]") {
         TemplateMatcher matcher(&tmpl, &diag);
         matcher.setInstance("u_sub");
 
-        PortInfo port("data", "input");
+        PortInfo port("data", PortDirection::Input);
         auto result = matcher.matchPort(port);
 
         // Should fall through to default (port name)
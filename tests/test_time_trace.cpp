@@ -0,0 +1,53 @@
+// Unit tests for the time-trace instrumentation
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "slang-autos/TimeTrace.h"
+
+using namespace slang_autos;
+
+static std::string readTrace(const std::filesystem::path& path) {
+    std::ifstream ifs(path);
+    std::stringstream buffer;
+    buffer << ifs.rdbuf();
+    return buffer.str();
+}
+
+TEST_CASE("TimeTrace - scopes outside a trace record nothing", "[time_trace]") {
+    CHECK_FALSE(timeTraceEnabled());
+    { TimeTraceScope scope("Ignored"); }
+
+    auto path = std::filesystem::temp_directory_path() / "slang_autos_trace_empty.json";
+    timeTraceBegin();
+    REQUIRE(timeTraceWrite(path));
+    CHECK_FALSE(timeTraceEnabled());
+
+    auto json = readTrace(path);
+    CHECK(json.find("\"traceEvents\":[") != std::string::npos);
+    CHECK(json.find("Ignored") == std::string::npos);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("TimeTrace - writes complete events with details and thread tracks", "[time_trace]") {
+    auto path = std::filesystem::temp_directory_path() / "slang_autos_trace.json";
+    timeTraceBegin();
+    {
+        TimeTraceScope file("File", "dir/\"top\".sv");
+        std::thread worker([] { TimeTraceScope module("Module", "leaf"); });
+        worker.join();
+    }
+    REQUIRE(timeTraceWrite(path));
+
+    auto json = readTrace(path);
+    CHECK(json.find("\"ph\":\"X\"") != std::string::npos);
+    CHECK(json.find("\"name\":\"File\",\"args\":{\"detail\":\"dir/\\\"top\\\".sv\"}") != std::string::npos);
+    CHECK(json.find("\"tid\":0") != std::string::npos);  // Tracing thread
+    CHECK(json.find("\"tid\":1") != std::string::npos);  // Worker
+    CHECK(json.find("\"detail\":\"leaf\"") != std::string::npos);
+    std::filesystem::remove(path);
+}
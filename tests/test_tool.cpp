@@ -40,3 +40,27 @@ TEST_CASE("AutosTool - loadWithArgs with EDA options", "[tool]") {
         CHECK_FALSE(result);
     }
 }
+
+TEST_CASE("ExpansionStats - accumulate and format", "[tool][stats]") {
+    ExpansionStats a;
+    a.parse_us = 10;
+    a.replacements = 2;
+    a.peak_rss_bytes = 100;
+    ExpansionStats b;
+    b.parse_us = 5;
+    b.replacements = 3;
+    b.peak_rss_bytes = 50;
+
+    a += b;
+    CHECK(a.parse_us == 15);
+    CHECK(a.replacements == 5);
+    CHECK(a.peak_rss_bytes == 100);  // Peak, not sum
+
+    auto json = toJson(a);
+    CHECK(json.front() == '{');
+    CHECK(json.back() == '}');
+    CHECK(json.find("\"parse_us\":15") != std::string::npos);
+    CHECK(json.find("\"peak_rss_bytes\":100") != std::string::npos);
+
+    CHECK(jsonQuote("a\"b\\c\n") == "\"a\\\"b\\\\c\\n\"");
+}
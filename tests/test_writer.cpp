@@ -1,5 +1,9 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
 #include "slang-autos/Writer.h"
 
 using namespace slang_autos;
@@ -105,3 +109,107 @@ TEST_CASE("SourceWriter - valid replacements still applied alongside invalid", "
     std::string result = writer.applyReplacements(content, repls);
     CHECK(result == "Hello Universe");
 }
+
+TEST_CASE("SourceWriter - writeReplacements streams the same text", "[writer]") {
+    auto path = std::filesystem::temp_directory_path() / "slang_autos_writer_stream.sv";
+    std::string content = "aaa bbb ccc ddd";
+    {
+        std::ofstream ofs(path);
+        ofs << content;
+    }
+
+    std::vector<Replacement> repls = {
+        {8, 11, "CCCCC"},
+        {0, 3, "A"},
+        {20, 25, "BAD"}  // Invalid: out of bounds
+    };
+    auto copy = repls;
+    std::string expected = SourceWriter().applyReplacements(content, copy);
+
+    SourceWriter writer;
+    REQUIRE(writer.writeReplacements(path, content, repls));
+
+    std::ifstream ifs(path);
+    std::stringstream buffer;
+    buffer << ifs.rdbuf();
+    CHECK(buffer.str() == expected);
+    CHECK(buffer.str() == "A bbb CCCCC ddd");
+    CHECK_FALSE(std::filesystem::exists(path.string() + ".slang-autos.tmp"));
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("SourceWriter - writeReplacements keeps symlinks", "[writer]") {
+    namespace fs = std::filesystem;
+    auto target = fs::temp_directory_path() / "slang_autos_writer_target.sv";
+    auto link = fs::temp_directory_path() / "slang_autos_writer_link.sv";
+    {
+        std::ofstream ofs(target);
+        ofs << "aaa bbb";
+    }
+    fs::remove(link);
+    fs::create_symlink(target, link);
+
+    SourceWriter writer;
+    std::vector<Replacement> repls = {{0, 3, "A"}};
+    REQUIRE(writer.writeReplacements(link, "aaa bbb", repls));
+
+    CHECK(fs::is_symlink(fs::symlink_status(link)));
+    std::ifstream ifs(target);
+    std::stringstream buffer;
+    buffer << ifs.rdbuf();
+    CHECK(buffer.str() == "A bbb");
+
+    fs::remove(link);
+    fs::remove(target);
+}
+
+TEST_CASE("SourceWriter - writeReplacements respects dry run", "[writer]") {
+    SourceWriter writer(true);
+    std::vector<Replacement> repls = {{0, 1, "x"}};
+    CHECK_FALSE(writer.writeReplacements("never_written.sv", "a", repls));
+    CHECK_FALSE(std::filesystem::exists("never_written.sv"));
+}
+
+TEST_CASE("formatDepfileRule - one dependency per line, escaped", "[writer]") {
+    CHECK(formatDepfileRule("top.sv", {}) == "top.sv:\n");
+    CHECK(formatDepfileRule("top.sv", {"lib/fifo.sv", "inc/defs.svh"}) ==
+          "top.sv: \\\n  lib/fifo.sv \\\n  inc/defs.svh\n");
+    CHECK(formatDepfileRule("my top.sv", {"lib/a#1.sv", "$ROOT/b.sv"}) ==
+          "my\\ top.sv: \\\n  lib/a\\#1.sv \\\n  $$ROOT/b.sv\n");
+}
+
+TEST_CASE("differsIgnoringWhitespace", "[writer]") {
+    SECTION("Reindented text is not a change") {
+        CHECK_FALSE(differsIgnoringWhitespace("  .a(a),\n  .b(b)\n", "\t.a(a),\n\t\t.b(b)\n"));
+        CHECK_FALSE(differsIgnoringWhitespace(".a (a)", ".a(a)  "));
+    }
+
+    SECTION("Token or line changes are a change") {
+        CHECK(differsIgnoringWhitespace(".a(a)", ".a(b)"));
+        CHECK(differsIgnoringWhitespace(".a(a)", ".a(a),"));
+        CHECK(differsIgnoringWhitespace(".a(a)\n", ".a(a)"));
+    }
+}
+
+TEST_CASE("replacementsChangeContent", "[writer]") {
+    std::string content = "u_a (/*AUTOINST*/\n  .a(a));\n";
+    size_t start = content.find('\n');
+    size_t end = content.find(')') + 1;
+
+    SECTION("Regenerating the same text is not a change") {
+        std::vector<Replacement> repls = {{start, end, "\n  .a(a)"}};
+        CHECK_FALSE(replacementsChangeContent(content, repls));
+    }
+
+    SECTION("Reindented text is only a whitespace change") {
+        std::vector<Replacement> repls = {{start, end, "\n\t.a(a)"}};
+        CHECK(replacementsChangeContent(content, repls));
+        CHECK_FALSE(replacementsChangeContent(content, repls, /*ignore_whitespace=*/true));
+    }
+
+    SECTION("New connections are a change") {
+        std::vector<Replacement> repls = {{start, end, "\n  .a(a),\n  .b(b)"}};
+        CHECK(replacementsChangeContent(content, repls, /*ignore_whitespace=*/true));
+    }
+}